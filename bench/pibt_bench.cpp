@@ -0,0 +1,57 @@
+/*
+ * Measures PIBT timesteps per second.
+ *
+ * usage: pibt_bench <map> <scen> <agents> [timesteps] [rows cols obstacles]
+ * If the map or scen file does not exist, a random grid of the given size
+ * and random agents are generated and saved to these files (see Instance).
+ */
+#include <chrono>
+#include "Instance.h"
+#include "instancegrid.h"
+#include "mapf.h"
+#include "pibt.h"
+
+
+int main(int argc, char** argv)
+{
+  if (argc < 4) {
+    cerr << "usage: " << argv[0]
+         << " <map> <scen> <agents> [timesteps] [rows cols obstacles]" << endl;
+    return 1;
+  }
+  int num_of_agents = atoi(argv[3]);
+  int timesteps = argc > 4 ? atoi(argv[4]) : 100;
+  int rows = argc > 7 ? atoi(argv[5]) : 200;
+  int cols = argc > 7 ? atoi(argv[6]) : 200;
+  int obstacles = argc > 7 ? atoi(argv[7]) : rows * cols / 10;
+
+  srand(0);
+  Instance instance(argv[1], argv[2], num_of_agents, rows, cols, obstacles);
+
+  std::mt19937 MT(0);
+  InstanceGrid G(instance, &MT);
+  PIBT_Agents A;
+  std::vector<Task*> T;
+  for (int i = 0; i < num_of_agents; ++i) {
+    A.push_back(new PIBT_Agent(G.getNode(instance.getStarts()[i])));
+    T.push_back(new Task(G.getNode(instance.getGoals()[i])));
+  }
+  MAPF P(&G, A, T, &MT);
+  PIBT solver(&P, &MT);
+
+  // the first timestep also computes the distance tables
+  solver.update();
+  P.update();
+
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < timesteps; ++t) {
+    solver.update();
+    P.update();
+  }
+  double runtime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  cout << "agents = " << num_of_agents << ", timesteps = " << timesteps
+       << ", runtime = " << runtime << " s, "
+       << timesteps / runtime << " timesteps/s" << endl;
+  return 0;
+}
@@ -12,8 +12,9 @@ public:
     int sum_of_costs = MAX_COST;
     int sum_of_costs_lowerbound = 0;
     int sum_of_distances = -1;
-    AnytimeBCBS(const Instance& instance, double time_limit, int screen) :
-        instance(instance), time_limit(time_limit), screen(screen) {}
+    AnytimeBCBS(const Instance& instance, double time_limit, int screen, int num_of_threads = 1, bool parallel_root = false) :
+        instance(instance), time_limit(time_limit), screen(screen), num_of_threads(num_of_threads),
+        parallel_root(parallel_root) {}
 
     void run();
     void validateSolution() const;
@@ -26,4 +27,6 @@ private:
     const Instance& instance; // avoid making copies of this variable as much as possible
     double time_limit;
     int screen;
+    int num_of_threads; // threads for generating CT nodes
+    bool parallel_root; // plan the root paths on all threads as well
 };
\ No newline at end of file
@@ -12,8 +12,11 @@ public:
     int sum_of_costs = MAX_COST;
     int sum_of_costs_lowerbound = 0;
     int sum_of_distances = -1;
-    AnytimeEECBS(const Instance& instance, double time_limit, int screen) :
-            instance(instance), time_limit(time_limit), screen(screen) {}
+    size_t peak_ct_memory = 0; // peak memory usage of the CT nodes in bytes
+    AnytimeEECBS(const Instance& instance, double time_limit, int screen, size_t memory_limit = 0, int num_of_threads = 1,
+                 bool parallel_root = false) :
+            instance(instance), time_limit(time_limit), screen(screen), memory_limit(memory_limit),
+            num_of_threads(num_of_threads), parallel_root(parallel_root) {}
 
     void run();
     void validateSolution() const;
@@ -26,4 +29,7 @@ private:
     const Instance& instance; // avoid making copies of this variable as much as possible
     double time_limit;
     int screen;
+    size_t memory_limit; // memory budget of the CT nodes in bytes, 0 for unlimited
+    int num_of_threads; // threads for generating CT nodes
+    bool parallel_root; // plan the root paths on all threads as well
 };
@@ -3,9 +3,28 @@
 #include "RectangleReasoning.h"
 #include "CorridorReasoning.h"
 #include "MutexReasoning.h"
+#include "ThreadPool.h"
+#include <atomic>
 
 enum high_level_solver_type { ASTAR, ASTAREPS, NEW, EES };
 
+// The paths of a CT node that is being generated and the CAT of these paths, together with the low-level stats
+// collected while generating it. Each thread that generates CT nodes works on its own workspace.
+struct CTNodeWorkspace
+{
+	vector<Path*> paths;
+	vector<int> min_f_vals; // lower bounds of the costs of the paths (ECBS only)
+	ConflictAvoidanceTable conflict_avoidance_table; // kept in sync with paths
+
+	uint64_t num_LL_expanded = 0;
+	uint64_t num_LL_generated = 0;
+	double runtime_generate_child = 0;
+	double runtime_build_CT = 0;
+	double runtime_build_CAT = 0;
+	double runtime_path_finding = 0;
+	double runtime_detect_conflicts = 0;
+};
+
 class CBS
 {
 public:
@@ -35,6 +54,11 @@ public:
 	uint64_t num_LL_expanded = 0;
 	uint64_t num_LL_generated = 0;
 
+	size_t ct_memory = 0; // estimated memory usage of the CT nodes in bytes
+	size_t peak_ct_memory = 0;
+	uint64_t num_evicted_nodes = 0; // number of CT nodes whose paths and conflicts are evicted (ECBS only)
+	uint64_t num_regenerated_nodes = 0; // number of evicted CT nodes that are recomputed (ECBS only)
+
 	uint64_t num_cleanup = 0; // number of expanded nodes chosen from cleanup list
 	uint64_t num_open = 0; // number of expanded nodes chosen from open list
 	uint64_t num_focal = 0; // number of expanded nodes chsoen from focal list
@@ -71,6 +95,20 @@ public:
 		suboptimality = w;
 	}
 	void setNodeLimit(int n) { node_limit = n; }
+	void setInterruptFlag(const std::atomic<bool>* flag) { interrupted = flag; } // give up as soon as *flag is set
+	void setMemoryLimit(size_t m) { memory_limit = m; } // in bytes, 0 for unlimited (ECBS only)
+	void setMDDMemoryLimit(size_t m) { mdd_helper.setMemoryLimit(m); } // in bytes
+	// share the 2-agent sub-problems of WDG and the root MDDs with other CBS runs on the same instance,
+	// where agent_ids are the ids of the agents in the instance
+	void setHeuristicCache(HeuristicCache* cache, const vector<int>& agent_ids)
+	{
+		heuristic_helper.setHeuristicCache(cache, agent_ids);
+		mdd_helper.setHeuristicCache(cache, agent_ids);
+	}
+	void setNumOfThreads(int n); // generate the two children of a CT node in parallel if n > 1
+	// plan the root paths on all threads as well. Each thread only avoids the paths planned on it,
+	// so the root usually has more conflicts than with the serial planning.
+	void setParallelRoot(bool p) { parallel_root = p; }
 
 	////////////////////////////////////////////////////////////////////////////////////////////
 	// Runs the algorithm until the problem is solved or time is exhausted 
@@ -97,6 +135,9 @@ public:
 	void saveCT(const string &fileName) const; // write the CT to a file
 
 	void clear(); // used for rapid random  restart
+	// reuse the solver for other agents on the same path table, e.g., in the next LNS iteration.
+	// The options, the thread pool and the allocated tables are kept, while the search and the stats are reset.
+	void reset(vector<SingleAgentSolver*>& search_engines) { clear(); resetAgents(search_engines); }
 
 	int getInitialPathLength(int agent) const {return (int) paths_found_initially[agent].size() - 1; }
 protected:
@@ -130,31 +171,50 @@ protected:
 	int cost_lowerbound = 0;
 	int inadmissible_cost_lowerbound;
 	int node_limit = MAX_NODES;
+	const std::atomic<bool>* interrupted = nullptr;
+	size_t memory_limit = 0; // when the CT nodes use more memory, ECBS evicts the worst unexpanded nodes
+	int num_of_threads = 1;
+	bool parallel_root = false;
+	std::unique_ptr<ThreadPool> thread_pool; // num_of_threads - 1 workers, nullptr for the serial search
+	vector<CTNodeWorkspace> workspaces; // child i of an expanded node is generated on workspaces[i], and thread k plans the root paths on workspaces[k]
 	int cost_upperbound = MAX_COST;
 
 	vector<ConstraintTable> initial_constraints;
-	clock_t start;
+	steady_clock::time_point start;
 
 	int num_of_agents;
 
 
 
 	vector<Path> paths_found_initially;  // contain initial paths found
+	ConflictAvoidanceTable conflict_avoidance_table; // kept in sync with paths
 	// vector<MDD*> mdds_initially;  // contain initial paths found
 	vector < SingleAgentSolver* > search_engines;  // used to find (single) agents' paths and mdd
 
 	void addConstraints(const HLNode* curr, HLNode* child1, HLNode* child2) const;
-	set<int> getInvalidAgents(const list<Constraint>& constraints); // return agents that violates the constraints
+	set<int> getInvalidAgents(const ConstraintList& constraints) const; // return agents that violates the constraints
+	bool replanDisjointAgents(const HLNode& child1, const HLNode& child2) const; // whether the two children replan no common agent
 	//conflicts
 	void findConflicts(HLNode& curr);
-	void findConflicts(HLNode& curr, int a1, int a2);
-	shared_ptr<Conflict> chooseConflict(const HLNode &node) const;
-	static void copyConflicts(const list<shared_ptr<Conflict>>& conflicts,
-		list<shared_ptr<Conflict>>& copy, const list<int>& excluded_agent) ;
-	void removeLowPriorityConflicts(list<shared_ptr<Conflict>>& conflicts) const;
+	void findConflicts(HLNode& curr, int a1, int a2) const { findConflicts(curr, a1, a2, paths); }
+	void findConflicts(HLNode& curr, const vector<Path*>& paths, const ConflictAvoidanceTable& cat) const; // the CAT has to be in sync with the paths
+	void findConflicts(HLNode& curr, int a1, int a2, const vector<Path*>& paths) const;
+	ConflictPtr chooseConflict(const HLNode &node) const;
+	static void copyConflicts(const vector<ConflictPtr>& conflicts,
+		vector<ConflictPtr>& copy, const list<int>& excluded_agent) ;
+	void removeLowPriorityConflicts(vector<ConflictPtr>& conflicts) const;
 	void computeSecondPriorityForConflict(Conflict& conflict, const HLNode& node);
 
 	inline void releaseNodes();
+	void resetAgents(vector<SingleAgentSolver*>& new_search_engines);
+	void updateMemoryUsage(HLNode& node); // account the current memory usage of the node in ct_memory
+
+	// parallel search
+	void initWorkspaces(); // called when generating the root
+	void syncWorkspace(CTNodeWorkspace& workspace) const; // copy paths to the workspace
+	void resetWorkspaces(int agent); // remove the path of the agent from the CATs of the workspaces
+	void collectStats(CTNodeWorkspace& workspace); // move the stats of the workspace to the search
+	bool planInParallel(const vector<int>& agents, const std::function<bool(int, CBSNode&, CTNodeWorkspace&)>& plan);
 
 	// print and save
 	void printResults() const;
@@ -165,7 +225,7 @@ protected:
 
 	vector<int> shuffleAgents() const;  //generate random permuattion of agent indices
 	bool terminate(HLNode* curr); // check the stop condition and return true if it meets
-	void computeConflictPriority(shared_ptr<Conflict>& con, CBSNode& node); // check the conflict is cardinal, semi-cardinal or non-cardinal
+	void computeConflictPriority(ConflictPtr& con, CBSNode& node); // check the conflict is cardinal, semi-cardinal or non-cardinal
 
 
 private: // CBS only, cannot be used by ECBS
@@ -181,9 +241,10 @@ private: // CBS only, cannot be used by ECBS
 	inline bool reinsertNode(CBSNode* node);
 
 	// high level search
-	bool generateChild(CBSNode* child, CBSNode* curr);
+	bool generateChild(CBSNode* child, CBSNode* curr, CTNodeWorkspace& workspace);
+	void generateChildren(CBSNode* child[2], CBSNode* curr, bool solved[2]); // generate the two children in parallel
 	bool generateRoot();
-	bool findPathForSingleAgent(CBSNode*  node, int ag, int lower_bound = 0);
+	bool findPathForSingleAgent(CBSNode*  node, int ag, int lower_bound, CTNodeWorkspace& workspace);
 	void classifyConflicts(CBSNode &parent);
 
 	void printPaths() const;
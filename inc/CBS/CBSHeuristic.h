@@ -2,8 +2,13 @@
 #include "MDD.h"
 #include "RectangleReasoning.h"
 #include "CorridorReasoning.h"
+#include "ThreadPool.h"
+#include "HeuristicCache.h"
+#include "WeightedVertexCover.h"
 
 
+class CBS;
+
 enum heuristics_type { ZERO, CG, DG, WDG, GLOBAL, PATH, LOCAL, CONFLICT, STRATEGY_COUNT }; //  GREEDY,
 
 struct HTableEntry // look-up table entry 
@@ -197,7 +202,15 @@ public:
 	double getDistanceError(int i = 0) const { return (num_of_errors[i] == 0)? 0 : sum_distance_errors[i]  / num_of_errors[i]; }
 
 	// void copyConflictGraph(HLNode& child, const HLNode& parent);
-	void clear() { lookupTable.clear(); }
+	void clear() // keep the memory of the lookup tables
+	{
+		for (auto& tables : lookupTable)
+			for (auto& table : tables)
+				table.clear();
+	}
+	void reset(int n); // reuse the heuristic for n other agents
+	void setThreadPool(ThreadPool* pool) { thread_pool = pool; } // solve the 2-agent sub-problems of WDG in parallel
+	void setHeuristicCache(HeuristicCache* cache, const vector<int>& ids) { heuristic_cache = cache; agent_ids = ids; }
 
 private:
     heuristics_type inadmissible_heuristic;
@@ -215,8 +228,10 @@ private:
     vector<int> num_of_errors;
 
 	double time_limit;
+	int joint_node_limit = 16; // resort to the sub CBS solver if the 2-agent solver expands more nodes than this limit times the sum of the path lengths.
 	int node_limit = 4;  // terminate the sub CBS solver if the number of its expanded nodes exceeds the node limit.
-	double start_time;
+	steady_clock::time_point start_time; // for the time limit
+	clock_t start_clock; // for runtime_build_dependency_graph
 	int ILP_node_threshold = 5; // when #nodes >= ILP_node_threshold, use ILP solver; otherwise, use DP solver
 	int ILP_edge_threshold = 10; // when #edges >= ILP_edge_threshold, use ILP solver; otherwise, use DP solver
 	int ILP_value_threshold = 32; // when value >= ILP_value_threshold, use ILP solver; otherwise, use DP solver
@@ -225,6 +240,11 @@ private:
 	const vector<SingleAgentSolver*>& search_engines;
 	const vector<ConstraintTable>& initial_constraints;
 	MDDTable& mdd_helper;
+	ThreadPool* thread_pool = nullptr; // owned by the CBS solver
+	std::mutex stats_mutex; // guards the stats of the 2-agent sub-problems
+	HeuristicCache* heuristic_cache = nullptr; // shares the 2-agent sub-problems across CBS runs
+	vector<int> agent_ids; // ids of the agents in the instance, which identify them in heuristic_cache
+	WeightedVertexCover mvc_solver; // solves the components of the (weighted) conflict graphs
 
 	void buildConflictGraph(vector<bool>& HG, const HLNode& curr);
 	void buildCardinalConflictGraph(CBSNode& curr, vector<int>& CG, int& num_of_CGedges);
@@ -232,10 +252,15 @@ private:
 	bool buildWeightedDependencyGraph(CBSNode& curr, vector<int>& CG);
 	bool buildWeightedDependencyGraph(ECBSNode& node, const vector<int>& min_f_vals, vector<int>& CG, int& delta_g);
 	bool dependent(int a1, int a2, HLNode& node); // return true if the two agents are dependent
-	pair<int, int> solve2Agents(int a1, int a2, const CBSNode& node, bool cardinal); // return h value and num of CT nodes
-    tuple<int, int, int> solve2Agents(int a1, int a2, const ECBSNode& node); // return h value and num of CT nodes
+	pair<int, int> solve2Agents(int a1, int a2, const CBSNode& node, bool cardinal); // return h value and num of expanded nodes
+    tuple<int, int, int> solve2Agents(int a1, int a2, const ECBSNode& node, int length1, int length2); // return h value and shortest path lengths
+	// call solve(i) for every agent_pairs[i], in parallel if there is a thread pool; return false if running out of time
+	bool solveSubProblems(const vector<pair<int, int> >& agent_pairs, const HLNode& node, const std::function<void(int)>& solve);
+	bool findInCache(int a1, int a2, const HLNode& node, int& h, int& length1, int& length2);
+	void insertIntoCache(int a1, int a2, const HLNode& node, int h, int length1, int length2);
+	HeuristicCache::PairKey getCacheKey(int a1, int a2, const HLNode& node) const; // requires agent_ids[a1] < agent_ids[a2]
 	static bool SyncMDDs(const MDD &mdd1, const MDD& mdd2); 	// Match and prune MDD according to another MDD.
-	// void setUpSubSolver(CBS& cbs) const;
+	void setUpSubSolver(CBS& cbs) const;
 	int minimumVertexCover(const vector<int>& CG); // mvc on disjoint components
 	int minimumVertexCover(const vector<int>& CG, int old_mvc, int cols, int num_of_edges); // incremental mvc
 	bool KVertexCover(const vector<int>& CG, int num_of_CGnodes, int num_of_CGedges, int k, int cols);
@@ -245,7 +270,6 @@ private:
 	int minimumWeightedVertexCover(const vector<int>& CG);
 	// int minimumConstrainedWeightedVertexCover(const vector<int>& CG);
 	int weightedVertexCover(const vector<int>& CG);
-	int DPForWMVC(vector<int>& x, int i, int sum, const vector<int>& CG, const vector<int>& range, int& best_so_far); // dynamic programming
 	// int ILPForWMVC(const vector<int>& CG, const vector<int>& range) const; // Integer linear programming
 	int ILPForConstrainedWMVC(const std::vector<int>& CG, const std::vector<int>& range);
 	int DPForConstrainedWMVC(vector<bool>& x, int i, int sum, const vector<int>& CG, const vector<int>& range, int& best_so_far);
@@ -4,11 +4,18 @@
 
 enum node_selection { NODE_RANDOM, NODE_H, NODE_DEPTH, NODE_CONFLICTS, NODE_CONFLICTPAIRS, NODE_MVC };
 
+struct ConstraintLayer;
+
+
+enum node_list { NONE, OPEN, FOCAL, CLEANUP }; // the list that a CT node is chosen from
+
+std::ostream& operator<<(std::ostream& os, node_list list);
+
 
 class HLNode // a virtual base class for high-level node
 {
 public:
-	list<Constraint> constraints; // new constraints
+	ConstraintList constraints; // new constraints
 
 	int g_val = 0; // sum of costs for CBS, and sum of min f for ECBS
 	int h_val = 0; // admissible h
@@ -17,12 +24,13 @@ public:
 	size_t depth = 0; // depath of this CT node
 	size_t makespan = 0; // makespan over all paths
 	bool h_computed = false;
+	node_list chosen_from = node_list::NONE; // chosen from the open/focal/cleanup least
 
 	uint64_t time_expanded = 0;
 	uint64_t time_generated = 0;
 
+#ifdef DEBUG_HL_NODES
 	// For debug
-	string chosen_from = "none"; // chosen from the open/focal/cleanup least
 	int f_of_best_in_cleanup = 0;
 	int f_hat_of_best_in_cleanup = 0;
 	int d_of_best_in_cleanup = 0;
@@ -32,28 +40,37 @@ public:
 	int f_of_best_in_focal = 0;
 	int f_hat_of_best_in_focal = 0;
 	int d_of_best_in_focal = 0;
+#endif
 
 	// conflicts in the current paths
-	list<shared_ptr<Conflict> > conflicts;
-	list<shared_ptr<Conflict> > unknownConf;
+	vector<ConflictPtr> conflicts;
+	vector<ConflictPtr> unknownConf;
 
 	// The chosen conflict
-	shared_ptr<Conflict> conflict;
+	ConflictPtr conflict;
 	// unordered_map<int, pair<int, int> > conflictGraph; //<edge index, <weight, num of CT nodes> >
 
 	// online learning
 	int distance_error = 0;
 	int cost_error = 0;
 	bool fully_expanded = false;
+	// memory usage of this node that is accounted in CBS::ct_memory.
+	// It fills the padding between fully_expanded and parent, so it does not make the node larger.
+	uint32_t memory_usage = 0;
 
 	HLNode* parent;
-	list<HLNode*> children;
+	vector<HLNode*> children;
+
+	// <agent, constraints on the path from the root to this node that are relevant to the agent>,
+	// cached by ConstraintTable::cacheLayer for the replanned agents so that the descendants build on top of them
+	boost::container::small_vector<pair<int, shared_ptr<const ConstraintLayer> >, 1> constraint_layers;
 
 	inline int getFVal() const { return g_val + h_val; }
 	virtual inline int  getFHatVal() const = 0;
 	virtual inline int getNumNewPaths() const = 0;
 	virtual list<int> getReplannedAgents() const = 0;
 	virtual inline string getName() const = 0;
+	virtual size_t getMemoryUsage() const; // estimated number of bytes owned by this node
 	void clear();
 	// void printConflictGraph(int num_of_agents) const;
 	void updateDistanceToGo();
@@ -166,6 +183,13 @@ public:
 	inline int getFHatVal() const override { return g_val + cost_to_go; }
 	inline int getNumNewPaths() const override { return (int) paths.size(); }
 	inline string getName() const override { return "CBS Node"; }
+	size_t getMemoryUsage() const override
+	{
+		size_t memory = sizeof(CBSNode) + HLNode::getMemoryUsage();
+		for (const auto& path : paths)
+			memory += sizeof(path) + 2 * sizeof(void*) + sizeof(PathEntry) * path.second.capacity();
+		return memory;
+	}
 	list<int> getReplannedAgents() const override
 	{
 		list<int> rst;
@@ -1,5 +1,8 @@
 #pragma once
 #include "common.h"
+#include <boost/container/small_vector.hpp>
+#include <boost/smart_ptr/intrusive_ptr.hpp>
+#include <boost/smart_ptr/intrusive_ref_counter.hpp>
 
 
 enum conflict_type { MUTEX, TARGET, CORRIDOR, RECTANGLE, STANDARD, TYPE_COUNT };
@@ -22,56 +25,59 @@ typedef std::tuple<int, int, int, int, constraint_type> Constraint;
 // <agent, loc, -1, t, LEQLENGTH>: path of agent_id should be of length at most t, and any other agent cannot be at loc at or after timestep t
 // <agent, loc, -1, t, GLENGTH>: path of agent_id should be of length at least t + 1
 
+// most CT nodes and conflicts carry one or two constraints per agent, which are stored inline
+typedef boost::container::small_vector<Constraint, 2> ConstraintList;
+
 std::ostream& operator<<(std::ostream& os, const Constraint& constraint);
 
 
-class Conflict
+// Conflicts are shared by a CT node and its descendants, so they are reference counted in place
+// and allocated from a per-thread free list. The siblings that are generated in parallel share the conflicts
+// of their parent, so the counter is atomic.
+class Conflict : public boost::intrusive_ref_counter<Conflict, boost::thread_safe_counter>
 {
 public:
 	int a1;
 	int a2;
-	list<Constraint> constraint1;
-	list<Constraint> constraint2;
+	ConstraintList constraint1;
+	ConstraintList constraint2;
 	conflict_type type;
 	conflict_priority priority = conflict_priority::UNKNOWN;
 	double secondary_priority = 0; // used as the tie-breaking creteria for conflict selection
     int getConflictId() const { return int(type); }  // int(PRIORITY_COUNT) * int(type) + int(priority); }
 
+	static void* operator new(size_t size);
+	static void operator delete(void* p, size_t size);
+
 	void vertexConflict(int a1, int a2, int v, int t)
 	{
-        constraint1.clear();
-        constraint2.clear();
 		this->a1 = a1;
 		this->a2 = a2;
-		this->constraint1.emplace_back(a1, v, -1, t, constraint_type::VERTEX);
-		this->constraint2.emplace_back(a2, v, -1, t, constraint_type::VERTEX);
+		this->constraint1.assign(1, Constraint(a1, v, -1, t, constraint_type::VERTEX));
+		this->constraint2.assign(1, Constraint(a2, v, -1, t, constraint_type::VERTEX));
 		type = conflict_type::STANDARD;
 	}
 		
 	void edgeConflict(int a1, int a2, int v1, int v2, int t)
 	{
-        constraint1.clear();
-        constraint2.clear();
 		this->a1 = a1;
 		this->a2 = a2;
-		this->constraint1.emplace_back(a1, v1, v2, t, constraint_type::EDGE);
-		this->constraint2.emplace_back(a2, v2, v1, t, constraint_type::EDGE);
+		this->constraint1.assign(1, Constraint(a1, v1, v2, t, constraint_type::EDGE));
+		this->constraint2.assign(1, Constraint(a2, v2, v1, t, constraint_type::EDGE));
 		type = conflict_type::STANDARD;
 	}
 
 	void corridorConflict(int a1, int a2, int v1, int v2, int t1, int t2)
 	{
-        constraint1.clear();
-        constraint2.clear();
 		this->a1 = a1;
 		this->a2 = a2;
-		this->constraint1.emplace_back(a1, v1, 0, t1, constraint_type::RANGE);
-		this->constraint2.emplace_back(a2, v2, 0, t2, constraint_type::RANGE);
+		this->constraint1.assign(1, Constraint(a1, v1, 0, t1, constraint_type::RANGE));
+		this->constraint2.assign(1, Constraint(a2, v2, 0, t2, constraint_type::RANGE));
 		type = conflict_type::CORRIDOR;
 	}
 
 	bool rectangleConflict(int a1, int a2, const std::pair<int, int>& Rs, const std::pair<int, int>& Rg,
-	                         int Rg_t, const list<Constraint>& constraint1, const list<Constraint>& constraint2) // For RM
+	                         int Rg_t, const ConstraintList& constraint1, const ConstraintList& constraint2) // For RM
 	{
 		this->a1 = a1;
 		this->a2 = a2;
@@ -84,12 +90,10 @@ public:
 
 	void targetConflict(int a1, int a2, int v, int t)
 	{
-        constraint1.clear();
-        constraint2.clear();
 		this->a1 = a1;
 		this->a2 = a2;
-		this->constraint1.emplace_back(a1, v, -1, t, constraint_type::LEQLENGTH);
-		this->constraint2.emplace_back(a1, v, -1, t, constraint_type::GLENGTH);
+		this->constraint1.assign(1, Constraint(a1, v, -1, t, constraint_type::LEQLENGTH));
+		this->constraint2.assign(1, Constraint(a1, v, -1, t, constraint_type::GLENGTH));
 		type = conflict_type::TARGET;
 	}
 
@@ -108,6 +112,8 @@ public:
 
 };
 
+typedef boost::intrusive_ptr<Conflict> ConflictPtr;
+
 std::ostream& operator<<(std::ostream& os, const Conflict& conflict);
 
 bool operator < (const Conflict& conflict1, const Conflict& conflict2);
@@ -0,0 +1,38 @@
+#pragma once
+#include "common.h"
+
+// The conflict avoidance table (CAT) shared by all low-level searches of a high-level search.
+// It is kept in sync with the current paths by adding and removing paths,
+// and indexes the agents at each location and timestep, which is also used for detecting conflicts.
+class ConflictAvoidanceTable
+{
+public:
+	void init(size_t map_size, int num_of_agents);
+	void clear();
+
+	void updatePath(int agent, const Path* path); // replace the path of the agent (nullptr removes it)
+	void updatePaths(const vector<Path*>& paths); // replace the paths whose pointers have changed
+
+	int getNumOfAgents(size_t loc, int t) const; // number of agents at the location at the timestep
+	// 1 if the step of the agent collides with the other agents, otherwise 0
+	int getNumOfConflictsForStep(int agent, size_t curr_id, size_t next_id, int next_timestep) const;
+
+	// the agents whose paths have vertex, edge or target conflicts with the path of the given agent, in increasing order
+	void getConflictingAgents(int agent, vector<int>& agents) const;
+
+	int getNumOfAgents() const { return (int)paths.size(); }
+	const Path& getPath(int agent) const { return paths[agent]; } // empty if the agent has no path
+	int getMakespan() const; // the maximal path length - 1
+
+private:
+	// location -> timestep -> <number of agents, sum of their ids>, so that a single agent can be identified without a list
+	vector<vector<pair<int, int> > > table;
+	vector<vector<pair<int, int> > > goal_arrivals; // location -> <timestep from which the agent stays at the location forever, agent>
+	vector<Path> paths; // the paths in the table
+	vector<const Path*> path_pointers; // the pointers of the paths in the table
+
+	void insertPath(int agent);
+	void deletePath(int agent);
+	bool occupies(int agent, size_t loc, int t) const; // whether the agent is at the location at the timestep
+	void getAgentsOnPaths(size_t loc, int t, int agent, vector<int>& agents) const; // the other agents that are at the location at the timestep before reaching their goals
+};
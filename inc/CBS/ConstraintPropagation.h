@@ -6,8 +6,26 @@
 #include <boost/unordered_set.hpp>
 #include "MDD.h"
 
-typedef std::pair<MDDNode*, MDDNode*> node_pair;
-typedef std::pair<node_pair, node_pair> edge_pair;
+// The mutexes between the nodes of two MDDs at one level, where the nodes at the level are indexed by
+// their positions in MDD::levels. Bit j of row i is set if the i-th node of MDD 0 and the j-th node of MDD 1 are mutexed.
+struct MutexMatrix
+{
+  int num_rows = 0;
+  int num_cols = 0;
+  int num_words = 0; // per row
+  std::vector<uint64_t> bits;
+
+  void reset(int rows, int cols){
+    num_rows = rows;
+    num_cols = cols;
+    num_words = (cols + 63) / 64;
+    bits.assign((size_t)rows * num_words, 0);
+  }
+  uint64_t* row(int i) { return bits.data() + (size_t)i * num_words; }
+  const uint64_t* row(int i) const { return bits.data() + (size_t)i * num_words; }
+  bool get(int i, int j) const { return (row(i)[j / 64] >> (j % 64)) & 1; }
+  void set(int i, int j) { row(i)[j / 64] |= (uint64_t)1 << (j % 64); }
+};
 
 class ConstraintPropagation{
 private:
@@ -16,53 +34,33 @@ private:
   MDD* mdd0;
   MDD* mdd1;
 
+  int num_level = 0; // number of levels with mutexes, i.e., the number of levels of the shorter MDD
+  // the nodes at each level when the mutexes are initialized, and the positions of the nodes indexed by their ids
+  // (-1 if not at any level). The MDDs can grow after that, but the mutexes only refer to these nodes.
+  std::vector<std::vector<MDDNode*> > nodes0, nodes1;
+  std::vector<int> index0, index1;
 
-  // check whether two nodes could be mutexed
-  // return true if they are mutexed
-  bool should_be_fwd_mutexed(MDDNode*, MDDNode*);
-
-  bool should_be_fwd_mutexed(MDDNode* node_a, MDDNode* node_a_to,
-                         MDDNode* node_b, MDDNode* node_b_to);
-
-  bool should_be_bwd_mutexed(MDDNode*, MDDNode*);
-  bool should_be_bwd_mutexed(MDDNode* node_a, MDDNode* node_a_to,
-                             MDDNode* node_b, MDDNode* node_b_to);
-
-
-  void add_bwd_node_mutex(MDDNode* node_a, MDDNode* node_b);
-
-  void add_fwd_node_mutex(MDDNode* node_a, MDDNode* node_b);
-  void add_fwd_edge_mutex(MDDNode* node_a, MDDNode* node_a_to,
-                      MDDNode* node_b, MDDNode* node_b_to);
+  std::vector<MutexMatrix> fwd_mutexes; // one matrix per level
+  std::vector<MutexMatrix> bwd_mutexes; // including the forward mutexes
 
-  // boost::unordered_set<node_pair> node_cons;
-
-  /*
-    A Mutex is in the form of <<node*, node*>, <node*, node*>>
-    if second node* in each pair are nullptr, then it is a node mutex
-
-   */
-
-  // void fwd_mutex_prop_generalized_helper(MDD* mdd_0, MDD* mdd_1, int level);
+  // set the rows of dst at level `to` that are implied by the mutexes src at the adjacent level `from`:
+  // two nodes are mutexed if every pair of their neighbors at level `from` is mutexed or
+  // is connected to them by a pair of swapping edges
+  void propagate(const MutexMatrix& src, MutexMatrix& dst, int from, int to);
+  bool get_mutex(const std::vector<MutexMatrix>& mutexes, MDDNode* a, MDDNode* b) const;
 
 public:
   ConstraintPropagation(MDD* mdd0, MDD* mdd1):
     mdd0(mdd0), mdd1(mdd1)
   {}
 
-  boost::unordered_set<edge_pair> fwd_mutexes;
-  boost::unordered_set<edge_pair> bwd_mutexes;
-
-  void init_mutex();
+  void init_mutex(); // the vertex mutexes; the edge mutexes (swapping edges) are tested on the fly
   void fwd_mutex_prop();
   // void fwd_mutex_prop_generalized();
 
   void bwd_mutex_prop();
 
-  bool has_mutex(edge_pair);
   bool has_mutex(MDDNode*, MDDNode*);
-
-  bool has_fwd_mutex(edge_pair);
   bool has_fwd_mutex(MDDNode*, MDDNode*);
 
   // MDD 0 of level_0 and MDD 1 of level_1 mutexed at goal
@@ -3,6 +3,23 @@
 #include "CBSNode.h"
 #include "PathTable.h"
 
+typedef pair<int, int> TimeRange; // [t_min, t_max)
+typedef pair<size_t, TimeRange> KeyedTimeRange; // location/edge -> time range
+
+// The constraints of one agent at a CT node, i.e., those on the path from the root to the node.
+// A layer is built from the layer of the closest ancestor that has one for the agent plus the constraints added since,
+// and it is immutable once built, so the descendants that add no constraints for the agent share it.
+struct ConstraintLayer
+{
+	int length_min = 0;
+	int length_max = MAX_TIMESTEP;
+	int latest_timestep = 0; // no negative constraints after this timestep
+	vector<KeyedTimeRange> constraints; // location/edge -> time range, sorted by location/edge index
+	vector<pair<int, int> > landmarks; // <timestep, location>
+
+	bool empty() const { return length_min == 0 && length_max == MAX_TIMESTEP && constraints.empty() && landmarks.empty(); }
+};
+
 class ConstraintTable
 {
 public:
@@ -17,11 +34,8 @@ public:
 
 	int getHoldingTime() const; // the earliest timestep that the agent can hold its goal location
 
-	// void clear(){ct.clear(); cat_small.clear(); cat_large.clear(); landmarks.clear(); length_min = 0, length_max = INT_MAX; latest_timestep = 0;}
-
 	bool constrained(size_t loc, int t) const;
     bool constrained(size_t curr_loc, size_t next_loc, int next_t) const;
-	int getNumOfConflictsForStep(size_t curr_id, size_t next_id, int next_timestep) const;
 	// ConstraintTable() = default;
 	ConstraintTable(const PathTable& path_table, size_t num_col, size_t map_size, int goal_location = -1) :
             path_table(path_table), goal_location(goal_location), num_col(num_col), map_size(map_size)
@@ -35,29 +49,40 @@ public:
 	void init(const ConstraintTable& other) {copy(other); }
 	void clear()
 	{
-	    ct.clear();
-	    landmarks.clear();
-	    cat.clear();
+		ct_ranges.clear();
+		landmarks.clear();
 	}
-	void build(const HLNode& node, int agent); // build the constraint table for the given agent at the give node 
-	void buildCAT(int agent, const vector<Path*>& paths, size_t cat_size); // build the conflict avoidance table
+	void build(const HLNode& node, int agent); // build the constraint table for the given agent at the give node
+	shared_ptr<const ConstraintLayer> getLayer(const HLNode& node, int agent) const; // nullptr if there are no constraints
+	void cacheLayer(HLNode& node, int agent) const; // store the layer at the node for the builds at its descendants
+	// the constraints that the node adds for the agent on top of those of its parent (unsorted)
+	void addConstraints(ConstraintLayer& layer, const HLNode& node, int agent) const;
 
 	void insert2CT(size_t loc, int t_min, int t_max); // insert a vertex constraint to the constraint table
 	void insert2CT(size_t from, size_t to, int t_min, int t_max); // insert an edge constraint to the constraint table
 
 protected:
     // Constraint Table (CT)
-	unordered_map<size_t, list<pair<int, int> > > ct; // location -> time range, or edge -> time range
+	// location/edge -> time range, sorted by location/edge index (locations come first as they are < map_size).
+	// Only the constrained locations and edges are stored, so building and copying the CT does not depend on the map size.
+	vector<KeyedTimeRange> ct_ranges;
 
-	unordered_map<size_t, size_t> landmarks; // <timestep, location>: the agent must be at the given location at the given timestep
+	vector<int> landmarks; // timestep -> location: the agent must be at the given location at the given timestep (-1 if none)
 
 	void insertLandmark(size_t loc, int t); // insert a landmark, i.e., the agent has to be at the given location at the given timestep
 	list<pair<int, int> > decodeBarrier(int B1, int B2, int t) const;
 
 	inline size_t getEdgeIndex(size_t from, size_t to) const { return (1 + from) * map_size + to; }
 
-private:
-	vector<vector<bool> > cat; // conflict avoidance table
+	// merge the ranges, which are sorted by location/edge index, into the sorted table
+	static void mergeSorted(const vector<KeyedTimeRange>& ranges, vector<KeyedTimeRange>& table);
+	// sort staged by location/edge index and merge it into the sorted table
+	static void sortAndMerge(vector<KeyedTimeRange>& staged, vector<KeyedTimeRange>& table);
+	// the time ranges of the given location/edge in the sorted table
+	static pair<vector<KeyedTimeRange>::const_iterator, vector<KeyedTimeRange>::const_iterator>
+		findRanges(const vector<KeyedTimeRange>& table, size_t key);
 
+private:
+	static bool compareKeys(const KeyedTimeRange& a, const KeyedTimeRange& b) { return a.first < b.first; }
+	static int getLatestTimestep(const TimeRange& range) { return range.second < MAX_TIMESTEP ? range.second : range.first; }
 };
-
@@ -15,20 +15,21 @@ public:
 		const vector<ConstraintTable>& initial_constraints):
 		search_engines(search_engines), initial_constraints(initial_constraints) {}
 	
-	shared_ptr<Conflict> run(const shared_ptr<Conflict>& conflict,
+	ConflictPtr run(const ConflictPtr& conflict,
 		const vector<Path*>& paths, const HLNode& node);
 
 private:
 	const vector<SingleAgentSolver*>& search_engines;
 	const vector<ConstraintTable>& initial_constraints;
 
-	shared_ptr<Conflict> findCorridorConflict(const shared_ptr<Conflict>& conflict,
+	ConflictPtr findCorridorConflict(const ConflictPtr& conflict,
 		const vector<Path*>& paths, const HLNode& node);
-	int findCorridor(const shared_ptr<Conflict>& conflict,
+	int findCorridor(const ConflictPtr& conflict,
 		const vector<Path*>& paths, int endpoints[], int endpoints_time[]); // return the length of the corridor 
 	int getEnteringTime(const std::vector<PathEntry>& path, const std::vector<PathEntry>& path2, int t);
 	int getExitingTime(const std::vector<PathEntry>& path, int t);
 	int getCorridorLength(const std::vector<PathEntry>& path, int t_start, int loc_end, std::pair<int, int>& edge);
+	int getBypassLowerBound(const Path& path, int id, int endpoint) const; // see Instance::getBypassLength
 
 
 	// int getBypassLength(int start, int end, std::pair<int, int> blocked, const bool* my_map, int num_col, int map_size);
@@ -18,31 +18,37 @@ public:
 	ECBSNode* getGoalNode() { return goal_node; }
     void updatePaths(ECBSNode* curr);
 	void clear();
+	void reset(vector<SingleAgentSolver*>& search_engines) { clear(); resetAgents(search_engines); }
 private:
     //ECBSNode* dummy_start = nullptr;
     ECBSNode* goal_node = nullptr;
 
 	vector<int> min_f_vals; // lower bounds of the cost of the shortest path
+	size_t next_eviction = 0; // evict nodes when the memory usage exceeds both this and the memory limit
 	vector< pair<Path, int> > paths_found_initially;  // contain initial paths found
 
 	pairing_heap< ECBSNode*, compare<ECBSNode::compare_node_by_f> > cleanup_list; // it is called open list in ECBS
 	pairing_heap< ECBSNode*, compare<ECBSNode::compare_node_by_inadmissible_f> > open_list; // this is used for EES
 	pairing_heap< ECBSNode*, compare<ECBSNode::compare_node_by_d> > focal_list; // this is ued for both ECBS and EES
 
-	void adoptBypass(ECBSNode* curr, ECBSNode* child, const vector<int>& fmin_copy);
+	void adoptBypass(ECBSNode* curr, ECBSNode* child);
 
 	// node operators
 	void pushNode(ECBSNode* node);
 	ECBSNode* selectNode();
 	bool reinsertNode(ECBSNode* node);
+	bool isSelectable(const ECBSNode* node) const;
     void releaseNodes();
+	void evictNodes(); // evict the worst unexpanded nodes to meet the memory limit
+	void regenerateNode(ECBSNode* node); // recompute the paths and conflicts of an evicted node
 
 	 // high level search
-	bool generateChild(ECBSNode* child, ECBSNode* curr);
+	bool generateChild(ECBSNode* child, ECBSNode* curr, CTNodeWorkspace& workspace);
+	void generateChildren(ECBSNode* child[2], ECBSNode* curr, bool solved[2]); // generate the two children in parallel
 	bool generateRoot();
-	bool findPathForSingleAgent(ECBSNode*  node, int ag);
+	bool findPathForSingleAgent(ECBSNode*  node, int ag, CTNodeWorkspace& workspace);
 	void classifyConflicts(ECBSNode &node);
-	void computeConflictPriority(shared_ptr<Conflict>& con, ECBSNode& node);
+	void computeConflictPriority(ConflictPtr& con, ECBSNode& node);
 
 	//update information
 	void printPaths() const;
@@ -75,9 +75,17 @@ public:
 	int sum_of_costs = 0;  // sum of costs of the paths
 	ECBSNode* parent;
 	list< pair< int, pair<Path, int> > > paths; // new paths <agent id, <path, min f>>	
+	bool evicted = false; // the paths and conflicts are dropped, and only the agents and their min f are kept in paths
 	inline int getFHatVal() const { return sum_of_costs + cost_to_go; }
 	inline int getNumNewPaths() const { return (int) paths.size(); }
 	inline string getName() const { return "ECBS Node"; }
+	size_t getMemoryUsage() const override
+	{
+		size_t memory = sizeof(ECBSNode) + HLNode::getMemoryUsage();
+		for (const auto& path : paths)
+			memory += sizeof(path) + 2 * sizeof(void*) + sizeof(PathEntry) * path.second.first.capacity();
+		return memory;
+	}
 	list<int> getReplannedAgents() const
 	{
 		list<int> rst;
@@ -0,0 +1,78 @@
+#pragma once
+#include "MDD.h"
+#include <queue>
+#include <memory>
+
+// Results of the 2-agent sub-problems of WDG and root MDDs that outlive a single CBS/ECBS run,
+// so that the LNS iterations can reuse the ones of the previous iterations.
+// The agents are identified by their ids in the instance, and the other agents are only
+// represented by the path table. So an entry is reused only if the agents have the same constraints
+// and the path table has not changed in the region that the paths of the agents within the cached costs could visit.
+class HeuristicCache
+{
+public:
+	struct PairKey
+	{
+		int a1; // a1 < a2
+		int a2;
+		vector<Constraint> constraints[2]; // sorted constraints on a1 and a2 (with the ids of the agents in the instance)
+
+		bool operator==(const PairKey& other) const
+		{
+			return a1 == other.a1 && a2 == other.a2 &&
+				constraints[0] == other.constraints[0] && constraints[1] == other.constraints[1];
+		}
+
+		struct Hasher
+		{
+			size_t operator()(const PairKey& key) const;
+		};
+	};
+
+	uint64_t num_pair_hits = 0;
+	uint64_t num_pair_misses = 0; // including the entries whose regions have changed
+	uint64_t num_mdd_hits = 0;
+	uint64_t num_mdd_misses = 0;
+
+	HeuristicCache(const PathTable& path_table, size_t max_num_of_pairs = 100000) :
+		path_table(path_table), max_num_of_pairs(max_num_of_pairs) {}
+
+	// return true and set h and the shortest path lengths of the agents if the sub-problem is cached.
+	// solver1 and solver2 are the solvers of key.a1 and key.a2.
+	bool findPair(const PairKey& key, const SingleAgentSolver& solver1, const SingleAgentSolver& solver2,
+		int& h, int& length1, int& length2);
+	void insertPair(const PairKey& key, const SingleAgentSolver& solver1, const SingleAgentSolver& solver2,
+		int h, int length1, int length2);
+	// MDD of the agent without any constraints (other than the path table), or nullptr if it is not cached
+	const MDD* findMDD(int agent, const SingleAgentSolver& solver);
+	void insertMDD(int agent, const SingleAgentSolver& solver, const MDD& mdd);
+	void clear();
+
+private:
+	struct PairEntry
+	{
+		int h;
+		int lengths[2];
+		uint64_t fingerprints[2]; // content of the path table in the regions of the two agents
+	};
+	struct MDDEntry
+	{
+		std::unique_ptr<MDD> mdd;
+		uint64_t fingerprint;
+	};
+
+	const PathTable& path_table;
+	size_t max_num_of_pairs;
+	unordered_map<PairKey, PairEntry, PairKey::Hasher> pairs;
+	std::queue<const PairKey*> insertion_order; // the oldest pairs are evicted first
+	unordered_map<int, MDDEntry> mdds;
+
+	// buffers of getFingerprint
+	vector<int> distances; // distances from the start location, -1 if not visited
+	vector<int> region;
+
+	// hash the content of the path table at the locations and timesteps that
+	// any path of the agent that is no longer than max_length could visit
+	uint64_t getFingerprint(const SingleAgentSolver& solver, int max_length);
+	uint64_t getFingerprint(const SingleAgentSolver& solver1, const SingleAgentSolver& solver2, int cost, int i);
+};
@@ -3,60 +3,86 @@
 #include "ECBSNode.h"
 
 
+class MDDNode;
+
+// A contiguous range of MDD nodes, e.g., the children of a node or the nodes at a level
+class MDDNodeRange
+{
+public:
+	MDDNode* const* begin() const { return first; }
+	MDDNode* const* end() const { return first + num; }
+	size_t size() const { return num; }
+	bool empty() const { return num == 0; }
+	MDDNode* front() const { return *first; }
+	MDDNode* back() const { return first[num - 1]; }
+	MDDNode* operator[](size_t i) const { return first[i]; }
+
+private:
+	MDDNode** first = nullptr;
+	int num = 0;
+	friend class MDD;
+};
+
 class MDDNode
 {
 public:
-	MDDNode(int currloc, MDDNode* parent)
-	{
-		location = currloc; 
-		if(parent == nullptr)
-			level = 0;
-		else
-		{
-			level = parent->level + 1;
-			parents.push_back(parent);
-		}
-	}
-	MDDNode(int location, int t): location(location), level(t) {}
+	MDDNode(int location, int level, int cost): location(location), level(level), cost(cost) {}
 	int location;
 	int level;
-  int cost; // minimum cost of path traversing this MDD node
+	int cost; // minimum cost of path traversing this MDD node
+	int id = -1; // index of the node in its MDD, which is smaller than MDD::getNumOfNodes()
 
 	bool operator == (const MDDNode & node) const
 	{
 		return (this->location == node.location) && (this->level == node.level);
 	}
 
-
-	list<MDDNode*> children;
-	list<MDDNode*> parents;
+	MDDNodeRange children;
+	MDDNodeRange parents;
 };
 
+// The nodes of an MDD are allocated in blocks of contiguous memory, and the nodes at each level
+// (sorted by their locations) and the children and parents of each node are ranges of a single pointer array.
+// So an MDD is built, copied and traversed by linear scans instead of chasing list nodes.
 class MDD
 {
 private:
     const SingleAgentSolver* solver;
+	vector<vector<MDDNode> > node_blocks; // one block per build or copy, plus one per increaseBy
+	vector<MDDNode*> links; // the nodes at each level, then the children of each node, then the parents of each node
+	int num_of_nodes = 0;
+
+	MDDNode* addNodes(vector<MDDNode>& block); // move the block into the MDD, set the ids of its nodes and return its first node
+	// set the nodes at each level and the <parent, child> edges (the nodes not at any level can still have edges)
+	void setLinks(vector<vector<MDDNode*> >& level_nodes, const vector<pair<MDDNode*, MDDNode*> >& edges);
+	// copy the nodes of other whose ids are kept, and the edges between them except the removed <from, to, t> ones
+	void copyNodes(const MDD& other, const vector<bool>& kept, const vector<tuple<int, int, int> >& removed_edges);
 
 public:
-	vector<list<MDDNode*>> levels;
+	vector<MDDNodeRange> levels;
 
 	bool buildMDD(const ConstraintTable& ct,
 		int num_of_levels, const SingleAgentSolver* solver); // build mdd of given levels
 	bool buildMDD(ConstraintTable& ct, const SingleAgentSolver* solver); // build minimal MDD
+	// build the MDD of the same levels by pruning the MDD of the parent CT node with the constraints added by the child
+	bool buildMDD(const MDD& parent, const ConstraintLayer* new_constraints, size_t map_size);
 	// bool buildMDD(const std::vector <std::list< std::pair<int, int> > >& constraints, int numOfLevels,
 	// 	int start_location, const int* moves_offset, const std::vector<int>& my_heuristic, int map_size, int num_col);
 
 	MDDNode* find(int location, int level) const;
-	void deleteNode(MDDNode* node);
 	void clear();
+	int getNumOfNodes() const { return num_of_nodes; } // including the nodes removed from the levels by increaseBy
+	size_t getMemoryUsage() const; // in bytes
 	// bool isConstrained(int curr_id, int next_id, int next_timestep, const std::vector< std::list< std::pair<int, int> > >& cons) const;
 
+	// add dLevel levels. The existing nodes keep their addresses, as mutex propagation refers to them.
     void increaseBy(const ConstraintTable&ct, int dLevel, SingleAgentSolver* solver);
     MDDNode* goalAt(int level);
     void printNodes() const;
 
 	MDD()= default;;
 	MDD(const MDD & cpy);
+	MDD& operator=(const MDD&) = delete;
 	~MDD();
 };
 
@@ -104,11 +130,18 @@ public:
 	~SyncMDD();
 };
 
+class HeuristicCache;
+
+// MDDs are cached per (agent, constraint set). The cache is bounded by the total memory of its MDDs,
+// and the least recently used MDDs are evicted first.
 class MDDTable
 {
 public:
 	double accumulated_runtime = 0;  // runtime of building MDDs
-	uint64_t num_released_mdds = 0; // number of released MDDs ( to save memory)
+	uint64_t num_derived_mdds = 0; // number of MDDs built by pruning the MDDs of the parent CT nodes
+	uint64_t num_hits = 0; // number of MDDs found in the cache
+	uint64_t num_misses = 0; // number of MDDs built
+	uint64_t num_evicted_mdds = 0; // number of MDDs evicted from the cache (to save memory)
 
 	MDDTable(const vector<ConstraintTable>& initial_constraints,
 						const vector<SingleAgentSolver*>& search_engines):
@@ -120,19 +153,35 @@ public:
 	}
 	~MDDTable() { clear(); }
 
+	void setHeuristicCache(HeuristicCache* cache, const vector<int>& ids) { heuristic_cache = cache; agent_ids = ids; }
+	void setMemoryLimit(size_t m) { memory_limit = m; } // in bytes
+	size_t getMemoryUsage() const { return memory_usage; } // in bytes
 	MDD* findMDD(HLNode& node, int agent) const;
 	MDD * getMDD(HLNode& node, int agent, size_t mdd_levels);
 	// void findSingletons(HLNode& node, int agent, Path& path);
 	void clear();
 private:
-	int max_num_of_mdds = 10000; // per agent
+	// The MDDs returned by the last two calls of getMDD are never evicted, as the callers use them in pairs.
+	static const size_t MIN_NUM_OF_MDDS = 2;
+	size_t memory_limit = (size_t)1 << 30; // for all agents
+	size_t memory_usage = 0;
 
-	vector<unordered_map<ConstraintsHasher, MDD*, 
+	typedef list<pair<int, ConstraintsHasher> > LRUList; // <agent, constraint set>, most recently used first
+	struct Entry
+	{
+		MDD* mdd;
+		size_t memory; // in bytes
+		LRUList::iterator lru_position;
+	};
+	LRUList lru_list;
+	vector<unordered_map<ConstraintsHasher, Entry,
 		ConstraintsHasher::Hasher, ConstraintsHasher::EqNode> >lookupTable;
 
 	const vector<ConstraintTable>& initial_constraints;
 	const vector<SingleAgentSolver*>& search_engines;
-	void releaseMDDMemory(int id);
+	HeuristicCache* heuristic_cache = nullptr; // shares the root MDDs across CBS runs
+	vector<int> agent_ids; // ids of the agents in the instance, which identify them in heuristic_cache
+	void releaseMDDMemory(); // evict the least recently used MDDs until the cache fits in the memory limit
 };
 
 unordered_map<int, MDDNode*> collectMDDlevel(MDD* mdd, int i);
@@ -6,7 +6,8 @@ public:
 	double accumulated_runtime = 0;
 	MutexReasoning(const Instance& instance, const vector<ConstraintTable>& initial_constraints) : 
 		instance(instance), initial_constraints(initial_constraints) {}
-	shared_ptr<Conflict> run(int a1, int a2, CBSNode& node, MDD* mdd_1, MDD* mdd_2);
+	ConflictPtr run(int a1, int a2, CBSNode& node, MDD* mdd_1, MDD* mdd_2);
+	void clear() { lookupTable.clear(); }
 
 	vector < SingleAgentSolver* > search_engines;  // used to find (single) agents' paths and mdd
 
@@ -19,11 +20,11 @@ private:
   // (cons_hasher_0, cons_hasher_1) -> Constraint
   // Invariant: cons_hasher_0.a < cons_hasher_1.a
   unordered_map<ConstraintsHasher,
-                unordered_map<ConstraintsHasher, shared_ptr<Conflict>, ConstraintsHasher::Hasher, ConstraintsHasher::EqNode>,
+                unordered_map<ConstraintsHasher, ConflictPtr, ConstraintsHasher::Hasher, ConstraintsHasher::EqNode>,
                 ConstraintsHasher::Hasher, ConstraintsHasher::EqNode
                 > lookupTable;
 
-  shared_ptr<Conflict> findMutexConflict(int a1, int a2, CBSNode& node, MDD* mdd_1, MDD* mdd_2);
+  ConflictPtr findMutexConflict(int a1, int a2, CBSNode& node, MDD* mdd_1, MDD* mdd_2);
 };
 
 // other TODOs
@@ -8,21 +8,62 @@ class RectangleReasoning
 public:
 	//rectangle_strategy strategy;
 	double accumulated_runtime = 0;
+	uint64_t num_hits = 0; // number of conflicts classified by the lookup table
+	uint64_t num_misses = 0;
+	double saved_runtime = 0; // runtime spent on computing the results that are later found in the lookup table
 
 	RectangleReasoning(const Instance& instance) : instance(instance) {}
 
-	shared_ptr<Conflict> run(const vector<Path*>& paths, int timestep, 
-		int a1, int a2, const MDD* mdd1, const MDD* mdd2);
+	ConflictPtr run(const vector<Path*>& paths, int timestep, 
+		int a1, int a2, const MDD* mdd1, const MDD* mdd2, HLNode& node);
+	void clear() { lookupTable.clear(); }
 
 
 private:
 	const Instance& instance;
-	shared_ptr<Conflict> findRectangleConflictByRM(const vector<Path*>& paths, int timestep,
+
+	// The result only depends on the MDDs, i.e., on the constraints and the path lengths of the agents,
+	// and on the conflicting vertex, except that the paths have to be blocked by the barrier constraints.
+	struct LookupKey
+	{
+		ConstraintsHasher c1, c2;
+		int timestep, location;
+		int length1, length2;
+
+		struct EqNode
+		{
+			bool operator() (const LookupKey& k1, const LookupKey& k2) const
+			{
+				return k1.timestep == k2.timestep && k1.location == k2.location &&
+					k1.length1 == k2.length1 && k1.length2 == k2.length2 &&
+					ConstraintsHasher::EqNode()(k1.c1, k2.c1) && ConstraintsHasher::EqNode()(k1.c2, k2.c2);
+			}
+		};
+		struct Hasher
+		{
+			std::size_t operator()(const LookupKey& key) const
+			{
+				size_t seed = ConstraintsHasher::Hasher()(key.c1);
+				for (size_t h : { ConstraintsHasher::Hasher()(key.c2), (size_t)key.timestep, (size_t)key.location,
+					(size_t)key.length1, (size_t)key.length2 })
+					seed ^= h + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+				return seed;
+			}
+		};
+	};
+	struct LookupEntry
+	{
+		ConflictPtr rectangle; // nullptr if there is no rectangle conflict
+		double runtime;
+	};
+	unordered_map<LookupKey, LookupEntry, LookupKey::Hasher, LookupKey::EqNode> lookupTable;
+
+	ConflictPtr findRectangleConflictByRM(const vector<Path*>& paths, int timestep,
 		int a1, int a2, const MDD* mdd1, const MDD* mdd2);
-	shared_ptr<Conflict> findRectangleConflictByGR(const vector<Path*>& paths, int timestep,
+	ConflictPtr findRectangleConflictByGR(const vector<Path*>& paths, int timestep,
 		int a1, int a2, const MDD* mdd1, const MDD* mdd2);
 
-	bool ExtractBarriers(const MDD& mdd, int loc, int timestep, int dir, int dir2, int start, int goal, int start_time, list<Constraint>& B);
+	bool ExtractBarriers(const MDD& mdd, int loc, int timestep, int dir, int dir2, int start, int goal, int start_time, ConstraintList& B);
 	bool isEntryBarrier(const Constraint& b1, const Constraint& b2, int dir1);
 	bool isExitBarrier(const Constraint& b1, const Constraint& b2, int dir1);
 	pair<int, int> getIntersection(const Constraint& b1, const Constraint& b2);
@@ -31,7 +72,7 @@ private:
 	bool isCut(const Constraint b, const pair<int, int>& Rs, const pair<int, int>& Rg);
 
 	void generalizedRectangle(const vector<PathEntry>& path1, const vector<PathEntry>& path2, const MDD& mdd1, const MDD& mdd2,
-		const list<Constraint>& B1, const list<Constraint>& B2, int timestep,
+		const ConstraintList& B1, const ConstraintList& B2, int timestep,
 		int& best_type, pair<int, int>& best_Rs, pair<int, int>& best_Rg);
 
 	//Identify rectangle conflicts
@@ -62,17 +103,17 @@ private:
 	bool addModifiedBarrierConstraints(int a1, int a2, const pair<int, int>& Rs, const pair<int, int>& Rg,
 		const pair<int, int>& s1, const pair<int, int>& s2, int Rg_t,
 		const MDD* mdd1, const MDD* mdd2,
-		list<Constraint>& constraint1, list<Constraint>& constraint2); // for RM
+		ConstraintList& constraint1, ConstraintList& constraint2); // for RM
 
 	// add a horizontal modified barrier constraint
 	bool addModifiedHorizontalBarrierConstraint(int agent, const MDD* mdd, int x,
-		int Ri_y, int Rg_y, int Rg_t, list<Constraint>& constraints);
+		int Ri_y, int Rg_y, int Rg_t, ConstraintList& constraints);
 
 	// add a vertival modified barrier constraint
 	bool addModifiedVerticalBarrierConstraint(int agent, const MDD* mdd, int y,
-		int Ri_x, int Rg_x, int Rg_t, list<Constraint>& constraints);
+		int Ri_x, int Rg_x, int Rg_t, ConstraintList& constraints);
 
-	bool blocked(const Path& path, const list<Constraint>& constraints);
+	bool blocked(const Path& path, const ConstraintList& constraints);
 	bool traverse(const Path& path, int loc, int t);
 
 };
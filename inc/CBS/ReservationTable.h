@@ -1,6 +1,7 @@
 // This is used by SIPP
 #pragma once
 #include "ConstraintTable.h"
+#include "ConflictAvoidanceTable.h"
 
 typedef tuple<size_t, size_t, size_t> Interval; // [t_min, t_max), num_of_collisions
 
@@ -16,29 +17,35 @@ public:
 	ReservationTable(const ConstraintTable& other) : ConstraintTable(other.path_table, other.num_col, other.map_size) { copy(other); }
 
 
-    list<Interval> get_safe_intervals(size_t location, size_t lower_bound, size_t upper_bound);
-	list<Interval> get_safe_intervals(size_t from, size_t to, size_t lower_bound, size_t upper_bound);
+    vector<Interval> get_safe_intervals(size_t location, size_t lower_bound, size_t upper_bound);
+	vector<Interval> get_safe_intervals(size_t from, size_t to, size_t lower_bound, size_t upper_bound);
 
 	// int get_holding_time(int location);
    Interval get_first_safe_interval(size_t location);
     bool find_safe_interval(Interval& interval, size_t location, size_t t_min);
 
-	void buildCAT(int agent, const vector<Path*>& paths); // build the conflict avoidance table
+	void buildCAT(int agent, const ConflictAvoidanceTable& cat); // build the soft constraints from the paths in the CAT
 
     void print() const;
 
 private:
 	// Safe Interval Table (SIT)
-	unordered_map<size_t, list<Interval > > sit; // location/edge -> [t_min, t_max), num_of_collisions
-	// Conflict Avoidance Table (CAT)
-	unordered_map< size_t, list<pair<int, int> > > cat; //  location/edge -> time range
-
-    void insert2RT(size_t location, size_t t_min, size_t t_max);
-    void insertSoftConstraint2RT(size_t location, size_t t_min, size_t t_max);
+	// The safe intervals of a location/edge are stored contiguously in sit_intervals once they are computed;
+	// sit_slots maps a location to its [begin, end) in sit_intervals (begin = -1 if not computed yet),
+	// and sit_edge_slots does the same for edges and is sorted by edge index.
+	vector<Interval> sit_intervals; // [t_min, t_max), num_of_collisions
+	vector<pair<int, int> > sit_slots;
+	vector<pair<size_t, pair<int, int> > > sit_edge_slots;
+	vector<Interval> sit_buffer; // the safe intervals of the location/edge that is being updated
+	bool sit_buffer_created = false;
+	// Conflict Avoidance Table (CAT), stored in the same way as the CT
+	vector<KeyedTimeRange> cat_ranges;
+
+    void insert2RT(size_t t_min, size_t t_max); // insert a hard constraint to sit_buffer
+    void insertSoftConstraint2RT(size_t t_min, size_t t_max); // insert a soft constraint to sit_buffer
 	// void mergeIntervals(list<Interval >& intervals) const;
 
-	
-	void updateSIT(size_t location); // update SIT at the gvien location
+	pair<int, int> updateSIT(size_t location); // update SIT at the gvien location and return its slot
 
 	int getNumOfConflictsForStep(size_t curr_id, size_t next_id, size_t next_timestep) const;
 };
\ No newline at end of file
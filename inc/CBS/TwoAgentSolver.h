@@ -0,0 +1,56 @@
+#pragma once
+#include "SingleAgentSolver.h"
+
+// Find the minimal sum of costs of two agents by A* in their joint space-time state space.
+// It is used to compute the edge weights of WDG without building a nested CBS solver.
+class TwoAgentSolver
+{
+public:
+	uint64_t num_expanded = 0;
+	uint64_t num_generated = 0;
+	bool optimal = false; // false if the search is terminated by the node limit
+
+	TwoAgentSolver(const SingleAgentSolver* solver1, const SingleAgentSolver* solver2,
+		const ConstraintTable& constraint_table1, const ConstraintTable& constraint_table2) :
+		solvers{solver1, solver2}, constraint_tables{&constraint_table1, &constraint_table2} {}
+
+	// Return the minimal sum of costs, or a lower bound of it (that is at least the given lowerbound)
+	// if more than node_limit nodes are expanded, or MAX_COST if there is no solution.
+	// min_length1 and min_length2 are lower bounds of the path lengths of the two agents, e.g., their shortest path lengths.
+	int solve(int min_length1, int min_length2, int lowerbound, int node_limit);
+
+private:
+	struct Node
+	{
+		int locations[2];
+		int timestep;
+		int g_val; // sum of the finishing timesteps of the finished agents and the current timestep of the others
+		int h_val;
+		int finished; // bit i is set if agent i has finished, i.e., stays at its goal location forever
+		uint64_t time_generated;
+
+		int getFVal() const { return g_val + h_val; }
+
+		struct compare_node
+		{
+			// returns true if n1 > n2 (note -- this gives us *min*-heap).
+			bool operator()(const Node& n1, const Node& n2) const
+			{
+				if (n1.getFVal() != n2.getFVal())
+					return n1.getFVal() > n2.getFVal();
+				if (n1.g_val != n2.g_val)
+					return n1.g_val < n2.g_val; // break ties towards larger g_vals
+				return n1.time_generated < n2.time_generated; // and then towards newer nodes, i.e., depth-first
+			}
+		};
+	};
+
+	const SingleAgentSolver* solvers[2];
+	const ConstraintTable* constraint_tables[2];
+	int holding_times[2];
+	int min_lengths[2];
+
+	void getMoves(const Node& curr, int agent, vector<pair<int, bool> >& moves) const; // <next location, finished>
+	int computeHeuristic(int agent, int location, int timestep) const; // lower bound of the remaining cost of the agent
+	uint64_t getKey(const Node& node) const;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include "common.h"
+
+// Minimum weighted vertex cover of a graph with edge weights, i.e., minimize the sum of x_i
+// s.t. x_i + x_j >= w_ij for every edge (i, j), where x_i are nonnegative integers.
+// The graph is reduced by removing leaves and satisfied edges, split into connected components,
+// and each component is solved by branch and bound with bitset adjacency and matching lower bounds.
+// The optimal values of the graphs are memoized, as the conflict graphs of sibling CT nodes share most components.
+class WeightedVertexCover
+{
+public:
+	uint64_t num_memoization = 0; // number of graphs whose optimal values are found in the memo
+	uint64_t num_aborted = 0; // number of graphs whose branch and bound exceeds the node limit
+
+	// G[i * n + j] is the weight of edge (i, j), which is symmetric, or 0 if there is no such edge.
+	// Return the optimal value, a lower bound of it if the branch and bound exceeds its node limit,
+	// or -1 if it runs out of time, i.e., the wall-clock time since start_time exceeds time_limit seconds.
+	int solve(const vector<int>& G, int n, const steady_clock::time_point& start_time, double time_limit);
+	void clear() { memo.clear(); }
+
+	static const int MAX_NUM_OF_NODES = 64; // the graphs with more nodes are not supported
+
+private:
+	static const uint64_t NODE_LIMIT = 1 << 16; // per component
+	static const size_t MAX_MEMO_SIZE = 1 << 16;
+
+	struct VectorHasher
+	{
+		size_t operator()(const vector<int>& v) const
+		{
+			size_t seed = v.size();
+			for (int i : v)
+				seed ^= std::hash<int>()(i) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+			return seed;
+		}
+	};
+	unordered_map<vector<int>, int, VectorHasher> memo; // <n, the upper triangle of G> -> optimal value
+
+	// the graph being solved
+	int n = 0;
+	vector<int> weights; // n * n
+	uint64_t adj[MAX_NUM_OF_NODES]; // adjacency lists as bitsets
+
+	// branch and bound on one component
+	vector<int> order; // the nodes of the component in the order of assignment
+	vector<int> x; // values of the assigned nodes
+	vector<vector<int> > needs; // needs[k][i] is the minimum value of node i given the first k assignments
+	int best = 0;
+	uint64_t num_expanded = 0;
+	steady_clock::time_point start_time;
+	double time_limit = 0;
+	bool timeout = false;
+
+	int kernelize(vector<int>& lb, uint64_t& remaining); // return the sum of the values fixed by the reduction rules
+	int lowerBound(const vector<int>& need, uint64_t unassigned) const; // the sum of needs plus a greedy matching of the residual weights
+	int solveComponent(uint64_t component, const vector<int>& lb, bool& exact);
+	void branch(int k, int sum, uint64_t unassigned);
+};
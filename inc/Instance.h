@@ -1,5 +1,6 @@
 #pragma once
 #include"common.h"
+#include <mutex>
 
 
 // Currently only works for undirected unweighted 4-nighbor grids
@@ -70,6 +71,19 @@ public:
 		return degree;
 	}
 
+	// A corridor is a maximal chain of cells with degree 2. Its endpoints are the two cells with degree != 2
+	// next to the ends of the chain (or -1 if the chain is a ring), and its cells are ordered from endpoints[0] to endpoints[1].
+	struct Corridor
+	{
+		int endpoints[2];
+		vector<int> cells;
+		int getLength() const { return (int)cells.size() + 1; } // number of edges between the endpoints
+	};
+	inline int getCorridorId(int loc) const { return corridor_ids[loc]; } // -1 if loc is not inside a corridor
+	inline int getCorridorIndex(int loc) const { return corridor_indices[loc]; } // position of loc in Corridor::cells
+	inline const Corridor& getCorridor(int id) const { return corridors[id]; }
+	int getBypassLength(int id) const; // shortest distance between the endpoints without entering the corridor, or MAX_TIMESTEP
+
 	int getDefaultNumberOfAgents() const { return num_of_agents; }
 	string getInstanceName() const { return agent_fname; }
 private:
@@ -82,7 +96,15 @@ private:
 	  vector<int> start_locations;
 	  vector<int> goal_locations;
 
+	  // corridor decomposition of the map, computed once in the constructor
+	  vector<int> corridor_ids;
+	  vector<int> corridor_indices;
+	  vector<Corridor> corridors;
+	  mutable vector<int> bypass_lengths; // computed on demand; -1 if not computed yet
+	  mutable std::mutex bypass_mutex; // CBS solvers of the WDG sub-problems query the bypasses in parallel
+
 	  bool loadMap();
+	  void findCorridors();
 	  void printMap() const;
 	  void saveMap() const;
 
@@ -1,11 +1,13 @@
 #pragma once
 #include "ECBS.h"
 #include "SpaceTimeAStar.h"
+#include <atomic>
 #include <chrono>
 #include <utility>
 
 //pibt related
-#include "simplegrid.h"
+#include "instancegrid.h"
+#include "distanceoracle.h"
 #include "pibt_agent.h"
 #include "problem.h"
 #include "mapf.h"
@@ -51,6 +53,7 @@ public:
     double initial_solution_runtime = 0;
     double runtime = 0;
     int initial_sum_of_costs = -1;
+    int first_window_sum_of_costs = -1; // only for the rolling-horizon mode
     int sum_of_costs = -1;
     int sum_of_costs_lowerbound = -1;
     int sum_of_distances = -1;
@@ -58,7 +61,9 @@ public:
     int num_of_failures = 0; // #replanning that fails to find any solutions
     LNS(const Instance& instance, double time_limit,
         string init_algo_name, string replan_algo_name, string destory_name,
-        int neighbor_size, int num_of_iterations, int screen, PIBTPPS_option pipp_option);
+        int neighbor_size, int num_of_iterations, int screen, PIBTPPS_option pipp_option, int num_of_threads = 1,
+        bool init_lns = false, double portfolio_grace_period = 0, int window = 0, int commit_steps = 0,
+        bool parallel_root = false);
 
     bool getInitialSolution();
     bool run();
@@ -80,12 +85,32 @@ private:
     destroy_heuristic destroy_strategy = RANDOMWALK;
     int neighbor_size;
     int num_of_iterations;
+    int num_of_threads; // threads for generating CT nodes in EECBS and CBS
+    bool parallel_root; // plan the root paths of EECBS and CBS on all threads as well
+    bool init_lns; // find the initial solution by repairing the collisions of a collision-tolerant solution
+    vector<string> portfolio; // initial solvers that run concurrently, empty if init_algo_name is a single solver
+    double portfolio_grace_period; // seconds that the other solvers may run to find a cheaper solution after the first one
+    string portfolio_winner; // the initial solver whose solution is used
+    const std::atomic<bool>* interrupted = nullptr; // set when the portfolio no longer needs this solver
+    int window; // collisions are resolved only within the first window timesteps, MAX_TIMESTEP for the full horizon
+    int commit_steps; // timesteps that are committed before the window is advanced
+
+    // rolling-horizon LNS
+    int num_of_windows = 1; // each window has its own initial solution
+    int committed_timestep = 0;
+    vector<Path> committed_paths; // the paths from the start locations to the current locations
+    vector<int> finish_times; // the last timestep when each committed path arrives at its goal
 
     high_resolution_clock::time_point start_time;
 
 
     PathTable path_table; // 1. stores the paths of all agents in a time-space table;
     // 2. avoid making copies of this variable as much as possible.
+    HeuristicCache heuristic_cache; // WDG sub-problems and root MDDs shared by the EECBS and CBS runs across iterations
+    std::unique_ptr<ECBS> ecbs; // EECBS solver that is reused across iterations
+    std::unique_ptr<CBS> cbs; // CBS solver that is reused across iterations
+    PathTableWC path_table_wc; // stores the paths that may collide, only used for finding the initial solution by LNS
+    vector< set<int> > collision_graph; // colliding agents of each agent, only used for finding the initial solution by LNS
 
     Neighbor neighbor;
 
@@ -105,20 +130,38 @@ private:
     bool runPIBT();
     bool runPPS();
     bool runWinPIBT();
+    bool runInitLNS();
+    bool runPortfolio();
+
+    bool findInitialSolution();
+    void improveSolution(double end_time);
+    bool runRollingHorizon();
+    int getSolutionCost() const;
+
+    // a member of the portfolio, which runs the initial solver init_algo_name on its own copy of the agents
+    LNS(const LNS& parent, const string& init_algo_name, const std::atomic<bool>* interrupted, unsigned seed);
+    bool isInterrupted() const { return interrupted != nullptr && *interrupted; }
 
     PIBTPPS_option pipp_option;
+    std::mt19937 pibt_random_generator; // reseeded for every PIBT problem
+    std::mt19937 random_generator; // agent orders and neighborhoods; each portfolio member has its own
+    int getRandomInt(int n) { return std::uniform_int_distribution<int>(0, n - 1)(random_generator); } // in [0, n)
+    std::unique_ptr<Graph> pibt_graph; // PIBT view of the instance, built on first use and reused across runs
+    std::unique_ptr<DistanceOracle> pibt_distances; // backed by the heuristic tables of the agents
 
-    MAPF preparePIBTProblem(vector<int> shuffled_agents);
-    void updatePIBTResult(const PIBT_Agents& A,vector<int> shuffled_agents);
+    MAPF preparePIBTProblem(const vector<int>& shuffled_agents);
+    bool solvePIBTProblem(Solver& solver, MAPF& P, const vector<int>& shuffled_agents);
+    bool updatePIBTResult(const PIBT_Agents& A, const vector<int>& shuffled_agents);
 
     void chooseDestroyHeuristicbyALNS();
 
     bool generateNeighborByRandomWalk();
     //bool generateNeighborByStart();
     bool generateNeighborByIntersection(bool temporal = true);
+    bool generateNeighborByCollisionGraph();
 
     int findMostDelayedAgent();
-    int findRandomAgent() const;
+    int findRandomAgent();
     void randomWalk(int agent_id, int start_location, int start_timestep,
                     set<int>& neighbor, int neighbor_size, int upperbound);
 };
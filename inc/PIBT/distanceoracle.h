@@ -0,0 +1,38 @@
+/*
+ * distanceoracle.h
+ *
+ * Purpose: shortest distances to goal nodes, shared by the PIBT family
+ */
+
+#pragma once
+#include <memory>
+#include <limits>
+#include "graph.h"
+
+// The distances to a goal are kept in a table indexed by node id.
+// The tables are either given from outside, e.g., the heuristic tables of the LNS agents,
+// or computed by a backward BFS from the goal on first use, whose paths may end at blocked nodes
+// but do not pass through them.
+class DistanceOracle {
+private:
+  Graph* G;
+  std::unordered_map<int, const std::vector<int>*> tables;  // goal id -> distances
+  std::vector<std::unique_ptr<std::vector<int>>> ownTables;
+  std::vector<Nodes> predecessors;  // for digraphs, built on first use
+  std::vector<bool> blocked;  // indexed by node id, empty if no node is blocked
+
+  const std::vector<int>& getTable(Node* g);
+
+public:
+  static const int UNREACHABLE = std::numeric_limits<int>::max() / 2;
+
+  DistanceOracle(Graph* _G) : G(_G) {}
+  DistanceOracle(Graph* _G, std::vector<bool> _blocked) : G(_G), blocked(std::move(_blocked)) {}
+
+  // the table must outlive the oracle and use UNREACHABLE (or any larger value) for unreachable nodes
+  void setTable(int g, const std::vector<int>* table) { tables[g] = table; }
+
+  int dist(Node* v, Node* g) { return getTable(g)[v->getId()]; }
+  // a shortest path from s to g that descends the distances, empty if g is unreachable
+  Nodes getPath(Node* s, Node* g);
+};
@@ -47,6 +47,7 @@ private:
 protected:
   // nodes
   Nodes nodes;
+  Nodes nodeTable;  // nodes indexed by id, nullptr for obstacles
 
   // cache of searched path
   std::unordered_map<std::string, KnownPath*> knownPaths;
@@ -75,11 +76,12 @@ public:
   Node* getNode(int x, int y);
   Nodes getNodes() { return nodes; }
   int getNodesNum() { return nodes.size(); }
+  int getIdRange() { return nodeTable.size(); }  // node ids are in [0, getIdRange())
   int getNodeIndex(Node* v);
   Node* getNodeFromIndex(int i) { return nodes[i]; }
 
-  Nodes neighbor(Node* v);
-  Nodes neighbor(int id);
+  const Nodes& neighbor(Node* v);
+  const Nodes& neighbor(int id);
 
   // implemented in Grid class
   virtual int getW() { return 0; };
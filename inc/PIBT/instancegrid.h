@@ -0,0 +1,29 @@
+/*
+ * instancegrid.h
+ *
+ * Purpose: grid built from the map of an Instance that is already in memory,
+ *          so that the PIBT solvers do not re-read and re-parse the map file
+ */
+
+#pragma once
+#include "grid.h"
+#include "Instance.h"
+
+class InstanceGrid : public Grid {
+protected:
+  const Instance& instance;
+
+  void createNodes();
+  void createEdges();
+
+public:
+  InstanceGrid(const Instance& _instance, std::mt19937* _MT);
+  ~InstanceGrid();
+
+  // for iterative MAPF
+  virtual Node* getNewGoal(Node* v);
+
+  std::string getMapName() { return instance.getMapFile(); }
+
+  std::string logStr();
+};
@@ -12,14 +12,12 @@ private:
   std::vector<Node*> neighbor;
   Vec2f pos;
 
-  static int cntIndex;
-
 public:
   Node();
-  Node(int _id);
+  Node(int _id, int _index);  // index is the position of the node in its graph
   ~Node() {};
 
-  std::vector<Node*> getNeighbor() { return neighbor; }
+  const std::vector<Node*>& getNeighbor() { return neighbor; }
   void setNeighbor(std::vector<Node*> nodes) { neighbor = nodes; }
 
   int getId() { return id; }
@@ -10,28 +10,25 @@ protected:
   std::vector<int> eta;  // usually increment every step
   std::vector<float> priority;  // eta + epsilon
 
+  // scratch buffers, reused over timesteps
+  std::vector<int> order;  // agents sorted by priority
+  std::vector<bool> undecided;  // whether the next node of the agent is not decided yet
+  std::vector<int> occupied;  // agent at each node (by node index), -1 if none
+  std::vector<int> closed;  // node (by node index) is closed if its value equals stamp
+  int stamp;
+  std::vector<Nodes> candidates;  // candidates at each depth of priority inheritance
+  Nodes shuffled;  // for chooseNode
+  Nodes ties;  // for chooseNode
+
   void init();
   void allocate();
 
   virtual void updatePriority();
-  Nodes createCandidates(PIBT_Agent* a, Nodes CLOSE_NODE);
-  Nodes createCandidates(PIBT_Agent* a, Nodes CLOSE_NODE, Node* tmp);
-  bool priorityInheritance(PIBT_Agent* a,
-                           Nodes& CLOSE_NODE,
-                           PIBT_Agents& OPEN_AGENT,
-                           std::vector<float>& PL);
-  bool priorityInheritance(PIBT_Agent* a,
-                           PIBT_Agent* aFrom,
-                           Nodes& CLOSE_NODE,
-                           PIBT_Agents& OPEN_AGENT,
-                           std::vector<float>& PL);
-  virtual bool priorityInheritance(PIBT_Agent* a,
-                                   Nodes C,
-                                   Nodes& CLOSE_NODE,
-                                   PIBT_Agents& OPEN_AGENT,
-                                   std::vector<float>& PL);
-  virtual Node* chooseNode(PIBT_Agent* a, Nodes C);
-  void updateC(Nodes& C, Node* target, Nodes CLOSE_NODE);
+  void createCandidates(PIBT_Agent* a, Node* from, Nodes& C);
+  virtual bool priorityInheritance(int i, Node* from, int depth);
+  virtual Node* chooseNode(PIBT_Agent* a, const Nodes& C);
+  void updateC(Nodes& C);
+  void move(int i, Node* target);
 
   float getDensity(PIBT_Agent* a);  // density can be used as effective prioritization
 
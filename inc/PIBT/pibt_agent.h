@@ -13,11 +13,11 @@ struct AgentStatus {
 class PIBT_Agent {
 private:
     int id;
-    static int cntId;  // for uuid
+    static std::atomic<int> cntId;  // for uuid, shared by the solvers running concurrently
     Node* v;           // current node
     Node* g;           // current goal
     Task* tau;         // task
-    std::vector<AgentStatus*> hist;  // agent history
+    std::vector<AgentStatus> hist;  // agent history
 
     bool updated;      // whether goal is updated or not
     Node* beforeNode;  // previous location node, auto updated
@@ -25,6 +25,7 @@ private:
 public:
     PIBT_Agent();
     PIBT_Agent(Node* v);  // initial location
+    PIBT_Agent(int _id, Node* v);  // the solvers use ids as indices, so ids must be 0, 1, ... within a problem
     ~PIBT_Agent();
 
     int getId() { return id; }
@@ -50,7 +51,7 @@ public:
     bool isUpdated() { return updated; }
 
     void updateHist();
-    std::vector<AgentStatus*> getHist() { return hist; }
+    const std::vector<AgentStatus>& getHist() const { return hist; }
 
     std::string logStr();
 
@@ -50,7 +50,7 @@ private:
   std::vector<bool> isTmpGoals;  // has temp goal
   Nodes deg3nodes;
 
-  static int s_uuid;
+  static std::atomic<int> s_uuid;
 
   void init();
 
@@ -1,10 +1,12 @@
 #pragma once
 
 #include "problem.h"
+#include "distanceoracle.h"
+#include "PathTable.h"
 #include <vector>
 #include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <eigen3/Eigen/Core>
 #include <unordered_map>
 #include <unordered_set>
 #include <boost/heap/fibonacci_heap.hpp>
@@ -24,30 +26,43 @@ protected:
   PIBT_Agents A;
   Graph* G;
 
-  Eigen::MatrixXi dists;
+  DistanceOracle* D;  // shortest distances to goals
+  std::unique_ptr<DistanceOracle> ownOracle;  // used unless an oracle is given
+
+  // paths of the agents that are not planned by the solver, which are fixed moving obstacles
+  // (indexed by node ids), nullptr if there are no such agents
+  const PathTable* fixedPaths;
 
   void init();
+  bool isSolved();
+  bool constrained(Node* from, Node* to, int t);
   int getMaxLengthPaths(Paths& paths);
   void formalizePath(Paths& paths);
   int pathDist(Node* v, Node* u);
   int pathDist(Node* s, Node* g, Nodes &prohibited);
   std::vector<PIBT_Agents> findAgentBlock();
-  static std::string getKey(int t, Node* v);
-  static std::string getKey(AN* n);
+  long long getKey(int t, Node* v);  // space-time key
+  long long getKey(AN* n);
 
   virtual void solveStart();
   virtual void solveEnd();
   std::chrono::system_clock::time_point startT;
   std::chrono::system_clock::time_point endT;
   double time_limit=0;
+  int timestep_limit=0;
+  const std::atomic<bool>* interrupted = nullptr;  // stop as soon as it is set, nullptr for never
+  bool isInterrupted() const { return interrupted != nullptr && *interrupted; }
 
 public:
   Solver(Problem* _P);
   Solver(Problem* _P, std::mt19937* _MT);
   ~Solver();
 
-  void WarshallFloyd();
+  void setDistanceOracle(DistanceOracle* _D) { D = _D; }
+  void setFixedPaths(const PathTable* _fixedPaths) { fixedPaths = _fixedPaths; }
   void setTimeLimit(double limit){this->time_limit=limit;};
+  void setTimestepLimit(int limit){this->timestep_limit=limit;};
+  void setInterruptFlag(const std::atomic<bool>* flag) { interrupted = flag; }
 
 
     virtual bool solve() { return false; };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include "node.h"
 
@@ -10,7 +11,7 @@ private:
   std::vector<Node*> G_CLOSE;  // finished nodes
 
   const int id;
-  static int cntId;  // for uuid
+  static std::atomic<int> cntId;  // for uuid, shared by the solvers running concurrently
 
   int startTime;  // timestep
   int endTime;
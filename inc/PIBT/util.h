@@ -6,7 +6,7 @@
 
 // vector
 template <typename T>
-static bool inArray(T a, std::vector<T> &arr) {
+static bool inArray(T a, const std::vector<T> &arr) {
   auto itr = std::find(arr.begin(), arr.end(), a);
   return itr != arr.end();
 }
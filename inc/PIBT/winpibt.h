@@ -18,6 +18,7 @@ protected:
   std::vector<float> epsilon;
   std::vector<int> eta;
   std::vector<float> priority;
+  std::vector<int> U;  // agents sorted by priority, reused over timesteps
 
   int ell(PIBT_Agent* a);
   int ell(int i);
@@ -1,5 +1,6 @@
 #pragma once
 #include "common.h"
+#include <random>
 
 #define NO_AGENT -1
 
@@ -7,17 +8,38 @@ class PathTable
 {
 public:
     int makespan = 0;
+    int window = MAX_TIMESTEP; // only the first window timesteps of the paths are stored, so only target conflicts happen afterward
     vector< vector<int> > table; // this stores the collision-free paths, the value is the id of the agent
     vector<int> goals; // this stores the goal locatons of the paths: key is the location, while value is the timestep when the agent reaches the goal
     void reset() { auto map_size = table.size(); table.clear(); table.resize(map_size); goals.assign(map_size, MAX_COST); makespan = 0; }
     void insertPath(int agent_id, const Path& path);
     void deletePath(int agent_id, const Path& path);
     bool constrained(int from, int to, int to_time) const;
+    // the constraints do not change after this timestep
+    int getStaticTimestep() const { return window < MAX_TIMESTEP ? window + 1 : makespan; }
 
     void get_agents(set<int>& conflicting_agents, int loc) const;
-    void get_agents(set<int>& conflicting_agents, int neighbor_size, int loc) const;
+    void get_agents(set<int>& conflicting_agents, int neighbor_size, int loc, std::mt19937& rng) const;
     void getConflictingAgents(int agent_id, set<int>& conflicting_agents, int from, int to, int to_time) const;
 
 
-    PathTable(int map_size = 0) : table(map_size), goals(map_size, MAX_COST) {}
+    PathTable(int map_size = 0, int window = MAX_TIMESTEP) : window(window), table(map_size), goals(map_size, MAX_COST) {}
+};
+
+class PathTableWC // with collisions
+{
+public:
+    int makespan = 0;
+    vector< vector< vector<int> > > table; // this stores the paths that may collide, the value is the ids of the agents
+    vector<int> goals; // this stores the goal locatons of the paths: key is the location, while value is the timestep when the agent reaches the goal
+    vector<int> goal_agents; // key is the location, while value is the id of the agent whose path ends there
+    void reset() { auto map_size = table.size(); table.clear(); table.resize(map_size);
+        goals.assign(map_size, MAX_COST); goal_agents.assign(map_size, NO_AGENT); makespan = 0; }
+    void insertPath(int agent_id, const Path& path);
+    void deletePath(int agent_id, const Path& path);
+    int getNumOfCollisions(int from, int to, int to_time) const;
+    int getHoldingTime(int location) const; // the earliest timestep after which no path visits the location
+    void getCollidingAgents(int agent_id, const Path& path, set<int>& colliding_agents) const;
+
+    PathTableWC(int map_size = 0) : table(map_size), goals(map_size, MAX_COST), goal_agents(map_size, NO_AGENT) {}
 };
\ No newline at end of file
@@ -68,9 +68,9 @@ public:
 	// minimizing the number of internal conflicts (that is conflicts with known_paths for other agents found so far).
 	// lowerbound is an underestimation of the length of the path in order to speed up the search.
 	Path findOptimalPath(const HLNode& node, const ConstraintTable& initial_constraints,
-		const vector<Path*>& paths, int agent, int lowerbound);
+		const ConflictAvoidanceTable& cat, int agent, int lowerbound);
 	pair<Path, int> findSuboptimalPath(const HLNode& node, const ConstraintTable& initial_constraints,
-		const vector<Path*>& paths, int agent, int lowerbound, double w);  // return the path and the lowerbound
+		const ConflictAvoidanceTable& cat, int agent, int lowerbound, double w);  // return the path and the lowerbound
 
 	int getTravelTime(int start, int end, const ConstraintTable& constraint_table, int upper_bound);
 
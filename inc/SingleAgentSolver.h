@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include "Instance.h"
 #include "ConstraintTable.h"
+#include "ConflictAvoidanceTable.h"
 
 class LLNode // low-level node
 {
@@ -23,7 +24,7 @@ public:
             {
                 if (n1->h_val == n2->h_val)
                 {
-                    return rand() % 2 == 0;   // break ties randomly
+                    return getTieBreakGenerator()() % 2 == 0;   // break ties randomly
                 }
                 return n1->h_val >= n2->h_val;  // break ties towards smaller h_vals (closer to goal location)
             }
@@ -42,7 +43,7 @@ public:
                 {
                     if (n1->h_val == n2->h_val)
                     {
-                        return rand() % 2 == 0;   // break ties randomly
+                        return getTieBreakGenerator()() % 2 == 0;   // break ties randomly
                     }
                     return n1->h_val >= n2->h_val;  // break ties towards smaller h_vals (closer to goal location)
                 }
@@ -92,9 +93,9 @@ public:
 	const Instance& instance;
 
 	virtual Path findOptimalPath(const HLNode& node, const ConstraintTable& initial_constraints,
-		const vector<Path*>& paths, int agent, int lower_bound) = 0;
+		const ConflictAvoidanceTable& cat, int agent, int lower_bound) = 0;
 	virtual pair<Path, int> findSuboptimalPath(const HLNode& node, const ConstraintTable& initial_constraints,
-		const vector<Path*>& paths, int agent, int lowerbound, double w) = 0;  // return the path and the lowerbound
+		const ConflictAvoidanceTable& cat, int agent, int lowerbound, double w) = 0;  // return the path and the lowerbound
 	virtual int getTravelTime(int start, int end, const ConstraintTable& constraint_table, int upper_bound) = 0;
 	virtual string getName() const = 0;
 
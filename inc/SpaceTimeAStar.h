@@ -53,14 +53,17 @@ public:
     // find path by time-space A* search
     // Returns a shortest path that does not collide with paths in the path table
     Path findOptimalPath(const PathTable& path_table);
+    // find path by time-space A* search
+    // Returns a path that has the fewest collisions with the paths in the path table, and then the shortest one
+    Path findMinCollisionPath(const PathTableWC& path_table);
 	// find path by time-space A* search
 	// Returns a shortest path that satisfies the constraints of the give node  while
 	// minimizing the number of internal conflicts (that is conflicts with known_paths for other agents found so far).
 	// lowerbound is an underestimation of the length of the path in order to speed up the search.
 	Path findOptimalPath(const HLNode& node, const ConstraintTable& initial_constraints,
-						const vector<Path*>& paths, int agent, int lower_bound);
+						const ConflictAvoidanceTable& cat, int agent, int lower_bound);
 	pair<Path, int> findSuboptimalPath(const HLNode& node, const ConstraintTable& initial_constraints,
-		const vector<Path*>& paths, int agent, int lowerbound, double w);  // return the path and the lowerbound
+		const ConflictAvoidanceTable& cat, int agent, int lowerbound, double w);  // return the path and the lowerbound
 
 	int getTravelTime(int start, int end, const ConstraintTable& constraint_table, int upper_bound);
 
@@ -0,0 +1,28 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <queue>
+#include "common.h"
+
+// A fixed number of worker threads that run the submitted tasks in FIFO order.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int num_of_threads);
+    ~ThreadPool(); // finishes the submitted tasks and joins the threads
+
+    std::future<void> submit(std::function<void()> task);
+    int getNumOfThreads() const { return (int) workers.size(); }
+
+private:
+    vector<std::thread> workers;
+    std::queue< std::packaged_task<void()> > tasks;
+    std::mutex tasks_mutex;
+    std::condition_variable tasks_cv;
+    bool stopped = false;
+
+    void work();
+};
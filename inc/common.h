@@ -4,9 +4,11 @@
 #include <vector>
 #include <set>
 #include <ctime>
+#include <chrono>
 #include <fstream>
 #include <iostream>     // std::cout, std::fixed
 #include <iomanip>      // std::setprecision
+#include <random>
 #include <boost/heap/pairing_heap.hpp>
 #include <boost/unordered_set.hpp>
 #include <boost/unordered_map.hpp>
@@ -29,6 +31,7 @@ using std::max;
 using std::shared_ptr;
 using std::make_shared;
 using std::clock;
+using std::chrono::steady_clock;
 using std::cout;
 using std::endl;
 using std::ofstream;
@@ -50,6 +53,11 @@ struct PathEntry
 typedef vector<PathEntry> Path;
 std::ostream& operator<<(std::ostream& os, const Path& path);
 bool isSamePath(const Path& p1, const Path& p2);
+// wall-clock seconds since start (clock() adds up the CPU time of all threads, so it is only used for profiling)
+double getElapsedTime(const steady_clock::time_point& start);
+// the generator of the current thread for the random tie-breaking of the searches
+// (unlike rand(), it is not shared by the threads of the portfolio or of (E)ECBS)
+std::mt19937& getTieBreakGenerator();
 
 struct IterationStats
 {
@@ -21,6 +21,8 @@ void AnytimeBCBS::run()
     bcbs.setNodeSelectionRule(node_selection::NODE_CONFLICTPAIRS);
     bcbs.setSavingStats(false);
     bcbs.setHighLevelSolver(high_level_solver_type::ASTAREPS, w);
+    bcbs.setNumOfThreads(num_of_threads);
+    bcbs.setParallelRoot(parallel_root);
 
     preprocessing_time = bcbs.runtime_preprocessing;
     sum_of_distances = 0;
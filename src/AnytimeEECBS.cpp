@@ -18,6 +18,9 @@ void AnytimeEECBS::run()
     ecbs.setConflictSelectionRule(conflict_selection::EARLIEST);
     ecbs.setNodeSelectionRule(node_selection::NODE_CONFLICTPAIRS);
     ecbs.setSavingStats(false);
+    ecbs.setMemoryLimit(memory_limit);
+    ecbs.setNumOfThreads(num_of_threads);
+    ecbs.setParallelRoot(parallel_root);
     preprocessing_time = ecbs.runtime_preprocessing;
     sum_of_distances = 0;
     for (int i = 0; i < num_of_agents; i++)
@@ -58,12 +61,15 @@ void AnytimeEECBS::run()
                  << "new w = " << w << ", "
                  << "remaining time = " << time_limit - runtime << endl;
     }
+    peak_ct_memory = ecbs.peak_ct_memory;
     ecbs.clearSearchEngines();
     cout << getSolverName() << ": Iterations = " << iteration_stats.size() << ", "
          << "lower bound = " << sum_of_costs_lowerbound << ", "
          << "solution cost = " << sum_of_costs << ", "
          << "initial solution cost = " << iteration_stats.front().sum_of_costs << ", "
-         << "runtime = " << runtime << endl;
+         << "runtime = " << runtime << ", "
+         << "peak CT memory = " << peak_ct_memory / 1048576.0 << " MB, "
+         << "evicted CT nodes = " << ecbs.num_evicted_nodes << endl;
 }
 
 
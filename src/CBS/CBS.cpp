@@ -1,6 +1,7 @@
 ﻿#include <algorithm>    // std::shuffle
 #include <random>      // std::default_random_engine
 #include <chrono>       // std::chrono::system_clock
+#include <atomic>
 #include "CBS.h"
 #include "SIPP.h"
 #include "SpaceTimeAStar.h"
@@ -25,13 +26,14 @@ void CBS::updatePaths(CBSNode* curr)
 		}
 		curr = curr->parent;
 	}
+	conflict_avoidance_table.updatePaths(paths);
 }
 
 
 // deep copy of all conflicts except ones that involve the particular agent
 // used for copying conflicts from the parent node to the child nodes
-/*void CBS::copyConflicts(const list<shared_ptr<Conflict>>& conflicts,
-	list<shared_ptr<Conflict>>& copy, int excluded_agent) const
+/*void CBS::copyConflicts(const vector<ConflictPtr>& conflicts,
+	vector<ConflictPtr>& copy, int excluded_agent) const
 {
 	for (const auto & conflict : conflicts)
 	{
@@ -42,8 +44,8 @@ void CBS::updatePaths(CBSNode* curr)
 	}
 }*/
 
-void CBS::copyConflicts(const list<shared_ptr<Conflict >>& conflicts,
-	list<shared_ptr<Conflict>>& copy, const list<int>& excluded_agents)
+void CBS::copyConflicts(const vector<ConflictPtr>& conflicts,
+	vector<ConflictPtr>& copy, const list<int>& excluded_agents)
 {
 	for (auto& conflict : conflicts)
 	{
@@ -66,7 +68,7 @@ void CBS::copyConflicts(const list<shared_ptr<Conflict >>& conflicts,
 }
 
 
-void CBS::findConflicts(HLNode& curr, int a1, int a2)
+void CBS::findConflicts(HLNode& curr, int a1, int a2, const vector<Path*>& paths) const
 {
 	int min_path_length = (int) (paths[a1]->size() < paths[a2]->size() ? paths[a1]->size() : paths[a2]->size());
 	for (int timestep = 0; timestep < min_path_length; timestep++)
@@ -75,7 +77,7 @@ void CBS::findConflicts(HLNode& curr, int a1, int a2)
 		int loc2 = paths[a2]->at(timestep).location;
 		if (loc1 == loc2)
 		{
-			shared_ptr<Conflict> conflict(new Conflict());
+			ConflictPtr conflict(new Conflict());
 			if (target_reasoning && paths[a1]->size() == timestep + 1)
 			{
 				conflict->targetConflict(a1, a2, loc1, timestep);
@@ -96,7 +98,7 @@ void CBS::findConflicts(HLNode& curr, int a1, int a2)
 			&& loc1 == paths[a2]->at(timestep + 1).location
 			&& loc2 == paths[a1]->at(timestep + 1).location)
 		{
-			shared_ptr<Conflict> conflict(new Conflict());
+			ConflictPtr conflict(new Conflict());
 			conflict->edgeConflict(a1, a2, loc1, loc2, timestep + 1);
 			assert(!conflict->constraint1.empty());
 			assert(!conflict->constraint2.empty());
@@ -113,14 +115,14 @@ void CBS::findConflicts(HLNode& curr, int a1, int a2)
 			int loc2 = paths[a2_]->at(timestep).location;
 			if (loc1 == loc2)
 			{
-				shared_ptr<Conflict> conflict(new Conflict());
+				ConflictPtr conflict(new Conflict());
 				if (target_reasoning)
 					conflict->targetConflict(a1_, a2_, loc1, timestep);
 				else
 					conflict->vertexConflict(a1_, a2_, loc1, timestep);
 				assert(!conflict->constraint1.empty());
 				assert(!conflict->constraint2.empty());
-				curr.unknownConf.push_front(conflict); // It's at least a semi conflict			
+				curr.unknownConf.insert(curr.unknownConf.begin(), conflict); // It's at least a semi conflict			
 			}
 		}
 	}
@@ -130,6 +132,16 @@ void CBS::findConflicts(HLNode& curr, int a1, int a2)
 void CBS::findConflicts(HLNode& curr)
 {
 	clock_t t = clock();
+	conflict_avoidance_table.updatePaths(paths);
+	findConflicts(curr, paths, conflict_avoidance_table);
+	runtime_detect_conflicts += (double)(clock() - t) / CLOCKS_PER_SEC;
+}
+
+// The candidate pairs of agents are looked up in the CAT, which indexes the current paths by location and timestep,
+// so detecting the conflicts of an agent takes time linear in the length of its path instead of in the number of agents.
+void CBS::findConflicts(HLNode& curr, const vector<Path*>& paths, const ConflictAvoidanceTable& cat) const
+{
+	vector<int> conflicting_agents;
 	if (curr.parent != nullptr)
 	{
 		// Copy from parent
@@ -141,10 +153,9 @@ void CBS::findConflicts(HLNode& curr)
 		for (auto it = new_agents.begin(); it != new_agents.end(); ++it)
 		{
 			int a1 = *it;
-			for (int a2 = 0; a2 < num_of_agents; a2++)
+			cat.getConflictingAgents(a1, conflicting_agents);
+			for (int a2 : conflicting_agents)
 			{
-				if (a1 == a2)
-					continue;
 				bool skip = false;
 				for (auto it2 = new_agents.begin(); it2 != it; ++it2)
 				{
@@ -155,7 +166,7 @@ void CBS::findConflicts(HLNode& curr)
 					}
 				}
 				if (!skip)
-					findConflicts(curr, a1, a2);
+					findConflicts(curr, a1, a2, paths);
 			}
 		}
 	}
@@ -163,22 +174,23 @@ void CBS::findConflicts(HLNode& curr)
 	{
 		for (int a1 = 0; a1 < num_of_agents; a1++)
 		{
-			for (int a2 = a1 + 1; a2 < num_of_agents; a2++)
+			cat.getConflictingAgents(a1, conflicting_agents);
+			for (int a2 : conflicting_agents)
 			{
-				findConflicts(curr, a1, a2);
+				if (a1 < a2)
+					findConflicts(curr, a1, a2, paths);
 			}
 		}
 	}
 	// curr.distance_to_go = (int)(curr.unknownConf.size() + curr.conflicts.size());
-	runtime_detect_conflicts += (double)(clock() - t) / CLOCKS_PER_SEC;
 }
 
 
-shared_ptr<Conflict> CBS::chooseConflict(const HLNode &node) const
+ConflictPtr CBS::chooseConflict(const HLNode &node) const
 {
 	if (screen == 3)
 		printConflicts(node);
-	shared_ptr<Conflict> choose;
+	ConflictPtr choose;
 	if (node.conflicts.empty() && node.unknownConf.empty())
 		return nullptr;
 	else if (!node.conflicts.empty())
@@ -243,7 +255,7 @@ void CBS::computeSecondPriorityForConflict(Conflict& conflict, const HLNode& nod
 	}
 }
 
-void CBS::computeConflictPriority(shared_ptr<Conflict>& con, CBSNode& node)
+void CBS::computeConflictPriority(ConflictPtr& con, CBSNode& node)
 {
 	int a1 = con->a1, a2 = con->a2;
 	int timestep = get<3>(con->constraint1.back());
@@ -304,16 +316,16 @@ void CBS::computeConflictPriority(shared_ptr<Conflict>& con, CBSNode& node)
 void CBS::classifyConflicts(CBSNode &node)
 {
 	// Classify all conflicts in unknownConf
-	while (!node.unknownConf.empty())
+	size_t num_classified = 0;
+	while (num_classified < node.unknownConf.size())
 	{
-		shared_ptr<Conflict> con = node.unknownConf.front();
+		ConflictPtr con = node.unknownConf[num_classified++];
 		int a1 = con->a1, a2 = con->a2;
 		int timestep = get<3>(con->constraint1.back());
 		constraint_type type = get<4>(con->constraint1.back());
 		//int a, loc1, loc2, timestep;
 		//constraint_type type;
 		//tie(a, loc1, loc2, timestep, type) = con->constraint1.back();
-		node.unknownConf.pop_front();
 
 		computeConflictPriority(con, node);
 
@@ -321,6 +333,7 @@ void CBS::classifyConflicts(CBSNode &node)
 		{
 			computeSecondPriorityForConflict(*con, node);
 			node.conflicts.push_back(con);
+			node.unknownConf.erase(node.unknownConf.begin(), node.unknownConf.begin() + num_classified);
 			return;
 		}
 
@@ -371,7 +384,7 @@ void CBS::classifyConflicts(CBSNode &node)
 		{
 			auto mdd1 = mdd_helper.getMDD(node, a1, paths[a1]->size());
 			auto mdd2 = mdd_helper.getMDD(node, a2, paths[a2]->size());
-			auto rectangle = rectangle_helper.run(paths, timestep, a1, a2, mdd1, mdd2);
+			auto rectangle = rectangle_helper.run(paths, timestep, a1, a2, mdd1, mdd2, node);
 			if (rectangle != nullptr)
 			{
 				computeSecondPriorityForConflict(*rectangle, node);
@@ -383,19 +396,19 @@ void CBS::classifyConflicts(CBSNode &node)
 		computeSecondPriorityForConflict(*con, node);
 		node.conflicts.push_back(con);
 	}
-
+	node.unknownConf.clear();
 
 
 	// remove conflicts that cannot be chosen, to save some memory
 	removeLowPriorityConflicts(node.conflicts);
 }
 
-void CBS::removeLowPriorityConflicts(list<shared_ptr<Conflict>>& conflicts) const
+void CBS::removeLowPriorityConflicts(vector<ConflictPtr>& conflicts) const
 {
 	if (conflicts.empty())
 		return;
-	unordered_map<int, shared_ptr<Conflict> > keep;
-	list<shared_ptr<Conflict>> to_delete;
+	unordered_map<int, ConflictPtr > keep;
+	vector<ConflictPtr> to_delete;
 	for (const auto& conflict : conflicts)
 	{
 		int a1 = min(conflict->a1, conflict->a2), a2 = max(conflict->a1, conflict->a2);
@@ -418,29 +431,32 @@ void CBS::removeLowPriorityConflicts(list<shared_ptr<Conflict>>& conflicts) cons
 
 	for (const auto& conflict : to_delete)
 	{
-		conflicts.remove(conflict);
+		conflicts.erase(std::remove(conflicts.begin(), conflicts.end(), conflict), conflicts.end());
 	}
 }
 
-bool CBS::findPathForSingleAgent(CBSNode*  node, int ag, int lowerbound)
+bool CBS::findPathForSingleAgent(CBSNode*  node, int ag, int lowerbound, CTNodeWorkspace& workspace)
 {
 	clock_t t = clock();
 	// build reservation table
 	// CAT cat(node->makespan + 1);  // initialized to false
 	// updateReservationTable(cat, ag, *node);
 	// find a path
-	Path new_path = search_engines[ag]->findOptimalPath(*node, initial_constraints[ag], paths, ag, lowerbound);
-	num_LL_expanded += search_engines[ag]->num_expanded;
-	num_LL_generated += search_engines[ag]->num_generated;
-	runtime_build_CT += search_engines[ag]->runtime_build_CT;
-	runtime_build_CAT += search_engines[ag]->runtime_build_CAT;
-	runtime_path_finding += (double)(clock() - t) / CLOCKS_PER_SEC;
+	auto& paths = workspace.paths;
+	initial_constraints[ag].cacheLayer(*node, ag); // only this thread writes to the child
+	Path new_path = search_engines[ag]->findOptimalPath(*node, initial_constraints[ag], workspace.conflict_avoidance_table, ag, lowerbound);
+	workspace.num_LL_expanded += search_engines[ag]->num_expanded;
+	workspace.num_LL_generated += search_engines[ag]->num_generated;
+	workspace.runtime_build_CT += search_engines[ag]->runtime_build_CT;
+	workspace.runtime_build_CAT += search_engines[ag]->runtime_build_CAT;
+	workspace.runtime_path_finding += (double)(clock() - t) / CLOCKS_PER_SEC;
 	if (!new_path.empty())
 	{
 		assert(!isSamePath(*paths[ag], new_path));
 		node->paths.emplace_back(ag, new_path);
 		node->g_val = node->g_val - (int)paths[ag]->size() + (int)new_path.size();
 		paths[ag] = &node->paths.back().second;
+		workspace.conflict_avoidance_table.updatePath(ag, paths[ag]);
 		node->makespan = max(node->makespan, new_path.size() - 1);
 		return true;
 	}
@@ -450,9 +466,14 @@ bool CBS::findPathForSingleAgent(CBSNode*  node, int ag, int lowerbound)
 	}
 }
 
-bool CBS::generateChild(CBSNode*  node, CBSNode* parent)
+// Replan the agents that violate the new constraints and detect the conflicts of the child.
+// Only the child and the workspace are modified, so the two children of a node can be generated in parallel
+// as long as they replan disjoint sets of agents, which generateChildren checks.
+// The heuristics are computed afterwards by the caller.
+bool CBS::generateChild(CBSNode*  node, CBSNode* parent, CTNodeWorkspace& workspace)
 {
 	clock_t t1 = clock();
+	syncWorkspace(workspace);
 	node->parent = parent;
 	node->HLNode::parent = parent;
 	node->g_val = parent->g_val;
@@ -550,24 +571,40 @@ bool CBS::generateChild(CBSNode*  node, CBSNode* parent)
 	for (auto agent : agents)
 	{
 		int lowerbound = (int)paths[agent]->size() - 1;
-		if (!findPathForSingleAgent(node, agent, lowerbound))
+		if (!findPathForSingleAgent(node, agent, lowerbound, workspace))
 		{
-			runtime_generate_child += (double)(clock() - t1) / CLOCKS_PER_SEC;
+			workspace.runtime_generate_child += (double)(clock() - t1) / CLOCKS_PER_SEC;
 			return false;
 		}
 	}
 
-	findConflicts(*node);
-	heuristic_helper.computeQuickHeuristics(*node);
-	runtime_generate_child += (double)(clock() - t1) / CLOCKS_PER_SEC;
+	clock_t t2 = clock();
+	findConflicts(*node, workspace.paths, workspace.conflict_avoidance_table);
+	workspace.runtime_detect_conflicts += (double)(clock() - t2) / CLOCKS_PER_SEC;
+	workspace.runtime_generate_child += (double)(clock() - t1) / CLOCKS_PER_SEC;
 	return true;
 }
 
+// The children share the search engines of the agents, so they are generated in parallel only if they replan disjoint sets of agents.
+void CBS::generateChildren(CBSNode* child[2], CBSNode* curr, bool solved[2])
+{
+	if (!replanDisjointAgents(*child[0], *child[1]))
+	{
+		for (int i = 0; i < 2; i++)
+			solved[i] = generateChild(child[i], curr, workspaces[i]);
+		return;
+	}
+	auto task = thread_pool->submit([&]() { solved[1] = generateChild(child[1], curr, workspaces[1]); });
+	solved[0] = generateChild(child[0], curr, workspaces[0]);
+	task.get();
+}
+
 inline void CBS::pushNode(CBSNode* node)
 {
 	num_HL_generated++;
 	node->time_generated = num_HL_generated;
     allNodes_table.push_back(node);
+	updateMemoryUsage(*node);
 	// update handles
     if (node->getFVal() >= cost_upperbound)
         return;
@@ -632,7 +669,7 @@ CBSNode* CBS::selectNode()
         case high_level_solver_type::ASTAR:
             cost_lowerbound = max(cost_lowerbound, cleanup_list.top()->getFVal());
             curr = cleanup_list.top();
-            curr->chosen_from = "cleanup";
+            curr->chosen_from = node_list::CLEANUP;
             /*curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
             curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
             curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;*/
@@ -662,7 +699,7 @@ CBSNode* CBS::selectNode()
 
             // choose best d in the focal list
             curr = focal_list.top();
-            curr->chosen_from = "focal";
+            curr->chosen_from = node_list::FOCAL;
             /*curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
             curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
             curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;
@@ -701,7 +738,8 @@ CBSNode* CBS::selectNode()
             { // return best d
                 curr = focal_list.top();
                 /* for debug */
-                curr->chosen_from = "focal";
+                curr->chosen_from = node_list::FOCAL;
+#ifdef DEBUG_HL_NODES
                 curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
                 curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
                 curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;
@@ -711,6 +749,7 @@ CBSNode* CBS::selectNode()
                 curr->f_of_best_in_focal = focal_list.top()->getFVal();
                 curr->f_hat_of_best_in_focal = focal_list.top()->getFHatVal();
                 curr->d_of_best_in_focal = focal_list.top()->distance_to_go;
+#endif
                 /* end for debug */
                 focal_list.pop();
                 cleanup_list.erase(curr->cleanup_handle);
@@ -720,7 +759,8 @@ CBSNode* CBS::selectNode()
             { // return best f_hat
                 curr = open_list.top();
                 /* for debug */
-                curr->chosen_from = "open";
+                curr->chosen_from = node_list::OPEN;
+#ifdef DEBUG_HL_NODES
                 curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
                 curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
                 curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;
@@ -730,6 +770,7 @@ CBSNode* CBS::selectNode()
                 curr->f_of_best_in_focal = focal_list.top()->getFVal();
                 curr->f_hat_of_best_in_focal = focal_list.top()->getFHatVal();
                 curr->d_of_best_in_focal = focal_list.top()->distance_to_go;
+#endif
                 /* end for debug */
                 open_list.pop();
                 cleanup_list.erase(curr->cleanup_handle);
@@ -739,7 +780,8 @@ CBSNode* CBS::selectNode()
             { // return best f
                 curr = cleanup_list.top();
                 /* for debug */
-                curr->chosen_from = "cleanup";
+                curr->chosen_from = node_list::CLEANUP;
+#ifdef DEBUG_HL_NODES
                 curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
                 curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
                 curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;
@@ -749,6 +791,7 @@ CBSNode* CBS::selectNode()
                 curr->f_of_best_in_focal = focal_list.top()->getFVal();
                 curr->f_hat_of_best_in_focal = focal_list.top()->getFHatVal();
                 curr->d_of_best_in_focal = focal_list.top()->distance_to_go;
+#endif
                 /* end for debug */
                 cleanup_list.pop();
                 open_list.erase(curr->open_handle);
@@ -782,7 +825,7 @@ CBSNode* CBS::selectNode()
             {
                 // choose best f in the cleanup list (to improve the lower bound)
                 curr = cleanup_list.top();
-                curr->chosen_from = "cleanup";
+                curr->chosen_from = node_list::CLEANUP;
                 /*curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
                 curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
                 curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;*/
@@ -792,7 +835,7 @@ CBSNode* CBS::selectNode()
             {
                 // choose best d in the focal list
                 curr = focal_list.top();
-                /*curr->chosen_from = "focal";
+                /*curr->chosen_from = node_list::FOCAL;
                 curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
                 curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
                 curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;
@@ -816,7 +859,18 @@ CBSNode* CBS::selectNode()
 }
 
 
-set<int> CBS::getInvalidAgents(const list<Constraint>& constraints)  // return agents that violates the constraints
+bool CBS::replanDisjointAgents(const HLNode& child1, const HLNode& child2) const
+{
+	auto agents1 = getInvalidAgents(child1.constraints);
+	for (int agent : getInvalidAgents(child2.constraints))
+	{
+		if (agents1.count(agent) > 0)
+			return false;
+	}
+	return true;
+}
+
+set<int> CBS::getInvalidAgents(const ConstraintList& constraints) const // return agents that violates the constraints
 {
 	set<int> agents;
 	int agent, x, y, t;
@@ -960,10 +1014,13 @@ void CBS::saveResults(const string &fileName, const string &instanceName) const
 			"standard conflicts,rectangle conflicts,corridor conflicts,target conflicts,mutex conflicts," <<
 			"chosen from cleanup,chosen from open,chosen from focal," <<
 			"#solve MVCs,#merge MDDs,#solve 2 agents,#memoization," <<
+			"#MDD cache hits,#MDD cache misses,#MDD cache evictions," <<
+			"#rectangle cache hits,#rectangle cache misses," <<
 			"cost error,distance error," <<
 			"runtime of building heuristic graph,runtime of solving MVC," <<
 			"runtime of detecting conflicts," <<
 			"runtime of rectangle conflicts,runtime of corridor conflicts,runtime of mutex conflicts," <<
+			"saved runtime of rectangle conflicts," <<
 			"runtime of building MDDs,runtime of building constraint tables,runtime of building CATs," <<
 			"runtime of path finding,runtime of generating child nodes," <<
 			"preprocessing runtime,solver name,instance name" << endl;
@@ -987,6 +1044,8 @@ void CBS::saveResults(const string &fileName, const string &instanceName) const
 		heuristic_helper.num_merge_MDDs << "," << 
 		heuristic_helper.num_solve_2agent_problems << "," << 
 		heuristic_helper.num_memoization << "," <<
+		mdd_helper.num_hits << "," << mdd_helper.num_misses << "," << mdd_helper.num_evicted_mdds << "," <<
+		rectangle_helper.num_hits << "," << rectangle_helper.num_misses << "," <<
 		heuristic_helper.getCostError() << "," << heuristic_helper.getDistanceError() << "," <<
 		heuristic_helper.runtime_build_dependency_graph << "," << 
 		heuristic_helper.runtime_solve_MVC << "," <<
@@ -995,6 +1054,7 @@ void CBS::saveResults(const string &fileName, const string &instanceName) const
 
 		runtime_detect_conflicts << "," << 
 		rectangle_helper.accumulated_runtime << "," << corridor_helper.accumulated_runtime << "," << mutex_helper.accumulated_runtime << "," <<
+		rectangle_helper.saved_runtime << "," <<
 		mdd_helper.accumulated_runtime << "," << runtime_build_CT << "," << runtime_build_CAT << "," <<
 		runtime_path_finding << "," << runtime_generate_child << "," <<
 
@@ -1067,11 +1127,11 @@ void CBS::saveCT(const string &fileName) const // write the CT to a file
 			{
 				output << "\n #" << node->time_expanded << " from " << node->chosen_from;
 				output << "\", color=";
-				if (node->chosen_from == "focal")
+				if (node->chosen_from == node_list::FOCAL)
 					output << "blue]" << endl;
-				else if (node->chosen_from == "cleanup")
+				else if (node->chosen_from == node_list::CLEANUP)
 					output << "green]" << endl;
-				else if (node->chosen_from == "open")
+				else if (node->chosen_from == node_list::OPEN)
 					output << "orange]" << endl;
 			}
 			else
@@ -1099,20 +1159,24 @@ void CBS::saveCT(const string &fileName) const // write the CT to a file
 		std::ofstream output;
 		output.open(fileName + "-tree.csv", std::ios::out);
 		// header
-		output << "time generated,g value,h value,h^ value,d value,depth,time expanded,chosen from,h computed," 
+		output << "time generated,g value,h value,h^ value,d value,depth,time expanded,chosen from,h computed,"
+#ifdef DEBUG_HL_NODES
 			<< "f of best in cleanup,f^ of best in cleanup,d of best in cleanup," 
 			<< "f of best in open,f^ of best in open,d of best in open," 
 			<< "f of best in focal,f^ of best in focal,d of best in focal,"
+#endif
 			<< "praent,goal node" << endl;
 		for (auto& node : allNodes_table)
 		{
 			output << node->time_generated << ","
 				<< node->g_val << "," << node->h_val << "," << node->getFHatVal() - node->g_val << "," <<  node->distance_to_go << ","
 				<< node->depth << ","
-				<< node->time_expanded << "," << node->chosen_from << "," << node->h_computed << ","
-				<< node->f_of_best_in_cleanup << "," << node->f_hat_of_best_in_cleanup << "," << node->d_of_best_in_cleanup << ","
+				<< node->time_expanded << "," << node->chosen_from << "," << node->h_computed << ",";
+#ifdef DEBUG_HL_NODES
+			output << node->f_of_best_in_cleanup << "," << node->f_hat_of_best_in_cleanup << "," << node->d_of_best_in_cleanup << ","
 				<< node->f_of_best_in_open << "," << node->f_hat_of_best_in_open << "," << node->d_of_best_in_open << ","
 				<< node->f_of_best_in_focal << "," << node->f_hat_of_best_in_focal << "," << node->d_of_best_in_focal << ",";
+#endif
 			if (node->parent == nullptr)
 				output << "0,";
 			else
@@ -1194,7 +1258,7 @@ bool CBS::solve(double _time_limit, int _cost_lowerbound, int _cost_upperbound)
 		cout << name << ": ";
 	}
 	// set timer
-	start = clock();
+	start = steady_clock::now();
 
 	if(solution_found) // continue searching
     {
@@ -1223,9 +1287,9 @@ bool CBS::solve(double _time_limit, int _cost_lowerbound, int _cost_upperbound)
 
 		if (!curr->h_computed) // heuristics has not been computed yet
 		{
-			runtime = (double)(clock() - start) / CLOCKS_PER_SEC;
+			runtime = getElapsedTime(start);
 			bool succ = heuristic_helper.computeInformedHeuristics(*curr, time_limit - runtime);
-			runtime = (double)(clock() - start) / CLOCKS_PER_SEC;
+			runtime = getElapsedTime(start);
             heuristic_helper.updateOnlineHeuristicErrors(*curr);
             heuristic_helper.updateInadmissibleHeuristics(*curr); // compute inadmissible heuristics
 			/*if (runtime > time_limit)
@@ -1237,6 +1301,7 @@ bool CBS::solve(double _time_limit, int _cost_lowerbound, int _cost_upperbound)
 			if (!succ) // no solution, so prune this node
 			{
 				curr->clear();
+				updateMemoryUsage(*curr);
 				continue;
 			}
 
@@ -1270,19 +1335,23 @@ bool CBS::solve(double _time_limit, int _cost_lowerbound, int _cost_upperbound)
 				"	on " << *(curr->conflict) << endl;
 
 			bool solved[2] = { false, false };
-			vector<vector<PathEntry>*> copy(paths);
+			if (thread_pool != nullptr) // generate the second child on a worker thread
+				generateChildren(child, curr, solved);
 
 			for (int i = 0; i < 2; i++)
 			{
-				if (i > 0)
-					paths = copy;
-				solved[i] = generateChild(child[i], curr);
+				if (thread_pool == nullptr)
+					solved[i] = generateChild(child[i], curr, workspaces[i]);
+				collectStats(workspaces[i]);
 				if (!solved[i])
 				{
+					syncWorkspace(workspaces[i]);
 					delete (child[i]);
+					child[i] = nullptr;
 					continue;
 				}
-				else if (bypass && child[i]->g_val == curr->g_val && child[i]->distance_to_go < curr->distance_to_go) // Bypass1
+				heuristic_helper.computeQuickHeuristics(*child[i]);
+				if (bypass && child[i]->g_val == curr->g_val && child[i]->distance_to_go < curr->distance_to_go) // Bypass1
 				{
 					if (i == 1 && !solved[0])
 						continue;
@@ -1301,6 +1370,8 @@ bool CBS::solve(double _time_limit, int _cost_lowerbound, int _cost_upperbound)
 							{
 								p->second = path.second;
 								paths[p->first] = &p->second;
+								conflict_avoidance_table.updatePath(p->first, paths[p->first]);
+								resetWorkspaces(p->first);
 								break;
 							}
 							++p;
@@ -1309,6 +1380,7 @@ bool CBS::solve(double _time_limit, int _cost_lowerbound, int _cost_upperbound)
 						{
 							curr->paths.emplace_back(path);
 							paths[path.first] = &curr->paths.back().second;
+							conflict_avoidance_table.updatePath(path.first, paths[path.first]);
 						}
 					}
 					if (screen > 1)
@@ -1320,10 +1392,14 @@ bool CBS::solve(double _time_limit, int _cost_lowerbound, int _cost_upperbound)
 			}
 			if (foundBypass)
 			{
-				for (auto & i : child)
+				for (int i = 0; i < 2; i++)
 				{
-					delete i;
-					i = nullptr;
+					collectStats(workspaces[i]);
+					if (child[i] == nullptr)
+						continue;
+					syncWorkspace(workspaces[i]);
+					delete child[i];
+					child[i] = nullptr;
 				}
                 if (PC)
                     classifyConflicts(*curr); // classify the new-detected conflicts
@@ -1362,15 +1438,16 @@ bool CBS::solve(double _time_limit, int _cost_lowerbound, int _cost_upperbound)
 				default:
 					break;
 				}
-				if (curr->chosen_from == "cleanup")
+				if (curr->chosen_from == node_list::CLEANUP)
 					num_cleanup++;
-				else if (curr->chosen_from == "open")
+				else if (curr->chosen_from == node_list::OPEN)
 					num_open++;
-				else if (curr->chosen_from == "focal")
+				else if (curr->chosen_from == node_list::FOCAL)
 					num_focal++;
 				if (curr->conflict->priority == conflict_priority::CARDINAL)
 					num_cardinal_conflicts++;
 				curr->clear();
+				updateMemoryUsage(*curr);
 			}
 		}
 	}  // end of while loop
@@ -1387,7 +1464,7 @@ bool CBS::terminate(HLNode* curr)
             printResults();
 		return true;
 	}
-	runtime = (double)(clock() - start) / CLOCKS_PER_SEC;
+	runtime = getElapsedTime(start);
 	if (curr->conflicts.empty() && curr->unknownConf.empty()) //no conflicts
 	{// found a solution
 		solution_found = true;
@@ -1403,8 +1480,8 @@ bool CBS::terminate(HLNode* curr)
 			printResults();
 		return true;
 	}
-	if (runtime > time_limit || num_HL_expanded > node_limit)
-	{   // time/node out
+	if (runtime > time_limit || num_HL_expanded > node_limit || (interrupted != nullptr && *interrupted))
+	{   // time/node out or interrupted
 		solution_cost = -1;
 		solution_found = false;
         if (screen > 0) // 1 or 2
@@ -1419,7 +1496,7 @@ void CBS::addConstraints(const HLNode* curr, HLNode* child1, HLNode* child2) con
 {
 	if (disjoint_splitting && curr->conflict->type == conflict_type::STANDARD)
 	{
-		int first = (bool)(rand() % 2);
+		int first = (bool)(getTieBreakGenerator()() % 2);
 		if (first) // disjoint splitting on the first agent
 		{
 			child1->constraints = curr->conflict->constraint1;
@@ -1467,11 +1544,11 @@ CBS::CBS(vector<SingleAgentSolver*>& search_engines,
 	screen(screen), suboptimality(1), 
 	initial_constraints(initial_constraints), paths_found_initially(paths_found_initially),
 	search_engines(search_engines), 
-	mdd_helper(initial_constraints, search_engines),
+	mdd_helper(this->initial_constraints, this->search_engines),
 	rectangle_helper(search_engines[0]->instance),
-	mutex_helper(search_engines[0]->instance, initial_constraints),
-	corridor_helper(search_engines, initial_constraints),
-	heuristic_helper(search_engines.size(), paths, search_engines, initial_constraints, mdd_helper)
+	mutex_helper(search_engines[0]->instance, this->initial_constraints),
+	corridor_helper(this->search_engines, this->initial_constraints),
+	heuristic_helper(search_engines.size(), paths, this->search_engines, this->initial_constraints, mdd_helper)
 {
 	num_of_agents = (int) search_engines.size();
 	mutex_helper.search_engines = search_engines;
@@ -1482,11 +1559,11 @@ CBS::CBS(vector<SingleAgentSolver*>& search_engines, const PathTable& path_table
     initial_constraints(search_engines.size(), ConstraintTable(path_table,
             search_engines[0]->instance.num_of_cols, search_engines[0]->instance.map_size)),
     search_engines(search_engines),
-    mdd_helper(initial_constraints, search_engines),
+    mdd_helper(initial_constraints, this->search_engines),
     rectangle_helper(search_engines[0]->instance),
     mutex_helper(search_engines[0]->instance, initial_constraints),
-    corridor_helper(search_engines, initial_constraints),
-    heuristic_helper(search_engines.size(), paths, search_engines, initial_constraints, mdd_helper)
+    corridor_helper(this->search_engines, initial_constraints),
+    heuristic_helper(search_engines.size(), paths, this->search_engines, initial_constraints, mdd_helper)
 {
     num_of_agents = (int) search_engines.size();
     mutex_helper.search_engines = search_engines;
@@ -1554,11 +1631,14 @@ bool CBS::generateRoot()
 	auto root = new CBSNode();
 	root->g_val = 0;
 	paths.resize(num_of_agents, nullptr);
+	conflict_avoidance_table.init(search_engines[0]->instance.map_size, num_of_agents);
+	initWorkspaces();
 
 	mdd_helper.init(num_of_agents);
 	heuristic_helper.init();
 
 	// initialize paths_found_initially
+	bool planned = false; // whether the paths have been added to the root
 	if (paths_found_initially.empty())
 	{
 		paths_found_initially.resize(num_of_agents);
@@ -1577,28 +1657,53 @@ bool CBS::generateRoot()
 			std::shuffle(std::begin(agents), std::end(agents), g);
 		}
 
-		for (auto i : agents)
+		if (thread_pool != nullptr && parallel_root) // the paths are added to the root below
 		{
-			//CAT cat(dummy_start->makespan + 1);  // initialized to false
-			//updateReservationTable(cat, i, *dummy_start);
-			paths_found_initially[i] = search_engines[i]->findOptimalPath(*root, initial_constraints[i], paths, i, 0);
-			if (paths_found_initially[i].empty())
+			bool succ = planInParallel(agents, [&](int i, CBSNode& node, CTNodeWorkspace& workspace)
 			{
-				cout << "No path exists for agent " << i << endl;
+				paths_found_initially[i] = search_engines[i]->findOptimalPath(node, initial_constraints[i], workspace.conflict_avoidance_table, i, 0);
+				workspace.num_LL_expanded += search_engines[i]->num_expanded;
+				workspace.num_LL_generated += search_engines[i]->num_generated;
+				if (paths_found_initially[i].empty())
+				{
+					cout << "No path exists for agent " << i << endl;
+					return false;
+				}
+				workspace.conflict_avoidance_table.updatePath(i, &paths_found_initially[i]);
+				node.makespan = max(node.makespan, paths_found_initially[i].size() - 1);
+				return true;
+			});
+			if (!succ)
 				return false;
+		}
+		else
+		{
+			for (auto i : agents)
+			{
+				//CAT cat(dummy_start->makespan + 1);  // initialized to false
+				//updateReservationTable(cat, i, *dummy_start);
+				paths_found_initially[i] = search_engines[i]->findOptimalPath(*root, initial_constraints[i], conflict_avoidance_table, i, 0);
+				if (paths_found_initially[i].empty())
+				{
+					cout << "No path exists for agent " << i << endl;
+					return false;
+				}
+				paths[i] = &paths_found_initially[i];
+				conflict_avoidance_table.updatePath(i, paths[i]);
+				root->makespan = max(root->makespan, paths_found_initially[i].size() - 1);
+				root->g_val += (int)paths_found_initially[i].size() - 1;
+				num_LL_expanded += search_engines[i]->num_expanded;
+				num_LL_generated += search_engines[i]->num_generated;
 			}
-			paths[i] = &paths_found_initially[i];
-			root->makespan = max(root->makespan, paths_found_initially[i].size() - 1);
-			root->g_val += (int)paths_found_initially[i].size() - 1;
-			num_LL_expanded += search_engines[i]->num_expanded;
-			num_LL_generated += search_engines[i]->num_generated;
+			planned = true;
 		}
 	}
-	else
+	if (!planned) // paths_found_initially are given or planned in parallel
 	{
 		for (int i = 0; i < num_of_agents; i++)
 		{
 			paths[i] = &paths_found_initially[i];
+			conflict_avoidance_table.updatePath(i, paths[i]);
 			root->makespan = max(root->makespan, paths_found_initially[i].size() - 1);
 			root->g_val += (int) paths_found_initially[i].size() - 1;
 		}
@@ -1626,6 +1731,97 @@ inline void CBS::releaseNodes()
 	for (auto& node : allNodes_table)
 		delete node;
 	allNodes_table.clear();
+	ct_memory = 0;
+}
+
+void CBS::updateMemoryUsage(HLNode& node)
+{
+	auto memory = (uint32_t)node.getMemoryUsage();
+	ct_memory = ct_memory + memory - node.memory_usage;
+	node.memory_usage = memory;
+	peak_ct_memory = max(peak_ct_memory, ct_memory);
+}
+
+void CBS::setNumOfThreads(int n)
+{
+	num_of_threads = max(n, 1);
+	if (num_of_threads > 1)
+		thread_pool.reset(new ThreadPool(num_of_threads - 1));
+	else
+		thread_pool.reset();
+	heuristic_helper.setThreadPool(thread_pool.get());
+}
+
+void CBS::initWorkspaces()
+{
+	workspaces.resize(max(num_of_threads, 2));
+	for (auto& workspace : workspaces)
+	{
+		workspace.paths.assign(num_of_agents, nullptr);
+		workspace.conflict_avoidance_table.init(search_engines[0]->instance.map_size, num_of_agents);
+	}
+}
+
+// Copy the current paths to the workspace. Its CAT is only updated for the paths that differ from the ones
+// it was last synced with, which are few when the node is a descendant of the previous node generated on the workspace.
+// The CAT identifies the paths by their pointers, so the workspace of a deleted child is synced again right away,
+// as the memory of its paths can be reused by the paths of a later node.
+void CBS::syncWorkspace(CTNodeWorkspace& workspace) const
+{
+	workspace.paths = paths;
+	workspace.conflict_avoidance_table.updatePaths(workspace.paths);
+}
+
+// The path of the agent has been changed in place, so the CATs of the workspaces cannot tell it by its pointer
+void CBS::resetWorkspaces(int agent)
+{
+	for (auto& workspace : workspaces)
+		workspace.conflict_avoidance_table.updatePath(agent, nullptr);
+}
+
+void CBS::collectStats(CTNodeWorkspace& workspace)
+{
+	num_LL_expanded += workspace.num_LL_expanded;
+	num_LL_generated += workspace.num_LL_generated;
+	runtime_generate_child += workspace.runtime_generate_child;
+	runtime_build_CT += workspace.runtime_build_CT;
+	runtime_build_CAT += workspace.runtime_build_CAT;
+	runtime_path_finding += workspace.runtime_path_finding;
+	runtime_detect_conflicts += workspace.runtime_detect_conflicts;
+	workspace.num_LL_expanded = 0;
+	workspace.num_LL_generated = 0;
+	workspace.runtime_generate_child = 0;
+	workspace.runtime_build_CT = 0;
+	workspace.runtime_build_CAT = 0;
+	workspace.runtime_path_finding = 0;
+	workspace.runtime_detect_conflicts = 0;
+}
+
+// Plan the paths of the agents at the root on all threads. The agents are dealt out to the threads in turn,
+// and each thread plans its agents one by one with its own CAT and root node (whose makespan is read by
+// the low-level search), so a path avoids the paths planned before it on the same thread.
+// Returns false as soon as plan fails for any agent.
+bool CBS::planInParallel(const vector<int>& agents, const std::function<bool(int, CBSNode&, CTNodeWorkspace&)>& plan)
+{
+	std::atomic<bool> succ(true);
+	auto task = [&](int k)
+	{
+		CBSNode root = CBSNode();
+		for (size_t j = k; j < agents.size() && succ; j += num_of_threads)
+		{
+			if (!plan(agents[j], root, workspaces[k]))
+				succ = false;
+		}
+	};
+	vector< std::future<void> > futures;
+	for (int k = 1; k < num_of_threads; k++)
+		futures.push_back(thread_pool->submit(std::bind(task, k)));
+	task(0);
+	for (auto& future : futures)
+		future.get();
+	for (auto& workspace : workspaces)
+		collectStats(workspace);
+	return succ;
 }
 
 
@@ -1726,6 +1922,7 @@ void CBS::clear()
 {
 	mdd_helper.clear();
 	heuristic_helper.clear();
+	rectangle_helper.clear();
 	releaseNodes();
 	paths.clear();
 	paths_found_initially.clear();
@@ -1734,3 +1931,60 @@ void CBS::clear()
 	solution_found = false;
 	solution_cost = -2;
 }
+
+void CBS::resetAgents(vector<SingleAgentSolver*>& new_search_engines)
+{
+	const auto& path_table = initial_constraints.front().path_table;
+	const auto& instance = new_search_engines[0]->instance;
+	search_engines = new_search_engines;
+	num_of_agents = (int) search_engines.size();
+	mutex_helper.search_engines = search_engines;
+	mutex_helper.clear();
+	rectangle_helper.clear();
+	heuristic_helper.reset(num_of_agents);
+	while ((int)initial_constraints.size() > num_of_agents)
+		initial_constraints.pop_back();
+	for (int i = 0; i < num_of_agents; i++)
+	{
+		ConstraintTable constraint_table(path_table, instance.num_of_cols, instance.map_size, search_engines[i]->goal_location);
+		if (i < (int)initial_constraints.size())
+			initial_constraints[i].init(constraint_table);
+		else
+			initial_constraints.push_back(constraint_table);
+	}
+
+	runtime = 0;
+	runtime_generate_child = 0;
+	runtime_build_CT = 0;
+	runtime_build_CAT = 0;
+	runtime_path_finding = 0;
+	runtime_detect_conflicts = 0;
+	num_cardinal_conflicts = 0;
+	num_corridor_conflicts = 0;
+	num_rectangle_conflicts = 0;
+	num_target_conflicts = 0;
+	num_mutex_conflicts = 0;
+	num_standard_conflicts = 0;
+	num_adopt_bypass = 0;
+	num_HL_expanded = 0;
+	num_HL_generated = 0;
+	num_LL_expanded = 0;
+	num_LL_generated = 0;
+	peak_ct_memory = 0;
+	num_evicted_nodes = 0;
+	num_regenerated_nodes = 0;
+	num_cleanup = 0;
+	num_open = 0;
+	num_focal = 0;
+	mdd_helper.accumulated_runtime = 0;
+	mdd_helper.num_derived_mdds = 0;
+	mdd_helper.num_hits = 0;
+	mdd_helper.num_misses = 0;
+	mdd_helper.num_evicted_mdds = 0;
+	rectangle_helper.accumulated_runtime = 0;
+	rectangle_helper.num_hits = 0;
+	rectangle_helper.num_misses = 0;
+	rectangle_helper.saved_runtime = 0;
+	corridor_helper.accumulated_runtime = 0;
+	mutex_helper.accumulated_runtime = 0;
+}
@@ -1,7 +1,9 @@
 //#pragma warning(disable: 4996) //Jiaoyang: I added this line to disable error C4996 caused by CPLEX
 #include "CBSHeuristic.h"
 #include "CBS.h"
+#include "TwoAgentSolver.h"
 #include <queue>
+#include <atomic>
 //#include <ilcplex/ilocplex.h>
 
 
@@ -229,7 +231,8 @@ bool CBSHeuristic::computeInformedHeuristics(CBSNode& curr, double _time_limit)
 {
     curr.h_computed = true;
 	// create conflict graph
-	start_time = clock();
+	start_time = steady_clock::now();
+	start_clock = clock();
 	this->time_limit = _time_limit;
 	int num_of_CGedges;
 	vector<int> HG(num_of_agents * num_of_agents, 0); // heuristic graph
@@ -290,7 +293,8 @@ bool CBSHeuristic::computeInformedHeuristics(ECBSNode& curr, const vector<int>&
 {
     curr.h_computed = true;
 	// create conflict graph
-	start_time = clock();
+	start_time = steady_clock::now();
+	start_clock = clock();
 	this->time_limit = _time_limit;
 	int num_of_CGedges;
 	vector<int> HG(num_of_agents * num_of_agents, 0); // heuristic graph
@@ -419,7 +423,7 @@ bool CBSHeuristic::computeInformedHeuristics(ECBSNode& curr, const vector<int>&
 			rst += DPForConstrainedWMVC(x, 0, 0, G, range, best_so_far);
 		}
 		
-		double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+		double runtime = getElapsedTime(start_time);
 		if (runtime > time_limit)
 			return -1; // run out of time
 	}
@@ -478,7 +482,7 @@ void CBSHeuristic::buildCardinalConflictGraph(CBSNode& curr, vector<int>& CG, in
 			}
 		}
 	}
-	runtime_build_dependency_graph += (double)(clock() - start_time) / CLOCKS_PER_SEC;
+	runtime_build_dependency_graph += (double)(clock() - start_clock) / CLOCKS_PER_SEC;
 }
 
 
@@ -511,9 +515,9 @@ bool CBSHeuristic::buildDependenceGraph(CBSNode& node, vector<int>& CG, int& num
             CG[idx] = dependent(a1, a2, node)? 1 : 0;
             CG[a2 * num_of_agents + a1] = CG[idx];
             lookupTable[a1][a2][HTableEntry(a1, a2, &node)] = make_tuple(CG[idx], 1, 0);
-            if ((clock() - start_time) / CLOCKS_PER_SEC > time_limit) // run out of time
+            if (getElapsedTime(start_time) > time_limit) // run out of time
             {
-                runtime_build_dependency_graph += (double)(clock() - start_time) / CLOCKS_PER_SEC;
+                runtime_build_dependency_graph += (double)(clock() - start_clock) / CLOCKS_PER_SEC;
                 return false;
             }
         }
@@ -523,60 +527,78 @@ bool CBSHeuristic::buildDependenceGraph(CBSNode& node, vector<int>& CG, int& num
 			conflict->priority = conflict_priority::PSEUDO_CARDINAL; // the two agents are dependent, although resolving this conflict might not increase the cost
 		}
 	}
-	runtime_build_dependency_graph += (double)(clock() - start_time) / CLOCKS_PER_SEC;
+	runtime_build_dependency_graph += (double)(clock() - start_clock) / CLOCKS_PER_SEC;
 	return true;
 }
 
 
 bool CBSHeuristic::buildWeightedDependencyGraph(CBSNode& node, vector<int>& CG)
 {
+	// collect the 2-agent sub-problems that are not in the lookup table
+	vector<pair<int, int> > agent_pairs;
+	vector<bool> cardinals;
 	for (const auto& conflict : node.conflicts)
 	{
 		int a1 = min(conflict->a1, conflict->a2);
 		int a2 = max(conflict->a1, conflict->a2);
-		int idx = a1 * num_of_agents + a2;
 		auto got = lookupTable[a1][a2].find(HTableEntry(a1, a2, &node));
 		if (got != lookupTable[a1][a2].end()) // check the lookup table first
 		{
 			num_memoization++;
-            CG[idx] = get<0>(got->second);
-            CG[a2 * num_of_agents + a1] = CG[idx];
+			continue;
 		}
-		else if (rectangle_reasoning)
+		if (find(agent_pairs.begin(), agent_pairs.end(), make_pair(a1, a2)) != agent_pairs.end())
+			continue; // another conflict between the same agents
+		int h, length1, length2;
+		if (heuristic_cache != nullptr && findInCache(a1, a2, node, h, length1, length2)) // solved in a previous CBS run
 		{
-			auto rst = solve2Agents(a1, a2, node, false);
-			assert(rst.first >= 0);
-			lookupTable[a1][a2][HTableEntry(a1, a2, &node)] = make_tuple(rst.first, rst.second, 1);
-			CG[idx] = rst.first;
-			CG[a2 * num_of_agents + a1] = rst.first;
+			lookupTable[a1][a2][HTableEntry(a1, a2, &node)] = make_tuple(h, 0, 1); // #CT nodes = 0
+			continue;
 		}
-		else
+		bool cardinal = conflict->priority == conflict_priority::CARDINAL;
+		if (!rectangle_reasoning && !cardinal && !mutex_reasoning) // using merging MDD methods before runing 2-agent instance
 		{
-			bool cardinal = conflict->priority == conflict_priority::CARDINAL;
-			if (!cardinal && !mutex_reasoning) // using merging MDD methods before runing 2-agent instance
-			{
-				cardinal = dependent(a1, a2, node);
-			}
-			if (cardinal) // run 2-agent solver only for dependent agents
-			{
-				auto rst = solve2Agents(a1, a2, node, cardinal);
-				assert(rst.first >= 1);
-				lookupTable[a1][a2][HTableEntry(a1, a2, &node)] = make_tuple(rst.first, rst.second, 1);
-				CG[idx] = rst.first;
-				CG[a2 * num_of_agents + a1] = rst.first;
-			}
-			else
-			{
-				lookupTable[a1][a2][HTableEntry(a1, a2, &node)]  = make_tuple(0, 1, 0); // h=0, #CT nodes = 1
-				CG[idx] = 0;
-				CG[a2 * num_of_agents + a1] = 0;
-			}
+			cardinal = dependent(a1, a2, node);
 		}
-		if ((clock() - start_time) / CLOCKS_PER_SEC > time_limit) // run out of time
+		if (rectangle_reasoning || cardinal) // run 2-agent solver only for dependent agents
 		{
-			runtime_build_dependency_graph += (double)(clock() - start_time) / CLOCKS_PER_SEC;
-			return false;
+			agent_pairs.emplace_back(a1, a2);
+			cardinals.push_back(cardinal);
+		}
+		else
+		{
+			lookupTable[a1][a2][HTableEntry(a1, a2, &node)]  = make_tuple(0, 1, 0); // h=0, #CT nodes = 1
+			if (heuristic_cache != nullptr)
+				insertIntoCache(a1, a2, node, 0, (int)paths[a1]->size() - 1, (int)paths[a2]->size() - 1);
 		}
+	}
+
+	vector<pair<int, int> > rst(agent_pairs.size());
+	bool succ = solveSubProblems(agent_pairs, node, [&](int i)
+	{
+		rst[i] = solve2Agents(agent_pairs[i].first, agent_pairs[i].second, node, cardinals[i]);
+	});
+	if (!succ) // run out of time
+	{
+		runtime_build_dependency_graph += (double)(clock() - start_clock) / CLOCKS_PER_SEC;
+		return false;
+	}
+	for (size_t i = 0; i < agent_pairs.size(); i++)
+	{
+		assert(rst[i].first >= (cardinals[i]? 1 : 0));
+		int a1 = agent_pairs[i].first, a2 = agent_pairs[i].second;
+		lookupTable[a1][a2][HTableEntry(a1, a2, &node)] = make_tuple(rst[i].first, rst[i].second, 1);
+		if (heuristic_cache != nullptr)
+			insertIntoCache(a1, a2, node, rst[i].first, (int)paths[a1]->size() - 1, (int)paths[a2]->size() - 1);
+	}
+
+	for (const auto& conflict : node.conflicts)
+	{
+		int a1 = min(conflict->a1, conflict->a2);
+		int a2 = max(conflict->a1, conflict->a2);
+		int idx = a1 * num_of_agents + a2;
+		CG[idx] = get<0>(lookupTable[a1][a2][HTableEntry(a1, a2, &node)]);
+		CG[a2 * num_of_agents + a1] = CG[idx];
 		if (CG[idx] == MAX_COST) // no solution
 		{
             return false;
@@ -587,217 +609,310 @@ bool CBSHeuristic::buildWeightedDependencyGraph(CBSNode& node, vector<int>& CG)
 		}
 	}
 
-	runtime_build_dependency_graph += (double)(clock() - start_time) / CLOCKS_PER_SEC;
+	runtime_build_dependency_graph += (double)(clock() - start_clock) / CLOCKS_PER_SEC;
 	return true;
 }
 
 
 bool CBSHeuristic::buildWeightedDependencyGraph(ECBSNode& node, const vector<int>& min_f_vals, vector<int>& CG, int& delta_g)
 {
-    delta_g = 0;
-    vector<bool> counted(num_of_agents, false); // record the agents whose delta_g has been counted
-	for (const auto& conflict : node.conflicts)
+	// collect the 2-agent sub-problems that are not in the lookup table.
+	// The shortest path lengths are read from the (minimal) MDDs, which are usually built when classifying the conflicts.
+	vector<pair<int, int> > agent_pairs;
+	vector<int> lengths(num_of_agents, -1);
+	for (const auto& conflicts : {&node.conflicts, &node.unknownConf})
 	{
-		int a1 = min(conflict->a1, conflict->a2);
-		int a2 = max(conflict->a1, conflict->a2);
-		int idx = a1 * num_of_agents + a2;
-		auto got = lookupTable[a1][a2].find(HTableEntry(a1, a2, &node));
-		if (got != lookupTable[a1][a2].end()) // check the lookup table first
+		for (const auto& conflict : *conflicts)
 		{
-			num_memoization++;
-            CG[idx]  = get<0>(got->second);
-            CG[a2 * num_of_agents + a1] = CG[idx];
-            if (!counted[a1])
-            {
-                assert(get<1>(got->second) >= min_f_vals[a1]);
-                delta_g += get<1>(got->second) - min_f_vals[a1];
-                counted[a1] = true;
-            }
-            if (!counted[a2])
-            {
-                assert(get<2>(got->second) >= min_f_vals[a2]);
-                delta_g += get<2>(got->second) - min_f_vals[a2];
-                counted[a2] = true;
-            }
+			int a1 = min(conflict->a1, conflict->a2);
+			int a2 = max(conflict->a1, conflict->a2);
+			if (lookupTable[a1][a2].find(HTableEntry(a1, a2, &node)) != lookupTable[a1][a2].end()) // check the lookup table first
+			{
+				num_memoization++;
+				continue;
+			}
+			if (find(agent_pairs.begin(), agent_pairs.end(), make_pair(a1, a2)) != agent_pairs.end())
+				continue; // another conflict between the same agents
+			int h, length1, length2;
+			if (heuristic_cache != nullptr && findInCache(a1, a2, node, h, length1, length2)) // solved in a previous ECBS run
+			{
+				lookupTable[a1][a2][HTableEntry(a1, a2, &node)] = make_tuple(h, length1, length2);
+				continue;
+			}
+			for (int a : {a1, a2})
+			{
+				if (lengths[a] < 0)
+					lengths[a] = (int)mdd_helper.getMDD(node, a, paths[a]->size())->levels.size() - 1;
+			}
+			if (dependent(a1, a2, node)) // run 2-agent solver only for dependent agents
+				agent_pairs.emplace_back(a1, a2);
+			else
+			{
+				lookupTable[a1][a2][HTableEntry(a1, a2, &node)] = make_tuple(0, lengths[a1], lengths[a2]);
+				if (heuristic_cache != nullptr)
+					insertIntoCache(a1, a2, node, 0, lengths[a1], lengths[a2]);
+			}
 		}
-		else
+	}
+
+	vector<tuple<int, int, int> > rst(agent_pairs.size());
+	bool succ = solveSubProblems(agent_pairs, node, [&](int i)
+	{
+		int a1 = agent_pairs[i].first, a2 = agent_pairs[i].second;
+		rst[i] = solve2Agents(a1, a2, node, lengths[a1], lengths[a2]);
+	});
+	if (!succ) // run out of time
+	{
+		runtime_build_dependency_graph += (double)(clock() - start_clock) / CLOCKS_PER_SEC;
+		return false;
+	}
+	for (size_t i = 0; i < agent_pairs.size(); i++)
+	{
+		int a1 = agent_pairs[i].first, a2 = agent_pairs[i].second;
+		lookupTable[a1][a2][HTableEntry(a1, a2, &node)] = rst[i];
+		if (heuristic_cache != nullptr)
+			insertIntoCache(a1, a2, node, get<0>(rst[i]), get<1>(rst[i]), get<2>(rst[i]));
+	}
+
+	delta_g = 0;
+	vector<bool> counted(num_of_agents, false); // record the agents whose delta_g has been counted
+	for (const auto& conflicts : {&node.conflicts, &node.unknownConf})
+	{
+		for (const auto& conflict : *conflicts)
 		{
-			auto rst = solve2Agents(a1, a2, node);
-            lookupTable[a1][a2][HTableEntry(a1, a2, &node)] = rst;
-            if ((clock() - start_time) / CLOCKS_PER_SEC > time_limit) // run out of time
-            {
-                runtime_build_dependency_graph += (double)(clock() - start_time) / CLOCKS_PER_SEC;
-                return false;
-            }
-            CG[idx]  = get<0>(rst);
-            CG[a2 * num_of_agents + a1] = CG[idx];
-            if (!counted[a1])
-            {
-                assert(get<1>(rst) >= min_f_vals[a1]);
-                delta_g += get<1>(rst) - min_f_vals[a1];
-                counted[a1] = true;
-            }
-            if (!counted[a2])
-            {
-                assert(get<2>(rst) >= min_f_vals[a2]);
-                delta_g += get<2>(rst) - min_f_vals[a2];
-                counted[a2] = true;
-            }
+			int a1 = min(conflict->a1, conflict->a2);
+			int a2 = max(conflict->a1, conflict->a2);
+			int idx = a1 * num_of_agents + a2;
+			const auto& entry = lookupTable[a1][a2][HTableEntry(a1, a2, &node)];
+			CG[idx] = get<0>(entry);
+			CG[a2 * num_of_agents + a1] = CG[idx];
+			if (!counted[a1])
+			{
+				assert(get<1>(entry) >= min_f_vals[a1]);
+				delta_g += get<1>(entry) - min_f_vals[a1];
+				counted[a1] = true;
+			}
+			if (!counted[a2])
+			{
+				assert(get<2>(entry) >= min_f_vals[a2]);
+				delta_g += get<2>(entry) - min_f_vals[a2];
+				counted[a2] = true;
+			}
+			if (CG[idx] == MAX_COST) // no solution
+				return false;
 		}
+	}
+	runtime_build_dependency_graph += (double)(clock() - start_clock) / CLOCKS_PER_SEC;
+	return true;
+}
 
-        if (CG[idx] == MAX_COST) // no solution
-            return false;
+void CBSHeuristic::reset(int n)
+{
+	num_of_agents = n;
+	clear();
+	runtime_build_dependency_graph = 0;
+	runtime_solve_MVC = 0;
+	num_solve_MVC = 0;
+	num_merge_MDDs = 0;
+	num_solve_2agent_problems = 0;
+	num_memoization = 0;
+	sub_instances.clear();
+	setInadmissibleHeuristics(inadmissible_heuristic); // forget the errors learned online
+}
+
+bool CBSHeuristic::findInCache(int a1, int a2, const HLNode& node, int& h, int& length1, int& length2)
+{
+	if (agent_ids[a1] < agent_ids[a2])
+		return heuristic_cache->findPair(getCacheKey(a1, a2, node), *search_engines[a1], *search_engines[a2],
+			h, length1, length2);
+	else
+		return heuristic_cache->findPair(getCacheKey(a2, a1, node), *search_engines[a2], *search_engines[a1],
+			h, length2, length1);
+}
+
+void CBSHeuristic::insertIntoCache(int a1, int a2, const HLNode& node, int h, int length1, int length2)
+{
+	if (agent_ids[a1] < agent_ids[a2])
+		heuristic_cache->insertPair(getCacheKey(a1, a2, node), *search_engines[a1], *search_engines[a2],
+			h, length1, length2);
+	else
+		heuristic_cache->insertPair(getCacheKey(a2, a1, node), *search_engines[a2], *search_engines[a1],
+			h, length2, length1);
+}
+
+// collect the constraints on the two agents in the same way as HTableEntry, but with the ids of the agents in the instance
+HeuristicCache::PairKey CBSHeuristic::getCacheKey(int a1, int a2, const HLNode& node) const
+{
+	HeuristicCache::PairKey key;
+	key.a1 = agent_ids[a1];
+	key.a2 = agent_ids[a2];
+	std::set<Constraint> cons[2];
+	for (const HLNode* curr = &node; curr->parent != nullptr; curr = curr->parent)
+	{
+		auto type = get<4>(curr->constraints.front());
+		bool all = type == constraint_type::LEQLENGTH || type == constraint_type::POSITIVE_VERTEX ||
+			type == constraint_type::POSITIVE_EDGE; // constraints that affect the other agents as well
+		for (int i = 0; i < 2; i++)
+		{
+			if (!all && get<0>(curr->constraints.front()) != (i == 0? a1 : a2))
+				continue;
+			for (auto con : curr->constraints)
+			{
+				get<0>(con) = agent_ids[get<0>(con)];
+				cons[i].insert(con);
+			}
+		}
 	}
-    for (const auto& conflict : node.unknownConf)
-    {
-        int a1 = min(conflict->a1, conflict->a2);
-        int a2 = max(conflict->a1, conflict->a2);
-        int idx = a1 * num_of_agents + a2;
-        auto got = lookupTable[a1][a2].find(HTableEntry(a1, a2, &node));
-        if (got != lookupTable[a1][a2].end()) // check the lookup table first
-        {
-            num_memoization++;
-            CG[idx]  = get<0>(got->second);
-            CG[a2 * num_of_agents + a1] = CG[idx];
-            if (!counted[a1])
-            {
-                assert(get<1>(got->second) >= min_f_vals[a1]);
-                delta_g += get<1>(got->second) - min_f_vals[a1];
-                counted[a1] = true;
-            }
-            if (!counted[a2])
-            {
-                assert(get<2>(got->second) >= min_f_vals[a2]);
-                delta_g += get<2>(got->second) - min_f_vals[a2];
-                counted[a2] = true;
-            }
-        }
-        else
-        {
-            auto rst = solve2Agents(a1, a2, node);
-            lookupTable[a1][a2][HTableEntry(a1, a2, &node)] = rst;
-            if ((clock() - start_time) / CLOCKS_PER_SEC > time_limit) // run out of time
-            {
-                runtime_build_dependency_graph += (double)(clock() - start_time) / CLOCKS_PER_SEC;
-                return false;
-            }
-            CG[idx]  = get<0>(rst);
-            CG[a2 * num_of_agents + a1] = CG[idx];
-            if (!counted[a1])
-            {
-                assert(get<1>(rst) >= min_f_vals[a1]);
-                delta_g += get<1>(rst) - min_f_vals[a1];
-                counted[a1] = true;
-            }
-            if (!counted[a2])
-            {
-                assert(get<2>(rst) >= min_f_vals[a2]);
-                delta_g += get<2>(rst) - min_f_vals[a2];
-                counted[a2] = true;
-            }
-        }
+	for (int i = 0; i < 2; i++)
+		key.constraints[i].assign(cons[i].begin(), cons[i].end());
+	return key;
+}
 
-        if (CG[idx] == MAX_COST) // no solution
-            return false;
-    }
-	runtime_build_dependency_graph += (double)(clock() - start_time) / CLOCKS_PER_SEC;
+// The low-level solvers are not thread-safe, so the sub-problems are solved in rounds,
+// and the sub-problems in the same round share no agents.
+bool CBSHeuristic::solveSubProblems(const vector<pair<int, int> >& agent_pairs, const HLNode& node,
+		const std::function<void(int)>& solve)
+{
+	if (thread_pool == nullptr)
+	{
+		for (int i = 0; i < (int)agent_pairs.size(); i++)
+		{
+			solve(i);
+			if (getElapsedTime(start_time) > time_limit) // run out of time
+				return false;
+		}
+		return true;
+	}
+
+	vector<bool> solved(agent_pairs.size(), false);
+	vector<bool> busy(num_of_agents, false);
+	size_t num_solved = 0;
+	while (num_solved < agent_pairs.size())
+	{
+		vector<int> round;
+		for (int i = 0; i < (int)agent_pairs.size(); i++)
+		{
+			if (solved[i] || busy[agent_pairs[i].first] || busy[agent_pairs[i].second])
+				continue;
+			busy[agent_pairs[i].first] = true;
+			busy[agent_pairs[i].second] = true;
+			round.push_back(i);
+		}
+		std::atomic<int> next(0);
+		auto task = [&]()
+		{
+			for (int j = next++; j < (int)round.size(); j = next++)
+				solve(round[j]);
+		};
+		vector< std::future<void> > futures;
+		for (int k = 1; k <= thread_pool->getNumOfThreads() && k < (int)round.size(); k++)
+			futures.push_back(thread_pool->submit(task));
+		task();
+		for (auto& future : futures)
+			future.get();
+		for (int i : round)
+		{
+			solved[i] = true;
+			busy[agent_pairs[i].first] = false;
+			busy[agent_pairs[i].second] = false;
+		}
+		num_solved += round.size();
+		if (getElapsedTime(start_time) > time_limit) // run out of time
+			return false;
+	}
 	return true;
 }
 
-// return optimal f - root g and #HL nodes
+// return optimal f - root g and #expanded nodes
 pair<int, int> CBSHeuristic::solve2Agents(int a1, int a2, const CBSNode& node, bool cardinal)
 {
-	vector<SingleAgentSolver*> engines{search_engines[a1],   search_engines[a2]};
-	vector<vector<PathEntry>> initial_paths{*paths[a1], *paths[a2]};
 	vector<ConstraintTable> constraints{ConstraintTable(initial_constraints[a1]), ConstraintTable(initial_constraints[a2]) };
 	constraints[0].build(node, a1);
 	constraints[1].build(node, a2);
-	CBS cbs(engines, constraints, initial_paths, screen);
-	// setUpSubSolver(cbs);
-	cbs.setPrioritizeConflicts(PC);
-	cbs.setHeuristicType(heuristics_type::CG, heuristics_type::ZERO);
-	cbs.setDisjointSplitting(disjoint_splitting);
-	cbs.setBypass(false); // I guess that bypassing does not help two-agent path finding???
-	cbs.setRectangleReasoning(rectangle_reasoning);
-	cbs.setCorridorReasoning(corridor_reasoning);
-	cbs.setTargetReasoning(target_reasoning);
-	cbs.setMutexReasoning(mutex_reasoning);
-	cbs.setConflictSelectionRule(conflict_seletion_rule);
-	cbs.setNodeSelectionRule(node_selection_rule);
-	cbs.setHighLevelSolver(high_level_solver_type::ASTAR, 1); // solve the sub problem optimally
-	cbs.setNodeLimit(node_limit);
-
-	double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
-	int root_g = (int)initial_paths[0].size() - 1 + (int)initial_paths[1].size() - 1;
+	// the paths at a CBS node are the shortest paths that satisfy the constraints
+	int length1 = (int)paths[a1]->size() - 1, length2 = (int)paths[a2]->size() - 1;
+	int root_g = length1 + length2;
 	int lowerbound = root_g;
-	int upperbound = MAX_COST;
 	if (cardinal)
 		lowerbound += 1;
-	cbs.solve(time_limit - runtime, lowerbound, upperbound);
-	num_solve_2agent_problems++;
+	TwoAgentSolver solver(search_engines[a1], search_engines[a2], constraints[0], constraints[1]);
+	int cost = solver.solve(length1, length2, lowerbound, joint_node_limit * (length1 + length2));
+	auto num_expanded = solver.num_expanded;
+	if (!solver.optimal) // resort to CBS, which resolves symmetric conflicts with few CT nodes
+	{
+		vector<SingleAgentSolver*> engines{search_engines[a1],   search_engines[a2]};
+		vector<vector<PathEntry>> initial_paths{*paths[a1], *paths[a2]};
+		CBS cbs(engines, constraints, initial_paths, screen);
+		setUpSubSolver(cbs);
+		double runtime = getElapsedTime(start_time);
+		cbs.solve(time_limit - runtime, cost, MAX_COST);
+		if (cbs.runtime >= time_limit - runtime || cbs.num_HL_expanded > node_limit) // time out or node out
+			cost = max(cost, cbs.getLowerBound()); // using lowerbound to approximate
+		else if (cbs.solution_cost  < 0) // no solution
+			cost = MAX_COST;
+		else
+			cost = cbs.solution_cost;
+		num_expanded += cbs.num_HL_expanded;
+	}
 
 	pair<int, int> rst;
-	if (cbs.runtime >= time_limit - runtime || cbs.num_HL_expanded > node_limit) // time out or node out
-		rst.first = cbs.getLowerBound() - root_g; // using lowerbound to approximate
-	else if (cbs.solution_cost  < 0) // no solution
+	if (cost == MAX_COST) // no solution
 		rst.first = MAX_COST;
 	else
 	{
-		assert(cbs.solution_cost >= root_g);
-		rst.first = cbs.solution_cost - root_g;
+		assert(cost >= root_g);
+		rst.first = cost - root_g;
 	}
-	rst.second = (int)cbs.num_HL_expanded;
+	rst.second = (int)num_expanded;
+	std::lock_guard<std::mutex> lock(stats_mutex);
+	num_solve_2agent_problems++;
 	// For statistic study!!!
 	if (save_stats)
 	{
-		sub_instances.emplace_back(a1, a2, &node, cbs.num_HL_expanded, rst.second);
+		sub_instances.emplace_back(a1, a2, &node, num_expanded, rst.second);
 	}
 	return rst;
 }
 
-// return optimal f and a1_shortestpath * #agents + a2_shortestpath
-tuple<int, int, int> CBSHeuristic::solve2Agents(int a1, int a2, const ECBSNode& node)
+// return optimal f - the shortest path lengths, and the shortest path lengths of the two agents
+tuple<int, int, int> CBSHeuristic::solve2Agents(int a1, int a2, const ECBSNode& node, int length1, int length2)
 {
-	vector<SingleAgentSolver*> engines{ search_engines[a1],   search_engines[a2] };
-	vector<vector<PathEntry>> initial_paths;
-	vector<ConstraintTable> constraints{ ConstraintTable(initial_constraints[a1]), ConstraintTable(initial_constraints[a2]) };
+	vector<ConstraintTable> constraints{ConstraintTable(initial_constraints[a1]), ConstraintTable(initial_constraints[a2]) };
 	constraints[0].build(node, a1);
 	constraints[1].build(node, a2);
-	CBS cbs(engines, constraints, initial_paths, screen);
-	// setUpSubSolver(cbs);
-	cbs.setPrioritizeConflicts(PC);
-	cbs.setHeuristicType(heuristics_type::CG, heuristics_type::ZERO);
-	cbs.setDisjointSplitting(disjoint_splitting);
-	cbs.setBypass(false); // I guess that bypassing does not help two-agent path finding???
-	cbs.setRectangleReasoning(rectangle_reasoning);
-	cbs.setCorridorReasoning(corridor_reasoning);
-	cbs.setTargetReasoning(target_reasoning);
-	cbs.setMutexReasoning(mutex_reasoning);
-	cbs.setConflictSelectionRule(conflict_seletion_rule);
-	cbs.setNodeSelectionRule(node_selection_rule);
-	cbs.setHighLevelSolver(high_level_solver_type::ASTAR, 1); // solve the sub problem optimally
-	cbs.setNodeLimit(node_limit);
-
-	double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
-	cbs.solve(time_limit - runtime, 0, MAX_COST);
-	num_solve_2agent_problems++;
-	
-	// For statistic study!!!
-	if (save_stats)
+	TwoAgentSolver solver(search_engines[a1], search_engines[a2], constraints[0], constraints[1]);
+	int cost = solver.solve(length1, length2, length1 + length2 + 1, joint_node_limit * (length1 + length2)); // the two agents are dependent
+	auto num_expanded = solver.num_expanded;
+	if (!solver.optimal) // resort to CBS, which resolves symmetric conflicts with few CT nodes
 	{
-		sub_instances.emplace_back(a1, a2, &node, cbs.num_HL_expanded, (int)cbs.num_HL_expanded);
+		vector<SingleAgentSolver*> engines{search_engines[a1],   search_engines[a2]};
+		vector<vector<PathEntry>> initial_paths;
+		CBS cbs(engines, constraints, initial_paths, screen);
+		setUpSubSolver(cbs);
+		double runtime = getElapsedTime(start_time);
+		cbs.solve(time_limit - runtime, cost, MAX_COST);
+		if (cbs.runtime >= time_limit - runtime) // time out
+			cost = length1 + length2; // h = 0
+		else if (cbs.num_HL_expanded > node_limit) // node out
+			cost = max(cost, cbs.getLowerBound()); // using lowerbound to approximate
+		else if (cbs.solution_cost  < 0) // no solution
+			cost = MAX_COST;
+		else
+			cost = cbs.solution_cost;
+		num_expanded += cbs.num_HL_expanded;
 	}
-
-	if (cbs.runtime >= time_limit - runtime) // time out
-		return make_tuple(0, 0, 0); // using lowerbound to approximate
-    	else if (cbs.num_HL_expanded > node_limit) // node out
-		return make_tuple(cbs.getLowerBound() - cbs.dummy_start->g_val,
-		        cbs.getInitialPathLength(0), cbs.getInitialPathLength(1)); // using lowerbound to approximate
-	else if (cbs.solution_cost  < 0) // no solution
-		return make_tuple(MAX_COST, cbs.getInitialPathLength(0), cbs.getInitialPathLength(1));
-	else
-		return make_tuple(cbs.solution_cost - cbs.dummy_start->g_val,
-		        cbs.getInitialPathLength(0), cbs.getInitialPathLength(1));
+	{
+		std::lock_guard<std::mutex> lock(stats_mutex);
+		num_solve_2agent_problems++;
+		// For statistic study!!!
+		if (save_stats)
+		{
+			sub_instances.emplace_back(a1, a2, &node, num_expanded, (int)num_expanded);
+		}
+	}
+	if (cost == MAX_COST) // no solution
+		return make_tuple(MAX_COST, length1, length2);
+	return make_tuple(cost - length1 - length2, length1, length2);
 }
 
 /*
@@ -870,7 +985,7 @@ int CBSHeuristic::getEdgeWeight(int a1, int a2, CBSNode& node, bool cardinal)
 		cbs.setConflictSelectionRule(conflict_seletion_rule);
 		cbs.setNodeSelectionRule(node_selection_fule);
 
-		double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+		double runtime = getElapsedTime(start_time);
 		cbs.solve(time_limit - runtime, max(rst, 0));
 		if (cbs.runtime >= time_limit - runtime) // time out
 			rst = (int)cbs.min_f_val - cost_shortestPath; // using lowerbound to approximate
@@ -885,7 +1000,7 @@ int CBSHeuristic::getEdgeWeight(int a1, int a2, CBSNode& node, bool cardinal)
 }
 */
 
-/*void CBSHeuristic::setUpSubSolver(CBS& cbs) const
+void CBSHeuristic::setUpSubSolver(CBS& cbs) const
 {
 	cbs.setPrioritizeConflicts(PC);
 	cbs.setHeuristicType(heuristics_type::CG, heuristics_type::ZERO);
@@ -899,7 +1014,7 @@ int CBSHeuristic::getEdgeWeight(int a1, int a2, CBSNode& node, bool cardinal)
 	cbs.setNodeSelectionRule(node_selection_rule);
 	cbs.setHighLevelSolver(high_level_solver_type::ASTAR, 1); // solve the sub problem optimally
 	cbs.setNodeLimit(node_limit);
-}*/
+}
 
 int CBSHeuristic::minimumVertexCover(const vector<int>& CG)
 {
@@ -939,39 +1054,32 @@ int CBSHeuristic::minimumVertexCover(const vector<int>& CG)
 			continue;
 		}
 
-		std::vector<int> subgraph(indices.size()  * indices.size(), 0);
-		int num_edges = 0;
+		std::vector<int> subgraph(indices.size()  * indices.size(), 0); // unit edge weights
 		for (int j = 0; j < (int) indices.size(); j++)
 		{
 			for (int k = j + 1; k < (int)indices.size(); k++)
 			{
-				subgraph[j * indices.size() + k] = CG[indices[j] * num_of_agents + indices[k]];
-				subgraph[k * indices.size() + j] = CG[indices[k] * num_of_agents + indices[j]];
-				if (subgraph[j * indices.size() + k] > 0)
-					num_edges++;
+				if (CG[indices[j] * num_of_agents + indices[k]] > 0 || CG[indices[k] * num_of_agents + indices[j]] > 0)
+				{
+					subgraph[j * indices.size() + k] = 1;
+					subgraph[k * indices.size() + j] = 1;
+				}
 			}
 		}
 
-		if (num_edges > ILP_edge_threshold)
+		if ((int)indices.size() > WeightedVertexCover::MAX_NUM_OF_NODES)
 		{
 			rst += greedyMatching(subgraph, (int)indices.size());
-			double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+			double runtime = getElapsedTime(start_time);
 			if (runtime > time_limit)
 				return -1; // run out of time
 		}
 		else
 		{
-			for (int k = 1; i < (int)indices.size(); k++)
-			{
-				if (KVertexCover(subgraph, (int)indices.size(), num_edges, i=k, (int)indices.size()))
-				{
-					rst += k;
-					break;
-				}
-				double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
-				if (runtime > time_limit)
-					return -1; // run out of time
-			}
+			int mvc = mvc_solver.solve(subgraph, (int)indices.size(), start_time, time_limit);
+			if (mvc < 0)
+				return -1; // run out of time
+			rst += mvc;
 		}
 	}
 	num_solve_MVC++;
@@ -1028,7 +1136,7 @@ int CBSHeuristic::minimumVertexCover(const std::vector<int>& CG, int old_mvc, in
 // Whether there exists a k-vertex cover solution
 bool CBSHeuristic::KVertexCover(const std::vector<int>& CG, int num_of_CGnodes, int num_of_CGedges, int k, int cols)
 {
-	double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+	double runtime = getElapsedTime(start_time);
 	if (runtime > time_limit)
 		return true; // run out of time
 	if (num_of_CGedges == 0)
@@ -1136,8 +1244,7 @@ int CBSHeuristic::minimumWeightedVertexCover(const vector<int>& HG)
 	return rst;
 }
 
-// branch and bound
-// enumerate all possible assignments and return the best one
+// solve the connected components one by one
 int CBSHeuristic::weightedVertexCover(const std::vector<int>& CG)
 {
 	int rst = 0;
@@ -1146,9 +1253,7 @@ int CBSHeuristic::weightedVertexCover(const std::vector<int>& CG)
 	{
 		if (done[i])
 			continue;
-		std::vector<int> range;
 		std::vector<int> indices;
-		range.reserve(num_of_agents);
 		indices.reserve(num_of_agents);
 		int num = 0;
 		std::queue<int> Q;
@@ -1157,27 +1262,13 @@ int CBSHeuristic::weightedVertexCover(const std::vector<int>& CG)
 		while (!Q.empty())
 		{
 			int j = Q.front(); Q.pop();
-			range.push_back(0);
 			indices.push_back(j);
 			for (int k = 0; k < num_of_agents; k++)
 			{
-				if (CG[j * num_of_agents + k] > 0)
+				if ((CG[j * num_of_agents + k] > 0 || CG[k * num_of_agents + j] > 0) && !done[k])
 				{
-					range[num] = std::max(range[num], CG[j * num_of_agents + k]);
-					if (!done[k])
-					{
-						Q.push(k);
-						done[k] = true;
-					}
-				}		
-				else if (CG[k * num_of_agents + j] > 0)
-				{
-					range[num] = std::max(range[num], CG[k * num_of_agents + j]);
-					if (!done[k])
-					{
-						Q.push(k);
-						done[k] = true;
-					}
+					Q.push(k);
+					done[k] = true;
 				}
 			}
 			num++;
@@ -1195,20 +1286,22 @@ int CBSHeuristic::weightedVertexCover(const std::vector<int>& CG)
 			for (int k = j + 1; k < num; k++)
 			{
 				G[j * num + k] = std::max(CG[indices[j] * num_of_agents + indices[k]], CG[indices[k] * num_of_agents + indices[j]]);
+				G[k * num + j] = G[j * num + k];
 			}
 		}
-		if (num > ILP_node_threshold)
+		if (num > WeightedVertexCover::MAX_NUM_OF_NODES)
 		{
 		    rst += greedyWeightedMatching(G, num);
 			// rst += ILPForWMVC(G, range);
 		}
 		else
 		{
-			std::vector<int> x(num);
-			int best_so_far = MAX_COST;
-			rst += DPForWMVC(x, 0, 0, G, range, best_so_far);
+			int wmvc = mvc_solver.solve(G, num, start_time, time_limit);
+			if (wmvc < 0)
+				return -1; // run out of time
+			rst += wmvc;
 		}
-		double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+		double runtime = getElapsedTime(start_time);
 		if (runtime > time_limit)
 			return -1; // run out of time
 	}
@@ -1232,62 +1325,6 @@ int CBSHeuristic::weightedVertexCover(const std::vector<int>& CG)
 	return rst;
 }
 
-// recusive component of weighted vertex cover
-int CBSHeuristic::DPForWMVC(std::vector<int>& x, int i, int sum, const std::vector<int>& CG,
-	const std::vector<int>& range, int& best_so_far)
-{
-	if (sum >= best_so_far)
-		return MAX_COST;
-	double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
-	if (runtime > time_limit)
-		return -1; // run out of time
-	else if (i == (int)x.size())
-	{
-		best_so_far = sum;
-		return sum;
-	}
-	else if (range[i] == 0) // vertex i does not have any edges.
-	{
-		int rst = DPForWMVC(x, i + 1, sum, CG, range, best_so_far);
-		if (rst < best_so_far)
-		{
-			best_so_far = rst;
-		}
-		return best_so_far;
-	}
-	
-	int cols = x.size();
-	
-	// find minimum cost for this vertex
-	int min_cost = 0;
-	for (int j = 0; j < i; j++)
-	{
-		if (min_cost + x[j] < CG[j * cols + i]) // infeasible assignment
-		{
-			min_cost = CG[j * cols + i] - x[j]; // cost should be at least CG[i][j] - x[j];
-		}
-	}
-
-
-	int best_cost = -1;
-	for (int cost = min_cost; cost <= range[i]; cost++)
-	{
-		x[i] = cost;
-		int rst = DPForWMVC(x, i + 1, sum + x[i], CG, range, best_so_far);
-		if (rst < best_so_far)
-		{
-			best_so_far = rst;
-			best_cost = cost;
-		}
-	}
-	if (best_cost >= 0)
-	{
-		x[i] = best_cost; 
-	}
-
-	return best_so_far;
-}
-
 /*int CBSHeuristic::ILPForWMVC(const vector<int>& CG, const vector<int>& node_max_value) const
 {
 		int N = (int)node_max_value.size();
@@ -1314,7 +1351,7 @@ int CBSHeuristic::DPForWMVC(std::vector<int>& x, int i, int sum, const std::vect
 		}
 		model.add(con);
 		IloCplex cplex(env);
-		double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+		double runtime = getElapsedTime(start_time);
 		if (time_limit - runtime <= 0)
 			return 0;
 		cplex.setParam(IloCplex::TiLim, time_limit - runtime);
@@ -1353,7 +1390,7 @@ int CBSHeuristic::DPForWMVC(std::vector<int>& x, int i, int sum, const std::vect
 	}
 	model.add(con);
 	IloCplex cplex(env);
-	double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+	double runtime = getElapsedTime(start_time);
 	cplex.setParam(IloCplex::TiLim, time_limit - runtime); // time limit = 300 sec
 	int solution_cost = -1;
 	cplex.extract(model);
@@ -1375,7 +1412,7 @@ int CBSHeuristic::DPForConstrainedWMVC(std::vector<bool>& x, int i, int sum, con
 {
 	if (sum >= best_so_far)
 		return INT_MAX;
-	double runtime = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+	double runtime = getElapsedTime(start_time);
 	if (runtime > time_limit)
 		return -1; // run out of time
 	else if (i == (int)x.size())
@@ -1,10 +1,11 @@
 #include "CBSNode.h"
+#include "ConstraintTable.h"
 
 
 void HLNode::clear()
 {
-	conflicts.clear();
-	unknownConf.clear();
+	vector<ConflictPtr>().swap(conflicts); // release the memory as well
+	vector<ConflictPtr>().swap(unknownConf);
 	// conflictGraph.clear();
 }
 
@@ -24,6 +25,25 @@ void HLNode::clear()
 	cout << endl;
 }*/
 
+// Conflicts shared with other nodes are counted in each of them, so the estimate is conservative.
+size_t HLNode::getMemoryUsage() const
+{
+	size_t memory = sizeof(Conflict) * (conflicts.size() + unknownConf.size()) +
+		sizeof(ConflictPtr) * (conflicts.capacity() + unknownConf.capacity()) +
+		sizeof(HLNode*) * children.capacity();
+	if (constraints.capacity() > constraints.static_capacity)
+		memory += sizeof(Constraint) * constraints.capacity();
+	if (constraint_layers.capacity() > constraint_layers.static_capacity)
+		memory += sizeof(pair<int, shared_ptr<const ConstraintLayer> >) * constraint_layers.capacity();
+	for (const auto& layer : constraint_layers) // shared layers are counted in each node
+	{
+		if (layer.second != nullptr)
+			memory += sizeof(ConstraintLayer) + sizeof(KeyedTimeRange) * layer.second->constraints.capacity() +
+				sizeof(pair<int, int>) * layer.second->landmarks.capacity();
+	}
+	return memory;
+}
+
 void HLNode::updateDistanceToGo()
 {
 	set<pair<int, int>> conflicting_agents;
@@ -63,12 +83,34 @@ void HLNode::printConstraints(int id) const
                     if (a == id)
                         cout << constraint << ",";
                     break;
+                case constraint_type::CONSTRAINT_COUNT:
+                    break;
             }
         }
         curr = curr->parent;
     }
 }
 
+std::ostream& operator<<(std::ostream& os, node_list list)
+{
+	switch (list)
+	{
+		case node_list::NONE:
+			os << "none";
+			break;
+		case node_list::OPEN:
+			os << "open";
+			break;
+		case node_list::FOCAL:
+			os << "focal";
+			break;
+		case node_list::CLEANUP:
+			os << "cleanup";
+			break;
+	}
+	return os;
+}
+
 std::ostream& operator<<(std::ostream& os, const HLNode& node)
 {
 	os << "Node " << node.time_generated << " from " << node.chosen_from << " ( f = "<< node.g_val << " + " <<
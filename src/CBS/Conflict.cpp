@@ -2,6 +2,49 @@
 #include "RectangleReasoning.h"
 #include "MDD.h"
 
+// Freed conflicts are kept for reuse by the next allocation on the same thread,
+// and the cached blocks are released when the thread exits.
+// Conflicts released after that, e.g., during static destruction, go straight back to the heap.
+static const size_t MAX_NUM_OF_FREE_CONFLICTS = 1 << 16;
+static thread_local bool free_conflicts_destroyed = false;
+struct FreeConflicts
+{
+	vector<void*> blocks;
+	~FreeConflicts()
+	{
+		for (auto p : blocks)
+			::operator delete(p);
+		free_conflicts_destroyed = true;
+	}
+};
+static FreeConflicts* getFreeConflicts()
+{
+	if (free_conflicts_destroyed)
+		return nullptr;
+	static thread_local FreeConflicts free_conflicts;
+	return &free_conflicts;
+}
+
+void* Conflict::operator new(size_t size)
+{
+	auto free_conflicts = getFreeConflicts();
+	if (size != sizeof(Conflict) || free_conflicts == nullptr || free_conflicts->blocks.empty())
+		return ::operator new(size);
+	auto p = free_conflicts->blocks.back();
+	free_conflicts->blocks.pop_back();
+	return p;
+}
+
+void Conflict::operator delete(void* p, size_t size)
+{
+	auto free_conflicts = getFreeConflicts();
+	if (size != sizeof(Conflict) || free_conflicts == nullptr ||
+		free_conflicts->blocks.size() >= MAX_NUM_OF_FREE_CONFLICTS)
+		::operator delete(p);
+	else
+		free_conflicts->blocks.push_back(p);
+}
+
 
 std::ostream& operator<<(std::ostream& os, const Constraint& constraint)
 {
@@ -33,6 +76,8 @@ std::ostream& operator<<(std::ostream& os, const Constraint& constraint)
 		case constraint_type::LEQLENGTH:
 			os << "L";
 			break;
+		case constraint_type::CONSTRAINT_COUNT:
+			break;
 	}
 	os << ">";
 	return os;
@@ -55,6 +100,7 @@ std::ostream& operator<<(std::ostream& os, const Conflict& conflict)
 		case conflict_priority::NON:
 			os << "non-cardinal ";
 			break;
+        case conflict_priority::UNKNOWN:
         case conflict_priority::PRIORITY_COUNT:
             break;
     }
@@ -95,7 +141,7 @@ bool operator < (const Conflict& conflict1, const Conflict& conflict2) // return
 		{
 			if (conflict1.secondary_priority == conflict2.secondary_priority)
 			{
-				return rand() % 2;
+				return getTieBreakGenerator()() % 2;
 			}
 			return conflict1.secondary_priority > conflict2.secondary_priority;
 		}
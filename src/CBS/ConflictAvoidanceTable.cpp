@@ -0,0 +1,192 @@
+#include <algorithm>
+#include "ConflictAvoidanceTable.h"
+
+void ConflictAvoidanceTable::init(size_t map_size, int num_of_agents)
+{
+	if (table.size() == map_size) // reuse the table by removing the paths in it
+	{
+		for (int agent = 0; agent < (int)paths.size(); agent++)
+			deletePath(agent);
+	}
+	else
+	{
+		table.assign(map_size, vector<pair<int, int> >());
+		goal_arrivals.assign(map_size, vector<pair<int, int> >());
+	}
+	paths.assign(num_of_agents, Path());
+	path_pointers.assign(num_of_agents, nullptr);
+}
+
+void ConflictAvoidanceTable::clear()
+{
+	table.clear();
+	goal_arrivals.clear();
+	paths.clear();
+	path_pointers.clear();
+}
+
+void ConflictAvoidanceTable::updatePath(int agent, const Path* path)
+{
+	deletePath(agent);
+	path_pointers[agent] = path;
+	if (path != nullptr)
+		paths[agent] = *path;
+	insertPath(agent);
+}
+
+void ConflictAvoidanceTable::updatePaths(const vector<Path*>& new_paths)
+{
+	assert(new_paths.size() == paths.size());
+	for (int agent = 0; agent < (int)new_paths.size(); agent++)
+	{
+		if (new_paths[agent] != path_pointers[agent])
+			updatePath(agent, new_paths[agent]);
+	}
+}
+
+void ConflictAvoidanceTable::insertPath(int agent)
+{
+	const auto& path = paths[agent];
+	if (path.empty())
+		return;
+	for (int t = 0; t < (int)path.size(); t++)
+	{
+		auto& cells = table[path[t].location];
+		if ((int)cells.size() <= t)
+			cells.resize(t + 1, make_pair(0, 0));
+		cells[t].first++;
+		cells[t].second += agent;
+	}
+	goal_arrivals[path.back().location].emplace_back((int)path.size(), agent);
+}
+
+void ConflictAvoidanceTable::deletePath(int agent)
+{
+	auto& path = paths[agent];
+	if (path.empty())
+		return;
+	for (int t = 0; t < (int)path.size(); t++)
+	{
+		assert((int)table[path[t].location].size() > t && table[path[t].location][t].first > 0);
+		table[path[t].location][t].first--;
+		table[path[t].location][t].second -= agent;
+	}
+	auto& arrivals = goal_arrivals[path.back().location];
+	auto it = std::find(arrivals.begin(), arrivals.end(), make_pair((int)path.size(), agent));
+	assert(it != arrivals.end());
+	*it = arrivals.back();
+	arrivals.pop_back();
+	path.clear();
+}
+
+int ConflictAvoidanceTable::getNumOfAgents(size_t loc, int t) const
+{
+	int rst = t < (int)table[loc].size() ? table[loc][t].first : 0;
+	for (const auto& arrival : goal_arrivals[loc])
+	{
+		if (arrival.first <= t)
+			rst++;
+	}
+	return rst;
+}
+
+bool ConflictAvoidanceTable::occupies(int agent, size_t loc, int t) const
+{
+	const auto& path = paths[agent];
+	if (path.empty())
+		return false;
+	return (size_t)(t < (int)path.size() ? path[t].location : path.back().location) == loc;
+}
+
+void ConflictAvoidanceTable::getAgentsOnPaths(size_t loc, int t, int agent, vector<int>& agents) const
+{
+	if (t >= (int)table[loc].size())
+		return;
+	int num = table[loc][t].first;
+	int sum = table[loc][t].second;
+	if (t < (int)paths[agent].size() && (size_t)paths[agent][t].location == loc)
+	{
+		num--;
+		sum -= agent;
+	}
+	if (num == 1)
+	{
+		agents.push_back(sum);
+	}
+	else if (num > 1) // rare, so we look for the agents in their paths
+	{
+		for (int i = 0; i < (int)paths.size(); i++)
+		{
+			if (i != agent && t < (int)paths[i].size() && (size_t)paths[i][t].location == loc)
+				agents.push_back(i);
+		}
+	}
+}
+
+void ConflictAvoidanceTable::getConflictingAgents(int agent, vector<int>& agents) const
+{
+	agents.clear();
+	const auto& path = paths[agent];
+	if (path.empty())
+		return;
+	for (int t = 0; t < (int)path.size(); t++)
+	{
+		size_t loc = path[t].location;
+		// vertex conflicts
+		getAgentsOnPaths(loc, t, agent, agents);
+		for (const auto& arrival : goal_arrivals[loc])
+		{
+			if (arrival.first <= t && arrival.second != agent)
+				agents.push_back(arrival.second);
+		}
+		// edge conflicts
+		if (t > 0 && (size_t)path[t - 1].location != loc)
+		{
+			auto num = agents.size();
+			getAgentsOnPaths(loc, t - 1, agent, agents);
+			auto it = agents.begin() + num;
+			for (auto it2 = it; it2 != agents.end(); ++it2)
+			{
+				if (occupies(*it2, path[t - 1].location, t))
+					*it++ = *it2;
+			}
+			agents.erase(it, agents.end());
+		}
+	}
+	// target conflicts, i.e., the other agents visit the goal location after the agent reaches it
+	size_t goal = path.back().location;
+	for (int t = (int)path.size(); t < (int)table[goal].size(); t++)
+		getAgentsOnPaths(goal, t, agent, agents);
+	for (const auto& arrival : goal_arrivals[goal])
+	{
+		if (arrival.second != agent)
+			agents.push_back(arrival.second);
+	}
+	std::sort(agents.begin(), agents.end());
+	agents.erase(std::unique(agents.begin(), agents.end()), agents.end());
+}
+
+int ConflictAvoidanceTable::getNumOfConflictsForStep(int agent, size_t curr_id, size_t next_id, int next_timestep) const
+{
+	// the counts include the path of the agent itself, which is subtracted only when the count is positive
+	int num = getNumOfAgents(next_id, next_timestep);
+	if (num > 0 && num > (int)occupies(agent, next_id, next_timestep))
+		return 1;
+	if (curr_id == next_id)
+		return 0;
+	num = getNumOfAgents(next_id, next_timestep - 1);
+	if (num == 0 || num <= (int)occupies(agent, next_id, next_timestep - 1))
+		return 0;
+	num = getNumOfAgents(curr_id, next_timestep);
+	if (num == 0 || num <= (int)occupies(agent, curr_id, next_timestep))
+		return 0;
+	return 1;
+}
+
+int ConflictAvoidanceTable::getMakespan() const
+{
+	int rst = 0;
+	for (const auto& path : paths)
+		rst = max(rst, (int)path.size() - 1);
+	return rst;
+}
@@ -6,83 +6,28 @@
 #include <utility>
 #include <iostream>
 
-// is a mutex edge mutex.
-bool is_edge_mutex(edge_pair ep){
-  return ep.first.second != nullptr;
-}
-
-bool ConstraintPropagation::should_be_bwd_mutexed(MDDNode* node_a, MDDNode* node_b){
-  for (auto node_a_to: node_a->children){
-    for (auto node_b_to: node_b->children){
-      // either if node mutex or edge mutex
-      if (has_mutex(node_b_to, node_a_to)){
-        continue;
-      }
-      if (has_mutex({{node_a, node_a_to}, {node_b, node_b_to}})){
-        continue;
-      }
-      return false;
-    }
+bool ConstraintPropagation::get_mutex(const std::vector<MutexMatrix>& mutexes, MDDNode* a, MDDNode* b) const{
+  if (a == nullptr || b == nullptr || a->level != b->level || a->level >= (int)mutexes.size()){
+    return false;
   }
-
-  return true;
-}
-
-bool ConstraintPropagation::should_be_fwd_mutexed(MDDNode* node_a, MDDNode* node_b){
-  for (auto node_a_from: node_a->parents){
-    for (auto node_b_from: node_b->parents){
-      // either if node mutex or edge mutex
-      if (has_fwd_mutex(node_b_from, node_a_from)){
-        continue;
-      }
-      if (has_fwd_mutex({{node_a_from, node_a}, {node_b_from, node_b}})){
-        continue;
-      }
-      return false;
-    }
+  auto indexed = [](const std::vector<std::vector<MDDNode*> >& nodes, const std::vector<int>& index, const MDDNode* n){
+    return n->id < (int)index.size() && index[n->id] >= 0 && nodes[n->level][index[n->id]] == n;
+  };
+  if (!indexed(nodes0, index0, a)){
+    std::swap(a, b);
   }
-
-
-  return true;
+  if (!indexed(nodes0, index0, a) || !indexed(nodes1, index1, b)){
+    return false;
+  }
+  return mutexes[a->level].get(index0[a->id], index1[b->id]);
 }
 
-bool ConstraintPropagation::has_mutex(edge_pair e){
-  return (bwd_mutexes.find({e.first, e.second}) != bwd_mutexes.end() || bwd_mutexes.find({e.second, e.first}) != bwd_mutexes.end()) || has_fwd_mutex(e);
-}
 bool ConstraintPropagation::has_mutex(MDDNode* a, MDDNode* b){
-  return has_mutex({{a, nullptr}, {b, nullptr}});
+  return get_mutex(bwd_mutexes, a, b) || get_mutex(fwd_mutexes, a, b);
 }
 
-bool ConstraintPropagation::has_fwd_mutex(edge_pair e){
-  return fwd_mutexes.find({e.first, e.second}) != fwd_mutexes.end() || fwd_mutexes.find({e.second, e.first}) != fwd_mutexes.end();
-}
 bool ConstraintPropagation::has_fwd_mutex(MDDNode* a, MDDNode* b){
-  return has_fwd_mutex({{a, nullptr}, {b, nullptr}});
-}
-
-void ConstraintPropagation::add_bwd_node_mutex(MDDNode* node_a, MDDNode* node_b){
-  // TODO check
-  if (has_mutex({{node_a, nullptr}, {node_b, nullptr}})){
-    return;
-  }
-  bwd_mutexes.insert({{node_a, nullptr}, {node_b, nullptr}});
-}
-
-void ConstraintPropagation::add_fwd_edge_mutex(MDDNode* node_a, MDDNode* node_a_to,
-                                           MDDNode* node_b, MDDNode* node_b_to){
-  if (has_fwd_mutex({{node_a, node_a_to}, {node_b, node_b_to}})){
-    return;
-  }
-
-  fwd_mutexes.insert({{node_a, node_a_to}, {node_b, node_b_to}});
-}
-
-void ConstraintPropagation::add_fwd_node_mutex(MDDNode* node_a, MDDNode* node_b){
-  // TODO check
-  if (has_fwd_mutex({{node_a, nullptr}, {node_b, nullptr}})){
-    return;
-  }
-  fwd_mutexes.insert({{node_a, nullptr}, {node_b, nullptr}});
+  return get_mutex(fwd_mutexes, a, b);
 }
 
 // void ConstraintPropagation::init_mutex(){
@@ -94,149 +39,123 @@ void ConstraintPropagation::add_fwd_node_mutex(MDDNode* node_a, MDDNode* node_b)
 // }
 
 void ConstraintPropagation::init_mutex(){
-  int num_level = std::min(mdd0->levels.size(), mdd1->levels.size());
-  // node mutex
+  num_level = std::min(mdd0->levels.size(), mdd1->levels.size());
+  nodes0.resize(num_level);
+  nodes1.resize(num_level);
+  index0.assign(mdd0->getNumOfNodes(), -1);
+  index1.assign(mdd1->getNumOfNodes(), -1);
+  fwd_mutexes.resize(num_level);
+  bwd_mutexes.clear();
   for (int i = 0; i < num_level; i++){
-    // COMMENT unordered map can be changed to vector for efficiency
-    auto loc2mdd = collectMDDlevel(mdd0, i);
-    for (MDDNode* it_1 : mdd1->levels[i]){
-      if (loc2mdd.find(it_1->location) != loc2mdd.end()){
-        add_fwd_node_mutex(loc2mdd[it_1->location], it_1);
+    nodes0[i].assign(mdd0->levels[i].begin(), mdd0->levels[i].end());
+    nodes1[i].assign(mdd1->levels[i].begin(), mdd1->levels[i].end());
+    for (int j = 0; j < (int)nodes0[i].size(); j++){
+      index0[nodes0[i][j]->id] = j;
+    }
+    for (int j = 0; j < (int)nodes1[i].size(); j++){
+      index1[nodes1[i][j]->id] = j;
+    }
+    // node mutex: both levels are sorted by location
+    fwd_mutexes[i].reset(nodes0[i].size(), nodes1[i].size());
+    int j0 = 0, j1 = 0;
+    while (j0 < (int)nodes0[i].size() && j1 < (int)nodes1[i].size()){
+      if (nodes0[i][j0]->location < nodes1[i][j1]->location){
+        j0++;
+      }else if (nodes0[i][j0]->location > nodes1[i][j1]->location){
+        j1++;
+      }else{
+        fwd_mutexes[i].set(j0++, j1++);
       }
     }
   }
-  // edge mutex
+  // edge mutexes are the pairs of swapping edges, which propagate() tests directly
+}
 
-  unordered_map<int, MDDNode*> loc2mddThisLvl;
-  unordered_map<int, MDDNode*> loc2mddNextLvl = collectMDDlevel(mdd1, 0);
+void ConstraintPropagation::propagate(const MutexMatrix& src, MutexMatrix& dst, int from, int to){
+  bool forward = from < to;
+  auto neighbors = [forward](const MDDNode* n) { return forward ? n->parents : n->children; }; // towards level `from`
+  const auto& nodes_from = nodes1[from];
+
+  // the neighbors at level `to` of each node of MDD 1 at level `from`
+  MutexMatrix neighbor_masks;
+  neighbor_masks.reset(nodes_from.size(), nodes1[to].size());
+  for (int j = 0; j < (int)nodes_from.size(); j++){
+    for (auto n : forward ? nodes_from[j]->children : nodes_from[j]->parents){
+      neighbor_masks.set(j, index1[n->id]);
+    }
+  }
 
-  for (int i = 0; i < num_level - 1; i++){
-    loc2mddThisLvl = loc2mddNextLvl;
-    loc2mddNextLvl = collectMDDlevel(mdd1, i + 1);
-    for (auto& node_0 : mdd0->levels[i]){
-      int loc_0 = node_0->location;
-      if (loc2mddNextLvl.find(loc_0) == loc2mddNextLvl.end()){
-        continue;
+  std::vector<uint64_t> non_mutexed_from(src.num_words), non_mutexed_to(dst.num_words);
+  std::vector<const MDDNode*> not_mutexed_with_x;
+  for (int i = 0; i < (int)nodes0[to].size(); i++){
+    auto node_a = nodes0[to][i];
+    // the nodes of MDD 1 at level `from` that are not mutexed with some neighbor of node_a
+    std::fill(non_mutexed_from.begin(), non_mutexed_from.end(), 0);
+    for (auto a_from : neighbors(node_a)){
+      auto row = src.row(index0[a_from->id]);
+      for (int w = 0; w < src.num_words; w++){
+        non_mutexed_from[w] |= ~row[w];
       }
-      MDDNode* node_1_to = loc2mddNextLvl[loc_0];
+    }
+    if (src.num_cols % 64 != 0){
+      non_mutexed_from.back() &= ((uint64_t)1 << (src.num_cols % 64)) - 1;
+    }
 
-      for (auto node_0_to:node_0->children){
-        int loc_1 = node_0_to->location;
-        if (loc2mddThisLvl.find(loc_1) == loc2mddThisLvl.end()){
-          continue;
-        }
+    // the node of MDD 1 at level `from` and the location of node_a, whose edges can swap with the edges of node_a
+    auto it = std::lower_bound(nodes_from.begin(), nodes_from.end(), node_a->location,
+                               [](const MDDNode* n, int loc) { return n->location < loc; });
+    int x = (it != nodes_from.end() && (*it)->location == node_a->location) ? (int)(it - nodes_from.begin()) : -1;
 
-        MDDNode* node_1 = loc2mddThisLvl[loc_1];
-        for (auto ptr:node_1->children){
-          if (ptr == node_1_to){
-            add_fwd_edge_mutex(node_0, node_0_to, node_1, node_1_to);
-          }
+    std::fill(non_mutexed_to.begin(), non_mutexed_to.end(), 0);
+    for (int w = 0; w < src.num_words; w++){
+      uint64_t bits = non_mutexed_from[w];
+      if (x >= 0 && x / 64 == w){
+        bits &= ~((uint64_t)1 << (x % 64));
+      }
+      while (bits != 0){
+        auto row = neighbor_masks.row(w * 64 + __builtin_ctzll(bits));
+        for (int k = 0; k < dst.num_words; k++){
+          non_mutexed_to[k] |= row[k];
         }
+        bits &= bits - 1;
       }
     }
-  }
-}
-
-void ConstraintPropagation::fwd_mutex_prop(){
-  std::deque<edge_pair> open(fwd_mutexes.begin(), fwd_mutexes.end());
-
-  while (!open.empty()){
-    auto mutex = open.front();
-
-    open.pop_front();
-
-    if (is_edge_mutex(mutex)){
-      auto node_to_1 = mutex.first.second;
-      auto node_to_2 = mutex.second.second;
-
-      if (has_fwd_mutex(node_to_1, node_to_2)){
-        continue;
-      }
-
-      if (!should_be_fwd_mutexed(node_to_1, node_to_2)){
-        continue;
+    if (x >= 0 && ((non_mutexed_from[x / 64] >> (x % 64)) & 1)){
+      // a non-mutexed pair <a_from, x> is fine for the neighbor b_to of x if they form a pair of swapping edges
+      not_mutexed_with_x.clear();
+      for (auto a_from : neighbors(node_a)){
+        if (!src.get(index0[a_from->id], x)){
+          not_mutexed_with_x.push_back(a_from);
+        }
       }
-      auto new_mutex = std::make_pair(std::make_pair(node_to_1, nullptr),
-                                      std::make_pair(node_to_2, nullptr));
-
-      fwd_mutexes.insert(new_mutex);
-      open.push_back(new_mutex);
-    }else{
-      // Node mutex
-      auto node_a = mutex.first.first;
-      auto node_b = mutex.second.first;
-
-      // Check their child
-
-      for (auto node_a_ch: node_a->children){
-        for (auto node_b_ch: node_b->children){
-
-          if (has_fwd_mutex(node_a_ch, node_b_ch)){
-            continue;
-          }
-
-          if (!should_be_fwd_mutexed(node_a_ch, node_b_ch)){
-            continue;
-          }
-          auto new_mutex = std::make_pair(std::make_pair(node_a_ch, nullptr),
-                                          std::make_pair(node_b_ch, nullptr));
-
-          fwd_mutexes.insert(new_mutex);
-          open.push_back(new_mutex);
+      for (auto b_to : forward ? nodes_from[x]->children : nodes_from[x]->parents){
+        if (not_mutexed_with_x.size() != 1 || not_mutexed_with_x.front()->location != b_to->location){
+          int j = index1[b_to->id];
+          non_mutexed_to[j / 64] |= (uint64_t)1 << (j % 64);
         }
       }
     }
+
+    auto row = dst.row(i);
+    for (int k = 0; k < dst.num_words; k++){
+      row[k] |= ~non_mutexed_to[k];
+    }
+    if (dst.num_cols % 64 != 0){
+      row[dst.num_words - 1] &= ((uint64_t)1 << (dst.num_cols % 64)) - 1;
+    }
   }
 }
 
-void ConstraintPropagation::bwd_mutex_prop(){
-  std::deque<edge_pair> open(fwd_mutexes.begin(), fwd_mutexes.end());
-
-  while (!open.empty()){
-    auto mutex = open.front();
-
-    open.pop_front();
-
-    if (is_edge_mutex(mutex)){
-      auto node_from_1 = mutex.first.first;
-      auto node_from_2 = mutex.second.first;
-
-      if (has_mutex(node_from_1, node_from_2)){
-        continue;
-      }
-
-      if (!should_be_bwd_mutexed(node_from_1, node_from_2)){
-        continue;
-      }
-      auto new_mutex = std::make_pair(std::make_pair(node_from_1, nullptr),
-                                      std::make_pair(node_from_2, nullptr));
-
-      bwd_mutexes.insert(new_mutex);
-      open.push_back(new_mutex);
-    }else{
-      // Node mutex
-      auto node_a = mutex.first.first;
-      auto node_b = mutex.second.first;
-
-      // Check their child
-      for (auto node_a_pa: node_a->parents){
-        for (auto node_b_pa: node_b->parents){
-
-          if (has_mutex(node_a_pa, node_b_pa)){
-            continue;
-          }
-
-          if (!should_be_bwd_mutexed(node_a_pa, node_b_pa)){
-            continue;
-          }
-          auto new_mutex = std::make_pair(std::make_pair(node_a_pa, nullptr),
-                                          std::make_pair(node_b_pa, nullptr));
+void ConstraintPropagation::fwd_mutex_prop(){
+  for (int l = 0; l + 1 < num_level; l++){
+    propagate(fwd_mutexes[l], fwd_mutexes[l + 1], l, l + 1);
+  }
+}
 
-          bwd_mutexes.insert(new_mutex);
-          open.push_back(new_mutex);
-        }
-      }
-    }
+void ConstraintPropagation::bwd_mutex_prop(){
+  bwd_mutexes = fwd_mutexes;
+  for (int l = num_level - 2; l >= 0; l--){
+    propagate(bwd_mutexes[l + 1], bwd_mutexes[l], l + 1, l);
   }
 }
 
@@ -251,10 +170,10 @@ bool ConstraintPropagation::mutexed(int level_0, int level_1){
     mdd_l = mdd0;
   }
 
-  if (level_0 > mdd_s->levels.size()){
+  if (level_0 > (int)mdd_s->levels.size()){
     std::cout << "ERROR!" << std::endl;
   }
-  if (level_1 > mdd_l->levels.size()){
+  if (level_1 > (int)mdd_l->levels.size()){
     std::cout << "ERROR!" << std::endl;
   }
 
@@ -280,10 +199,10 @@ int ConstraintPropagation::_feasible(int level_0, int level_1){
     mdd_l = mdd0;
   }
 
-  if (level_0 > mdd_s->levels.size()){
+  if (level_0 > (int)mdd_s->levels.size()){
     std::cout << "ERROR!" << std::endl;
   }
-  if (level_1 > mdd_l->levels.size()){
+  if (level_1 > (int)mdd_l->levels.size()){
     std::cout << "ERROR!" << std::endl;
   }
 
@@ -308,7 +227,7 @@ int ConstraintPropagation::_feasible(int level_0, int level_1){
 
   int not_allowed_loc = goal_ptr_i->location;
 
-  boost::unordered_set<MDDNode*> closed;
+  std::vector<bool> closed(mdd_l->getNumOfNodes(), false);
 
   while (!dfs_stack.empty()){
     auto ptr = dfs_stack.top();
@@ -319,13 +238,13 @@ int ConstraintPropagation::_feasible(int level_0, int level_1){
       return 1;
     }
 
-    if (closed.find(ptr) != closed.end()){
+    if (closed[ptr->id]){
       continue;
     }
-    closed.insert(ptr);
+    closed[ptr->id] = true;
 
     for (auto child_ptr: ptr->children){
-      if (closed.find(child_ptr) != closed.end()){
+      if (closed[child_ptr->id]){
         continue;
       }
 
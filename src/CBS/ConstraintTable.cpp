@@ -8,28 +8,54 @@ void ConstraintTable::insert2CT(size_t from, size_t to, int t_min, int t_max)
 void ConstraintTable::insert2CT(size_t loc, int t_min, int t_max)
 {
 	assert(loc >= 0);
-	ct[loc].emplace_back(t_min, t_max);
-	if (t_max < MAX_TIMESTEP && t_max > latest_timestep)
+	KeyedTimeRange entry(loc, TimeRange(t_min, t_max));
+	// after the ranges of the same location/edge
+	ct_ranges.insert(std::upper_bound(ct_ranges.begin(), ct_ranges.end(), entry, compareKeys), entry);
+	latest_timestep = max(latest_timestep, getLatestTimestep(entry.second));
+}
+
+void ConstraintTable::mergeSorted(const vector<KeyedTimeRange>& ranges, vector<KeyedTimeRange>& table)
+{
+	if (table.empty())
 	{
-		latest_timestep = t_max;
+		table = ranges;
+		return;
 	}
-	else if (t_max == MAX_TIMESTEP && t_min > latest_timestep)
+	auto middle = table.size();
+	table.insert(table.end(), ranges.begin(), ranges.end());
+	// the old ranges of each location/edge go first, followed by the new ones in their order
+	std::inplace_merge(table.begin(), table.begin() + middle, table.end(), compareKeys);
+}
+
+void ConstraintTable::sortAndMerge(vector<KeyedTimeRange>& staged, vector<KeyedTimeRange>& table)
+{
+	std::stable_sort(staged.begin(), staged.end(), compareKeys);
+	mergeSorted(staged, table);
+}
+
+pair<vector<KeyedTimeRange>::const_iterator, vector<KeyedTimeRange>::const_iterator>
+	ConstraintTable::findRanges(const vector<KeyedTimeRange>& table, size_t key)
+{
+	struct KeyCompare
 	{
-		latest_timestep = t_min;
-	}
+		bool operator()(const KeyedTimeRange& a, size_t b) const { return a.first < b; }
+		bool operator()(size_t a, const KeyedTimeRange& b) const { return a < b.first; }
+	};
+	return std::equal_range(table.begin(), table.end(), key, KeyCompare());
 }
 
 void ConstraintTable::insertLandmark(size_t loc, int t)
 {
-	auto it = landmarks.find(t);
-	if (it == landmarks.end())
+	if ((int)landmarks.size() <= t)
+		landmarks.resize(t + 1, -1);
+	if (landmarks[t] < 0)
 	{
-		landmarks[t] = loc;
+		landmarks[t] = (int)loc;
 		if (t > latest_timestep)
 			latest_timestep = t;
 	}
 	else
-		assert(it->second == loc);
+		assert(landmarks[t] == (int)loc);
 }
 
 // return the location-time pairs on the barrier in an increasing order of their timesteps
@@ -72,21 +98,16 @@ bool ConstraintTable::constrained(size_t loc, int t) const
 	assert(loc >= 0);
 	if (loc < map_size)
 	{
-	    if (path_table.constrained(loc, loc, t))
-	        return true;
-		const auto& it = landmarks.find(t);
-		if (it != landmarks.end() && it->second != loc)
+		if (path_table.constrained(loc, loc, t))
+			return true;
+		if (t < (int)landmarks.size() && landmarks[t] >= 0 && landmarks[t] != (int)loc)
 			return true;  // violate the positive vertex constraint
-	}	
-
-	const auto& it = ct.find(loc);
-	if (it == ct.end())
-	{
-		return false;
 	}
-	for (const auto& constraint: it->second)
+
+	auto range = findRanges(ct_ranges, loc);
+	for (auto it = range.first; it != range.second; ++it)
 	{
-		if (constraint.first <= t && t < constraint.second)
+		if (it->second.first <= t && t < it->second.second)
 			return true;
 	}
 	return false;
@@ -105,144 +126,154 @@ void ConstraintTable::copy(const ConstraintTable& other)
 	latest_timestep = other.latest_timestep;
 	num_col = other.num_col;
 	map_size = other.map_size;
-	ct = other.ct;
+	ct_ranges = other.ct_ranges;
 	landmarks = other.landmarks;
-	// we do not copy cat
 }
 
 // build the constraint table for the given agent at the give node 
 void ConstraintTable::build(const HLNode& node, int agent)
 {
-	auto curr = &node;
-	while (curr->parent != nullptr)
+	auto layer = getLayer(node, agent);
+	if (layer != nullptr)
+	{
+		length_min = max(length_min, layer->length_min);
+		length_max = min(length_max, layer->length_max);
+		latest_timestep = max(latest_timestep, layer->latest_timestep);
+		mergeSorted(layer->constraints, ct_ranges);
+		for (const auto& landmark : layer->landmarks)
+			insertLandmark(landmark.second, landmark.first);
+	}
+	if (latest_timestep < length_min)
+		latest_timestep = length_min;
+	if (length_max < MAX_TIMESTEP && latest_timestep < length_max)
+		latest_timestep = length_max;
+}
+
+// return the layer of constraints for the given agent at the given node.
+// Only the nodes between the given node and the closest ancestor that has a layer for the agent are visited.
+shared_ptr<const ConstraintLayer> ConstraintTable::getLayer(const HLNode& node, int agent) const
+{
+	shared_ptr<const ConstraintLayer> base;
+	ConstraintLayer new_constraints; // the constraints that are not in the layer of the ancestor
+	for (auto curr = &node; curr->parent != nullptr; curr = curr->parent)
 	{
-		int a, x, y, t;
-		constraint_type type;
-		tie(a, x, y, t, type) = curr->constraints.front();
-		switch (type)
+		auto it = std::find_if(curr->constraint_layers.begin(), curr->constraint_layers.end(),
+			[agent](const pair<int, shared_ptr<const ConstraintLayer> >& cached) { return cached.first == agent; });
+		if (it != curr->constraint_layers.end())
 		{
-			case constraint_type::LEQLENGTH:
-				assert(curr->constraints.size() == 1);
-				if (agent == a) // this agent has to reach its goal at or before timestep t.
-					length_max = min(length_max, t);
-				else // other agents cannot stay at x at or after timestep t
-					insert2CT(x, t, MAX_TIMESTEP);
-				break;
-			case constraint_type::GLENGTH:
-				assert(curr->constraints.size() == 1);
-				if (a == agent) // path of agent_id should be of length at least t + 1
-					length_min = max(length_min, t + 1);
-				break;
-			case constraint_type::POSITIVE_VERTEX:
-				assert(curr->constraints.size() == 1);
-				if (agent == a) // this agent has to be at x at timestep t 
-				{
-					insertLandmark(x, t);
-				}
-				else // other agents cannot stay at x at timestep t
-				{
-					insert2CT(x, t, t + 1);
-				}
-				break;
-			case constraint_type::POSITIVE_EDGE:
-				assert(curr->constraints.size() == 1);
-				if (agent == a) // this agent has to be at x at timestep t - 1 and be at y at timestep t
-				{
-					insertLandmark(x, t - 1);
-					insertLandmark(y, t);
-				}
-				else // other agents cannot stay at x at timestep t - 1, be at y at timestep t, or traverse edge (y, x) from timesteps t - 1 to t
-				{
-					insert2CT(x, t - 1, t);
-					insert2CT(y, t, t + 1);
-					insert2CT(y, x, t, t + 1);
-				}
-				break;
-			case constraint_type::VERTEX:
-				if (a == agent)
+			base = it->second;
+			break;
+		}
+		addConstraints(new_constraints, *curr, agent);
+	}
+	if (new_constraints.empty())
+		return base;
+
+	auto layer = base == nullptr ? make_shared<ConstraintLayer>() : make_shared<ConstraintLayer>(*base);
+	layer->length_min = max(layer->length_min, new_constraints.length_min);
+	layer->length_max = min(layer->length_max, new_constraints.length_max);
+	for (const auto& constraint : new_constraints.constraints)
+		layer->latest_timestep = max(layer->latest_timestep, getLatestTimestep(constraint.second));
+	sortAndMerge(new_constraints.constraints, layer->constraints);
+	layer->landmarks.insert(layer->landmarks.end(), new_constraints.landmarks.begin(), new_constraints.landmarks.end());
+	return layer;
+}
+
+void ConstraintTable::cacheLayer(HLNode& node, int agent) const
+{
+	if (node.parent == nullptr || std::any_of(node.constraint_layers.begin(), node.constraint_layers.end(),
+			[agent](const pair<int, shared_ptr<const ConstraintLayer> >& cached) { return cached.first == agent; }))
+		return;
+	node.constraint_layers.emplace_back(agent, getLayer(node, agent));
+}
+
+void ConstraintTable::addConstraints(ConstraintLayer& layer, const HLNode& node, int agent) const
+{
+	int a, x, y, t;
+	constraint_type type;
+	tie(a, x, y, t, type) = node.constraints.front();
+	switch (type)
+	{
+		case constraint_type::LEQLENGTH:
+			assert(node.constraints.size() == 1);
+			if (agent == a) // this agent has to reach its goal at or before timestep t.
+				layer.length_max = min(layer.length_max, t);
+			else // other agents cannot stay at x at or after timestep t
+				layer.constraints.emplace_back(x, TimeRange(t, MAX_TIMESTEP));
+			break;
+		case constraint_type::GLENGTH:
+			assert(node.constraints.size() == 1);
+			if (a == agent) // path of agent_id should be of length at least t + 1
+				layer.length_min = max(layer.length_min, t + 1);
+			break;
+		case constraint_type::POSITIVE_VERTEX:
+			assert(node.constraints.size() == 1);
+			if (agent == a) // this agent has to be at x at timestep t 
+			{
+				layer.landmarks.emplace_back(t, x);
+			}
+			else // other agents cannot stay at x at timestep t
+			{
+				layer.constraints.emplace_back(x, TimeRange(t, t + 1));
+			}
+			break;
+		case constraint_type::POSITIVE_EDGE:
+			assert(node.constraints.size() == 1);
+			if (agent == a) // this agent has to be at x at timestep t - 1 and be at y at timestep t
+			{
+				layer.landmarks.emplace_back(t - 1, x);
+				layer.landmarks.emplace_back(t, y);
+			}
+			else // other agents cannot stay at x at timestep t - 1, be at y at timestep t, or traverse edge (y, x) from timesteps t - 1 to t
+			{
+				layer.constraints.emplace_back(x, TimeRange(t - 1, t));
+				layer.constraints.emplace_back(y, TimeRange(t, t + 1));
+				layer.constraints.emplace_back(getEdgeIndex(y, x), TimeRange(t, t + 1));
+			}
+			break;
+		case constraint_type::VERTEX:
+			if (a == agent)
+			{
+				for (const auto& constraint : node.constraints)
 				{
-					for (const auto& constraint : curr->constraints)
-					{
-						tie(a, x, y, t, type) = constraint;
-						insert2CT(x, t, t + 1);
-					}
+					tie(a, x, y, t, type) = constraint;
+					layer.constraints.emplace_back(x, TimeRange(t, t + 1));
 				}
-				break;
-			case  constraint_type::EDGE:
-				assert(curr->constraints.size() == 1);
-				if (a == agent)
-					insert2CT(x, y, t, t + 1);
-				break;
-			case constraint_type::BARRIER:
+			}
+			break;
+		case  constraint_type::EDGE:
+			assert(node.constraints.size() == 1);
+			if (a == agent)
+				layer.constraints.emplace_back(getEdgeIndex(x, y), TimeRange(t, t + 1));
+			break;
+		case constraint_type::BARRIER:
                 if (a == agent)
                 {
-                    for (auto constraint : curr->constraints)
+                    for (auto constraint : node.constraints)
                     {
                         tie(a, x, y, t, type) = constraint;
                         auto states = decodeBarrier(x, y, t);
                         for (const auto& state : states)
                         {
-                            insert2CT(state.first, state.second, state.second + 1);
+                            layer.constraints.emplace_back(state.first, TimeRange(state.second, state.second + 1));
                         }
 
                     }
                 }
-				break;
-			case constraint_type::RANGE:
+			break;
+		case constraint_type::RANGE:
                 if (a == agent)
                 {
-                    assert(curr->constraints.size() == 1);
-                    insert2CT(x, y, t + 1); // the agent cannot stay at x from timestep y to timestep t.
+                    assert(node.constraints.size() == 1);
+                    layer.constraints.emplace_back(x, TimeRange(y, t + 1)); // the agent cannot stay at x from timestep y to timestep t.
                 }
-				break;
-		}
-		curr = curr->parent;
-	}
-	if (latest_timestep < length_min)
-		latest_timestep = length_min;
-	if (length_max < MAX_TIMESTEP && latest_timestep < length_max)
-		latest_timestep = length_max;
-}
-
-
-// build the conflict avoidance table
-void ConstraintTable::buildCAT(int agent, const vector<Path*>& paths, size_t cat_size)
-{
-	cat_size = std::max(cat_size, (size_t)latest_timestep);
-	cat.resize(cat_size, vector<bool>(map_size, false));
-	for (size_t ag = 0; ag < paths.size(); ag++)
-	{
-		if (ag == agent || paths[ag] == nullptr)
-			continue;
-		for (size_t timestep = 0; timestep < paths[ag]->size(); timestep++)
-		{
-			cat[timestep][paths[ag]->at(timestep).location] = true;
-		}
-		int goal = paths[ag]->back().location;
-		for (size_t timestep = paths[ag]->size(); timestep < cat_size; timestep++)
-			cat[timestep][goal] = true;
+			break;
+		case constraint_type::CONSTRAINT_COUNT: // not a constraint type
+			assert(false);
+			break;
 	}
 }
 
-int ConstraintTable::getNumOfConflictsForStep(size_t curr_id, size_t next_id, int next_timestep) const
-{
-	if (next_timestep >= (int)cat.size())
-	{
-		if (cat.back()[next_id])
-			return 1;
-		else
-			return 0;
-	}
-	if (cat[next_timestep][next_id] ||
-		(curr_id != next_id && cat[next_timestep - 1][next_id] && cat[next_timestep][curr_id]))
-		return 1;
-	else
-		return 0;
-}
-
-
-
-
 // return the earliest timestep that the agent can hold its goal location
 int ConstraintTable::getHoldingTime() const
 {
@@ -255,16 +286,13 @@ int ConstraintTable::getHoldingTime() const
             rst--;
     }
 
-	auto it = ct.find(goal_location);
-	if (it != ct.end())
-	{
-		for (auto time_range : it->second)
-			rst = max(rst, time_range.second);
-	}
-	for (auto landmark : landmarks)
+	auto range = findRanges(ct_ranges, goal_location);
+	for (auto it = range.first; it != range.second; ++it)
+		rst = max(rst, it->second.second);
+	for (int t = 0; t < (int)landmarks.size(); t++)
 	{
-		if (landmark.second != goal_location)
-			rst = max(rst, (int)landmark.first + 1);
+		if (landmarks[t] >= 0 && landmarks[t] != goal_location)
+			rst = max(rst, t + 1);
 	}
 	return rst;
 }
@@ -4,7 +4,7 @@
 #include "SpaceTimeAStar.h"
 #include "SIPP.h"
 
-shared_ptr<Conflict> CorridorReasoning::run(const shared_ptr<Conflict>& conflict,
+ConflictPtr CorridorReasoning::run(const ConflictPtr& conflict,
 	const vector<Path*>& paths, const HLNode& node)
 {
 	clock_t t = clock();
@@ -13,28 +13,28 @@ shared_ptr<Conflict> CorridorReasoning::run(const shared_ptr<Conflict>& conflict
 	return corridor;
 }
 
-int CorridorReasoning::findCorridor(const shared_ptr<Conflict>& conflict,
+int CorridorReasoning::findCorridor(const ConflictPtr& conflict,
 	const vector<Path*>& paths, int endpoints[], int endpoints_time[]) // return the length of the corridor 
 {
 	if (paths[conflict->a1]->size() <= 1 || paths[conflict->a2]->size() <= 1)
 		return 0;
 	assert(conflict->constraint1.size() == 1);
+	const auto& instance = search_engines[0]->instance;
 	int  agent, loc1, loc2, t;
 	constraint_type type;
 	tie(agent, loc2, loc1, t, type) = conflict->constraint1.back();
 	if (t < 1)
 		return 0;
 	if (loc1 < 0) // vertex conflcit
-	{
-		if (search_engines[0]->instance.getDegree(loc2) != 2)
-			return 0; // not a corridor 
 		loc1 = loc2;
-	}
-	else // edge conflict
-	{
-		if (search_engines[0]->instance.getDegree(loc1) != 2 && search_engines[0]->instance.getDegree(loc2) != 2)
-			return 0; // not a corridor 	
-	}
+	int id = instance.getCorridorId(loc2);
+	if (id < 0)
+		id = instance.getCorridorId(loc1);
+	if (id < 0)
+		return 0; // not a corridor
+	const auto& corridor = instance.getCorridor(id);
+	if (corridor.endpoints[0] < 0 || corridor.endpoints[0] == corridor.endpoints[1])
+		return 0; // a ring or a loop, where the direction of the agents is ambiguous
 
 	endpoints_time[0] = getExitingTime(*paths[conflict->a1], t); ; // the first timestep when agent 1 exits the corridor 
 	endpoints_time[1] = getExitingTime(*paths[conflict->a2], t); ; // the first timestep when agent 2 exits the corridor 
@@ -42,45 +42,29 @@ int CorridorReasoning::findCorridor(const shared_ptr<Conflict>& conflict,
 	endpoints[1] = paths[conflict->a2]->at(endpoints_time[1]).location; // the exit location for agent 2
 	if (endpoints[0] == endpoints[1]) // agents exit the corridor in the same direction
 		return 0;
-	// count the distance between the two endpoints, and
-	// check whether the corridor between the two exit locations traverse the conflict location, 
-	// which indicates whether the two agents come in different directions
-	int prev = endpoints[0];
-	int curr = paths[conflict->a1]->at(endpoints_time[0] - 1).location;
-	bool traverseTheConflictingLocation = false;
-	int corridor_length = 1;
-	while (curr != endpoints[1])
+	// the positions of the exit locations along the corridor, where the endpoints are at -1 and cells.size(),
+	// and the conflicting location has to lie between them, which indicates that the two agents come in different directions
+	int positions[2];
+	for (int i = 0; i < 2; i++)
 	{
-		if (curr == loc2)
-			traverseTheConflictingLocation = true;
-		auto neighbors = search_engines[0]->instance.getNeighbors(curr);
-		if (neighbors.size() == 2) // inside the corridor
-		{
-			if (neighbors.front() == prev)
-			{
-				prev = curr;
-				curr = neighbors.back();
-			}
-			else
-			{
-				assert(neighbors.back() == prev);
-				prev = curr;
-				curr = neighbors.front();
-			}
-		}
-		else // exit the corridor without hitting endpoint2
-		{ // indicating that the two agents mvoe in the same direction
+		if (endpoints[i] == corridor.endpoints[0])
+			positions[i] = -1;
+		else if (endpoints[i] == corridor.endpoints[1])
+			positions[i] = (int)corridor.cells.size();
+		else if (instance.getCorridorId(endpoints[i]) == id) // the agent stays at its goal location in the corridor
+			positions[i] = instance.getCorridorIndex(endpoints[i]);
+		else
 			return 0;
-		}
-		corridor_length++;
 	}
-
-	if (!traverseTheConflictingLocation)
+	int conflict_position = instance.getCorridorIndex(loc2);
+	if (instance.getCorridorId(loc2) != id ||
+		conflict_position <= min(positions[0], positions[1]) || conflict_position >= max(positions[0], positions[1]))
 		return 0;
+	int corridor_length = abs(positions[0] - positions[1]);
 	// When k=2, it might just be a corner cell, which we do not want to recognize as a corridor
 	if (corridor_length == 2 &&
-		search_engines[0]->instance.getColCoordinate(endpoints[0]) != search_engines[0]->instance.getColCoordinate(endpoints[1]) &&
-		search_engines[0]->instance.getRowCoordinate(endpoints[0]) != search_engines[0]->instance.getRowCoordinate(endpoints[1]))
+		instance.getColCoordinate(endpoints[0]) != instance.getColCoordinate(endpoints[1]) &&
+		instance.getRowCoordinate(endpoints[0]) != instance.getRowCoordinate(endpoints[1]))
 	{
 		return 0;
 	}
@@ -88,21 +72,22 @@ int CorridorReasoning::findCorridor(const shared_ptr<Conflict>& conflict,
 }
 
 
-shared_ptr<Conflict> CorridorReasoning::findCorridorConflict(const shared_ptr<Conflict>& conflict,
+ConflictPtr CorridorReasoning::findCorridorConflict(const ConflictPtr& conflict,
 	const vector<Path*>& paths, const HLNode& node)
 {
 	int a[2] = { conflict->a1, conflict->a2 };
 	int  agent, loc1, loc2, timestep;
 	constraint_type type;
 	tie(agent, loc1, loc2, timestep, type) = conflict->constraint1.back();
+	const auto& instance = search_engines[0]->instance;
 	int curr = -1;
-	if (search_engines[0]->instance.getDegree(loc1) == 2)
+	if (instance.getCorridorId(loc1) >= 0)
 	{
 		curr = loc1;
 		if (loc2 >= 0)
 			timestep--;
 	}
-	else if (loc2 >= 0 && search_engines[0]->instance.getDegree(loc2) == 2)
+	else if (loc2 >= 0 && instance.getCorridorId(loc2) >= 0)
 		curr = loc2;
 	if (curr <= 0)
 		return nullptr;
@@ -132,26 +117,50 @@ shared_ptr<Conflict> CorridorReasoning::findCorridorConflict(const shared_ptr<Co
 			return nullptr;
 	}
 	pair<int, int> edge; // one edge in the corridor
-	int corridor_length = getCorridorLength(*paths[a[0]], t[0], u[1], edge);
+	int corridor_length;
+	int id = instance.getCorridorId(curr);
+	const auto& corridor = instance.getCorridor(id);
+	bool between_endpoints = corridor.endpoints[0] >= 0 && corridor.endpoints[0] != corridor.endpoints[1] &&
+		((u[0] == corridor.endpoints[0] && u[1] == corridor.endpoints[1]) ||
+		 (u[0] == corridor.endpoints[1] && u[1] == corridor.endpoints[0]));
+	if (between_endpoints) // the agents traverse the whole corridor
+	{
+		corridor_length = corridor.getLength();
+		edge = make_pair(u[0], (u[0] == corridor.endpoints[0]) ? corridor.cells.front() : corridor.cells.back());
+	}
+	else
+		corridor_length = getCorridorLength(*paths[a[0]], t[0], u[1], edge);
 	int t3, t3_, t4, t4_;
 	ConstraintTable ct1(initial_constraints[conflict->a1]);
 	ct1.build(node, conflict->a1);
 	t3 = search_engines[conflict->a1]->getTravelTime(paths[conflict->a1]->front().location, u[1], ct1, MAX_TIMESTEP);
-	ct1.insert2CT(edge.first, edge.second, 0, MAX_TIMESTEP); // block the corridor in both directions
-	ct1.insert2CT(edge.second, edge.first, 0, MAX_TIMESTEP);
-	t3_ = search_engines[conflict->a1]->getTravelTime(paths[conflict->a1]->front().location, u[1], ct1, t3 + 2 * corridor_length + 1);
+	int upper_bound = t3 + 2 * corridor_length + 1;
+	if (between_endpoints && getBypassLowerBound(*paths[conflict->a1], id, u[1]) >= upper_bound)
+		t3_ = MAX_TIMESTEP; // the search below cannot find a path within the upper bound
+	else
+	{
+		ct1.insert2CT(edge.first, edge.second, 0, MAX_TIMESTEP); // block the corridor in both directions
+		ct1.insert2CT(edge.second, edge.first, 0, MAX_TIMESTEP);
+		t3_ = search_engines[conflict->a1]->getTravelTime(paths[conflict->a1]->front().location, u[1], ct1, upper_bound);
+	}
 	ConstraintTable ct2(initial_constraints[conflict->a2]);
 	ct2.build(node, conflict->a2);
 	t4 = search_engines[conflict->a2]->getTravelTime(paths[conflict->a2]->front().location, u[0], ct2, MAX_TIMESTEP);
-	ct2.insert2CT(edge.first, edge.second, 0, MAX_TIMESTEP); // block the corridor in both directions
-	ct2.insert2CT(edge.second, edge.first, 0, MAX_TIMESTEP);
-	t4_ = search_engines[conflict->a2]->getTravelTime(paths[conflict->a2]->front().location, u[0], ct2, t3 + corridor_length + 1);
+	upper_bound = t3 + corridor_length + 1;
+	if (between_endpoints && getBypassLowerBound(*paths[conflict->a2], id, u[0]) >= upper_bound)
+		t4_ = MAX_TIMESTEP;
+	else
+	{
+		ct2.insert2CT(edge.first, edge.second, 0, MAX_TIMESTEP); // block the corridor in both directions
+		ct2.insert2CT(edge.second, edge.first, 0, MAX_TIMESTEP);
+		t4_ = search_engines[conflict->a2]->getTravelTime(paths[conflict->a2]->front().location, u[0], ct2, upper_bound);
+	}
 
     if (abs(t3 - t4) <= corridor_length && t3_ > t3 && t4_ > t4)
     {
 		int t1 = std::min(t3_ - 1, t4 + corridor_length);
 		int t2 = std::min(t4_ - 1, t3 + corridor_length);
-        shared_ptr<Conflict> corridor = make_shared<Conflict>();
+        ConflictPtr corridor = ConflictPtr(new Conflict());
         corridor->corridorConflict(conflict->a1, conflict->a2, u[1], u[0], t1, t2);
 		if (blocked(*paths[corridor->a1], corridor->constraint1.front()) &&
 			blocked(*paths[corridor->a2], corridor->constraint2.front()))
@@ -167,7 +176,7 @@ int CorridorReasoning::getExitingTime(const std::vector<PathEntry>& path, int t)
 		t = (int)path.size() - 1;
 	int loc = path[t].location;
 	while (loc != path.back().location &&
-		search_engines[0]->instance.getDegree(loc) == 2)
+		search_engines[0]->instance.getCorridorId(loc) >= 0)
 	{
 		t++;
 		loc = path[t].location;
@@ -182,7 +191,7 @@ int CorridorReasoning::getEnteringTime(const vector<PathEntry>& path, const vect
 		t = (int)path.size() - 1;
 	int loc = path[t].location;
 	while (loc != path.front().location && loc != path2.back().location &&
-		search_engines[0]->instance.getDegree(loc) == 2)
+		search_engines[0]->instance.getCorridorId(loc) >= 0)
 	{
 		t--;
 		loc = path[t].location;
@@ -227,6 +236,28 @@ int CorridorReasoning::getCorridorLength(const vector<PathEntry>& path, int t_st
 }
 
 
+// A lower bound on the distance from the start location of the path to an endpoint of the corridor without entering the corridor.
+// If the path reaches the other endpoint at timestep t before entering the corridor, then the bound is the bypass length minus t
+// by the triangle inequality.
+int CorridorReasoning::getBypassLowerBound(const Path& path, int id, int endpoint) const
+{
+	const auto& instance = search_engines[0]->instance;
+	const auto& corridor = instance.getCorridor(id);
+	int other = (endpoint == corridor.endpoints[0]) ? corridor.endpoints[1] : corridor.endpoints[0];
+	for (int t = 0; t < (int)path.size(); t++)
+	{
+		if (path[t].location == other)
+		{
+			int bypass = instance.getBypassLength(id);
+			return (bypass == MAX_TIMESTEP) ? MAX_TIMESTEP : bypass - t;
+		}
+		if (instance.getCorridorId(path[t].location) == id)
+			break;
+	}
+	return 0;
+}
+
+
 /*int getBypassLength(int start, int end, std::pair<int, int> blocked, const bool* my_map, int num_col, int map_size)
 {
 	int length = INT_MAX;
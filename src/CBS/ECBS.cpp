@@ -14,7 +14,7 @@ bool ECBS::solve(double time_limit, int _cost_lowerbound)
 		cout << name << ": ";
 	}
 	// set timer
-	start = clock();
+	start = steady_clock::now();
 
     if(!generateRoot())
         return false;
@@ -29,17 +29,18 @@ bool ECBS::solve(double time_limit, int _cost_lowerbound)
             return solution_found;
         }
 
-		if ((curr == dummy_start || curr->chosen_from == "cleanup") &&
+		if ((curr == dummy_start || curr->chosen_from == node_list::CLEANUP) &&
 		     !curr->h_computed) // heuristics has not been computed yet
 		{
-            runtime = (double)(clock() - start) / CLOCKS_PER_SEC;
+            runtime = getElapsedTime(start);
             bool succ = heuristic_helper.computeInformedHeuristics(*curr, min_f_vals, time_limit - runtime);
-            runtime = (double)(clock() - start) / CLOCKS_PER_SEC;
+            runtime = getElapsedTime(start);
             if (!succ) // no solution, so prune this node
             {
                 if (screen > 1)
                     cout << "	Prune " << *curr << endl;
                 curr->clear();
+                updateMemoryUsage(*curr);
                 continue;
             }
 
@@ -52,7 +53,7 @@ bool ECBS::solve(double time_limit, int _cost_lowerbound)
 		//Expand the node
 		num_HL_expanded++;
 		curr->time_expanded = num_HL_expanded;
-		if (bypass && curr->chosen_from != "cleanup")
+		if (bypass && curr->chosen_from != node_list::CLEANUP)
 		{
 			bool foundBypass = true;
 			while (foundBypass)
@@ -71,22 +72,22 @@ bool ECBS::solve(double time_limit, int _cost_lowerbound)
 					cout << "	Expand " << *curr << endl << 	"	on " << *(curr->conflict) << endl;
 
 				bool solved[2] = { false, false };
-				vector<vector<PathEntry>*> path_copy(paths);
-				vector<int> fmin_copy(min_f_vals);
+				if (thread_pool != nullptr) // generate the second child on a worker thread
+					generateChildren(child, curr, solved);
 				for (int i = 0; i < 2; i++)
 				{
-					if (i > 0)
-					{
-						paths = path_copy;
-						min_f_vals = fmin_copy;
-					}
-					solved[i] = generateChild(child[i], curr);
+					if (thread_pool == nullptr)
+						solved[i] = generateChild(child[i], curr, workspaces[i]);
+					collectStats(workspaces[i]);
 					if (!solved[i])
 					{
+						syncWorkspace(workspaces[i]);
 						delete (child[i]);
+						child[i] = nullptr;
 						continue;
 					}
-					else if (i == 1 && !solved[0])
+					heuristic_helper.computeQuickHeuristics(*child[i]);
+					if (i == 1 && !solved[0])
 						continue;
 					else if (bypass &&
 						child[i]->sum_of_costs <= suboptimality * cost_lowerbound &&
@@ -100,7 +101,7 @@ bool ECBS::solve(double time_limit, int _cost_lowerbound)
                                 foundBypass = false;
                                 break;
                             }*/
-							if ((double)path.second.first.size() - 1 > suboptimality * fmin_copy[path.first]) // Our bypassing
+							if ((double)path.second.first.size() - 1 > suboptimality * min_f_vals[path.first]) // Our bypassing
 							{
 								foundBypass = false;
 								break;
@@ -108,7 +109,7 @@ bool ECBS::solve(double time_limit, int _cost_lowerbound)
 						}
 						if (foundBypass)
 						{
-							adoptBypass(curr, child[i], fmin_copy);
+							adoptBypass(curr, child[i]);
 							if (screen > 1)
 								cout << "	Update " << *curr << endl;
 							break;
@@ -117,9 +118,13 @@ bool ECBS::solve(double time_limit, int _cost_lowerbound)
 				}
 				if (foundBypass)
 				{
-					for (auto & i : child)
+					for (int i = 0; i < 2; i++)
 					{
-						delete i;
+						collectStats(workspaces[i]);
+						if (child[i] == nullptr)
+							continue;
+						syncWorkspace(workspaces[i]);
+						delete child[i];
 					}
                     classifyConflicts(*curr); // classify the new-detected conflicts
 				}
@@ -150,21 +155,20 @@ bool ECBS::solve(double time_limit, int _cost_lowerbound)
 				cout << "	Expand " << *curr << endl << "	on " << *(curr->conflict) << endl;
 
 			bool solved[2] = { false, false };
-			vector<vector<PathEntry>*> path_copy(paths);
-			vector<int> fmin_copy(min_f_vals);
+			if (thread_pool != nullptr) // generate the second child on a worker thread
+				generateChildren(child, curr, solved);
 			for (int i = 0; i < 2; i++)
 			{
-				if (i > 0)
-				{
-					paths = path_copy;
-					min_f_vals = fmin_copy;
-				}
-				solved[i] = generateChild(child[i], curr);
+				if (thread_pool == nullptr)
+					solved[i] = generateChild(child[i], curr, workspaces[i]);
+				collectStats(workspaces[i]);
 				if (!solved[i])
 				{
+					syncWorkspace(workspaces[i]);
 					delete (child[i]);
 					continue;
 				}
+				heuristic_helper.computeQuickHeuristics(*child[i]);
 				pushNode(child[i]);
 				curr->children.push_back(child[i]);
 				if (screen > 1)
@@ -191,23 +195,26 @@ bool ECBS::solve(double time_limit, int _cost_lowerbound)
 		default:
 			break;
 		}
-		if (curr->chosen_from == "cleanup")
+		if (curr->chosen_from == node_list::CLEANUP)
 			num_cleanup++;
-		else if (curr->chosen_from == "open")
+		else if (curr->chosen_from == node_list::OPEN)
 			num_open++;
-		else if (curr->chosen_from == "focal")
+		else if (curr->chosen_from == node_list::FOCAL)
 			num_focal++;
 		if (curr->conflict->priority == conflict_priority::CARDINAL)
 			num_cardinal_conflicts++;
         if (!curr->children.empty())
             heuristic_helper.updateOnlineHeuristicErrors(*curr); // update online heuristic errors
 		curr->clear();
+		updateMemoryUsage(*curr);
+		if (memory_limit > 0 && ct_memory > max(memory_limit, next_eviction))
+			evictNodes();
 	}  // end of while loop
 
 	return solution_found;
 }
 
-void ECBS::adoptBypass(ECBSNode* curr, ECBSNode* child, const vector<int>& fmin_copy)
+void ECBS::adoptBypass(ECBSNode* curr, ECBSNode* child)
 {
 	num_adopt_bypass++;
 	curr->sum_of_costs = child->sum_of_costs;
@@ -226,6 +233,8 @@ void ECBS::adoptBypass(ECBSNode* curr, ECBSNode* child, const vector<int>& fmin_
 			{
 				p->second.first = path.second.first;
 				paths[p->first] = &p->second.first;
+				conflict_avoidance_table.updatePath(p->first, paths[p->first]);
+				resetWorkspaces(p->first);
                 min_f_vals[p->first] = p->second.second;
 				break;
 			}
@@ -234,9 +243,9 @@ void ECBS::adoptBypass(ECBSNode* curr, ECBSNode* child, const vector<int>& fmin_
 		if (p == curr->paths.end())
 		{
 			curr->paths.emplace_back(path);
-			curr->paths.back().second.second = fmin_copy[path.first];
+			curr->paths.back().second.second = min_f_vals[path.first];
 			paths[path.first] = &curr->paths.back().second.first;
-			min_f_vals[path.first] = fmin_copy[path.first];
+			conflict_avoidance_table.updatePath(path.first, paths[path.first]);
 		}
 	}
 }
@@ -266,6 +275,7 @@ void ECBS::updatePaths(ECBSNode* curr)
 		}
 		curr = curr->parent;
 	}
+	conflict_avoidance_table.updatePaths(paths);
 }
 
 
@@ -275,6 +285,8 @@ bool ECBS::generateRoot()
 	root->g_val = 0;
 	root->sum_of_costs = 0;
 	paths.resize(num_of_agents, nullptr);
+	conflict_avoidance_table.init(search_engines[0]->instance.map_size, num_of_agents);
+	initWorkspaces();
 	min_f_vals.resize(num_of_agents);
 	mdd_helper.init(num_of_agents);
 	heuristic_helper.init();
@@ -285,21 +297,45 @@ bool ECBS::generateRoot()
 	//generate random permuattion of agent indices
 	auto agents = shuffleAgents();
 
-	for (auto i : agents)
+	bool parallel = thread_pool != nullptr && parallel_root;
+	if (parallel)
 	{
-		paths_found_initially[i] = search_engines[i]->findSuboptimalPath(*root, initial_constraints[i], paths, i, 0, suboptimality);
-		if (paths_found_initially[i].first.empty())
+		bool succ = planInParallel(agents, [&](int i, CBSNode& node, CTNodeWorkspace& workspace)
 		{
-			cout << "No path exists for agent " << i << endl;
+			paths_found_initially[i] = search_engines[i]->findSuboptimalPath(node, initial_constraints[i], workspace.conflict_avoidance_table, i, 0, suboptimality);
+			workspace.num_LL_expanded += search_engines[i]->num_expanded;
+			workspace.num_LL_generated += search_engines[i]->num_generated;
+			if (paths_found_initially[i].first.empty())
+			{
+				cout << "No path exists for agent " << i << endl;
+				return false;
+			}
+			workspace.conflict_avoidance_table.updatePath(i, &paths_found_initially[i].first);
+			node.makespan = max(node.makespan, paths_found_initially[i].first.size() - 1);
+			return true;
+		});
+		if (!succ)
 			return false;
+	}
+	for (auto i : agents)
+	{
+		if (!parallel)
+		{
+			paths_found_initially[i] = search_engines[i]->findSuboptimalPath(*root, initial_constraints[i], conflict_avoidance_table, i, 0, suboptimality);
+			if (paths_found_initially[i].first.empty())
+			{
+				cout << "No path exists for agent " << i << endl;
+				return false;
+			}
+			num_LL_expanded += search_engines[i]->num_expanded;
+			num_LL_generated += search_engines[i]->num_generated;
 		}
 		paths[i] = &paths_found_initially[i].first;
+		conflict_avoidance_table.updatePath(i, paths[i]);
 		min_f_vals[i] = paths_found_initially[i].second;
 		root->makespan = max(root->makespan, paths[i]->size() - 1);
 		root->g_val += min_f_vals[i];
 		root->sum_of_costs += (int)paths[i]->size() - 1;
-		num_LL_expanded += search_engines[i]->num_expanded;
-		num_LL_generated += search_engines[i]->num_generated;
 	}
 
 	root->h_val = 0;
@@ -316,9 +352,12 @@ bool ECBS::generateRoot()
 }
 
 
-bool ECBS::generateChild(ECBSNode*  node, ECBSNode* parent)
+// See CBS::generateChild
+bool ECBS::generateChild(ECBSNode*  node, ECBSNode* parent, CTNodeWorkspace& workspace)
 {
 	clock_t t1 = clock();
+	syncWorkspace(workspace);
+	workspace.min_f_vals = min_f_vals;
 	node->parent = parent;
 	node->HLNode::parent = parent;
 	node->g_val = parent->g_val;
@@ -329,31 +368,49 @@ bool ECBS::generateChild(ECBSNode*  node, ECBSNode* parent)
 	assert(!agents.empty());
 	for (auto agent : agents)
 	{
-		if (!findPathForSingleAgent(node, agent))
+		if (!findPathForSingleAgent(node, agent, workspace))
 		{
             if (screen > 1)
                 cout << "	No paths for agent " << agent << ". Node pruned." << endl;
-			runtime_generate_child += (double)(clock() - t1) / CLOCKS_PER_SEC;
+			workspace.runtime_generate_child += (double)(clock() - t1) / CLOCKS_PER_SEC;
 			return false;
 		}
 	}
 
-	findConflicts(*node);
-	heuristic_helper.computeQuickHeuristics(*node);
-	runtime_generate_child += (double)(clock() - t1) / CLOCKS_PER_SEC;
+	clock_t t2 = clock();
+	findConflicts(*node, workspace.paths, workspace.conflict_avoidance_table);
+	workspace.runtime_detect_conflicts += (double)(clock() - t2) / CLOCKS_PER_SEC;
+	workspace.runtime_generate_child += (double)(clock() - t1) / CLOCKS_PER_SEC;
 	return true;
 }
 
+// See CBS::generateChildren
+void ECBS::generateChildren(ECBSNode* child[2], ECBSNode* curr, bool solved[2])
+{
+	if (!replanDisjointAgents(*child[0], *child[1]))
+	{
+		for (int i = 0; i < 2; i++)
+			solved[i] = generateChild(child[i], curr, workspaces[i]);
+		return;
+	}
+	auto task = thread_pool->submit([&]() { solved[1] = generateChild(child[1], curr, workspaces[1]); });
+	solved[0] = generateChild(child[0], curr, workspaces[0]);
+	task.get();
+}
+
 
-bool ECBS::findPathForSingleAgent(ECBSNode*  node, int ag)
+bool ECBS::findPathForSingleAgent(ECBSNode*  node, int ag, CTNodeWorkspace& workspace)
 {
 	clock_t t = clock();
-	auto new_path = search_engines[ag]->findSuboptimalPath(*node, initial_constraints[ag], paths, ag, min_f_vals[ag], suboptimality);
-	num_LL_expanded += search_engines[ag]->num_expanded;
-	num_LL_generated += search_engines[ag]->num_generated;
-	runtime_build_CT += search_engines[ag]->runtime_build_CT;
-	runtime_build_CAT += search_engines[ag]->runtime_build_CAT;
-	runtime_path_finding += (double)(clock() - t) / CLOCKS_PER_SEC;
+	auto& paths = workspace.paths;
+	auto& min_f_vals = workspace.min_f_vals;
+	initial_constraints[ag].cacheLayer(*node, ag); // only this thread writes to the child
+	auto new_path = search_engines[ag]->findSuboptimalPath(*node, initial_constraints[ag], workspace.conflict_avoidance_table, ag, min_f_vals[ag], suboptimality);
+	workspace.num_LL_expanded += search_engines[ag]->num_expanded;
+	workspace.num_LL_generated += search_engines[ag]->num_generated;
+	workspace.runtime_build_CT += search_engines[ag]->runtime_build_CT;
+	workspace.runtime_build_CAT += search_engines[ag]->runtime_build_CAT;
+	workspace.runtime_path_finding += (double)(clock() - t) / CLOCKS_PER_SEC;
 	if (new_path.first.empty())
 		return false;
 	assert(!isSamePath(*paths[ag], new_path.first));
@@ -361,6 +418,7 @@ bool ECBS::findPathForSingleAgent(ECBSNode*  node, int ag)
 	node->g_val = node->g_val - min_f_vals[ag] + new_path.second;
 	node->sum_of_costs = node->sum_of_costs - (int) paths[ag]->size() + (int) new_path.first.size();
 	paths[ag] = &node->paths.back().second.first;
+	workspace.conflict_avoidance_table.updatePath(ag, paths[ag]);
 	min_f_vals[ag] = new_path.second;
 	node->makespan = max(node->makespan, new_path.first.size() - 1);
 	return true;
@@ -376,9 +434,9 @@ inline void ECBS::pushNode(ECBSNode* node)
 	switch (solver_type)
 	{
 	case high_level_solver_type::ASTAREPS:  // cleanup_list is called open_list in ECBS
-        if (node->sum_of_costs <= suboptimality * cost_lowerbound)
-            node->focal_handle = focal_list.push(node);
-            break;
+		if (node->sum_of_costs <= suboptimality * cost_lowerbound)
+			node->focal_handle = focal_list.push(node);
+		break;
 	case high_level_solver_type::NEW:
 		if (node->getFHatVal() <= suboptimality * cost_lowerbound)
 			node->focal_handle = focal_list.push(node);
@@ -392,6 +450,7 @@ inline void ECBS::pushNode(ECBSNode* node)
 		break;
 	}
 	allNodes_table.push_back(node);
+	updateMemoryUsage(*node);
 }
 
 
@@ -427,6 +486,24 @@ inline bool ECBS::reinsertNode(ECBSNode* node)
 }
 
 
+// check whether node still meets the condition of the list it has been selected from
+bool ECBS::isSelectable(const ECBSNode* node) const
+{
+	switch (node->chosen_from)
+	{
+	case node_list::FOCAL:
+		if (solver_type == high_level_solver_type::NEW)
+			return node->getFHatVal() <= suboptimality * cost_lowerbound;
+		return node->sum_of_costs <= suboptimality * cost_lowerbound;
+	case node_list::OPEN:
+		return node->sum_of_costs <= suboptimality * cost_lowerbound;
+	case node_list::CLEANUP:
+		return cleanup_list.empty() || node->getFVal() <= cleanup_list.top()->getFVal();
+	default:
+		return true;
+	}
+}
+
 ECBSNode* ECBS::selectNode()
 {
 	ECBSNode* curr = nullptr;
@@ -454,7 +531,7 @@ ECBSNode* ECBS::selectNode()
 		if (focal_list.top()->sum_of_costs <= suboptimality * cost_lowerbound)
 		{ // return best d
 			curr = focal_list.top();
-			curr->chosen_from = "focal";
+			curr->chosen_from = node_list::FOCAL;
 			/*curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
 			curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
 			curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;
@@ -471,7 +548,7 @@ ECBSNode* ECBS::selectNode()
 		else if (open_list.top()->sum_of_costs <= suboptimality * cost_lowerbound)
 		{ // return best f_hat
 			curr = open_list.top();
-			curr->chosen_from = "open";
+			curr->chosen_from = node_list::OPEN;
 			/*curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
 			curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
 			curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;
@@ -488,7 +565,7 @@ ECBSNode* ECBS::selectNode()
 		else
 		{ // return best f
 			curr = cleanup_list.top();
-			curr->chosen_from = "cleanup";
+			curr->chosen_from = node_list::CLEANUP;
 			/*curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
 			curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
 			curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;
@@ -528,7 +605,7 @@ ECBSNode* ECBS::selectNode()
 
 		// choose best d in the focal list
 		curr = focal_list.top();
-		curr->chosen_from = "focal";
+		curr->chosen_from = node_list::FOCAL;
 		/*curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
 		curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
 		curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;
@@ -565,7 +642,7 @@ ECBSNode* ECBS::selectNode()
 		if (focal_list.empty()) // choose best f in the cleanup list (to improve the lower bound)
 		{
 			curr = cleanup_list.top();
-			curr->chosen_from = "cleanup";
+			curr->chosen_from = node_list::CLEANUP;
 			/*curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
 			curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
 			curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;*/
@@ -574,7 +651,7 @@ ECBSNode* ECBS::selectNode()
 		else // choose best d in the focal list
 		{
 			curr = focal_list.top();
-			curr->chosen_from = "focal";
+			curr->chosen_from = node_list::FOCAL;
 			/*curr->f_of_best_in_cleanup = cleanup_list.top()->getFVal();
 			curr->f_hat_of_best_in_cleanup = cleanup_list.top()->getFHatVal();
 			curr->d_of_best_in_cleanup = cleanup_list.top()->distance_to_go;
@@ -589,6 +666,17 @@ ECBSNode* ECBS::selectNode()
 		break;
 	}
 
+	if (curr->evicted)
+	{
+		int old_f_val = curr->getFVal();
+		int old_sum_of_costs = curr->sum_of_costs;
+		regenerateNode(curr);
+		// the regenerated paths can be longer than the evicted ones, so curr may no longer meet the condition it was selected by
+		if ((curr->getFVal() > old_f_val || curr->sum_of_costs > old_sum_of_costs) &&
+			!isSelectable(curr) && reinsertNode(curr))
+			return selectNode();
+	}
+
 	// takes the paths_found_initially and UPDATE all constrained paths found for agents from curr to dummy_start (and lower-bounds)
 	updatePaths(curr);
 
@@ -615,16 +703,14 @@ void ECBS::classifyConflicts(ECBSNode &node)
     if (node.unknownConf.empty())
         return;
 	// Classify all conflicts in unknownConf
-	while (!node.unknownConf.empty())
+	for (auto& con : node.unknownConf)
 	{
-		shared_ptr<Conflict> con = node.unknownConf.front();
 		int a1 = con->a1, a2 = con->a2;
 		int timestep = get<3>(con->constraint1.back());
 		constraint_type type = get<4>(con->constraint1.back());
-		node.unknownConf.pop_front();
 
 		if (PC)
-		    if (node.chosen_from == "cleanup" ||
+		    if (node.chosen_from == node_list::CLEANUP ||
                // (min_f_vals[a1] * suboptimality >= min_f_vals[a1] + 1 &&
                //min_f_vals[a2] * suboptimality >= min_f_vals[a2] + 1))
                (int)paths[a1]->size() - 1 == min_f_vals[a1] ||
@@ -687,7 +773,7 @@ void ECBS::classifyConflicts(ECBSNode &node)
 		{
 			auto mdd1 = mdd_helper.getMDD(node, a1, paths[a1]->size());
 			auto mdd2 = mdd_helper.getMDD(node, a2, paths[a2]->size());
-			auto rectangle = rectangle_helper.run(paths, timestep, a1, a2, mdd1, mdd2);
+			auto rectangle = rectangle_helper.run(paths, timestep, a1, a2, mdd1, mdd2, node);
 			if (rectangle != nullptr)
 			{
                 if (!PC)
@@ -701,13 +787,14 @@ void ECBS::classifyConflicts(ECBSNode &node)
 		computeSecondPriorityForConflict(*con, node);
 		node.conflicts.push_back(con);
 	}
+	node.unknownConf.clear();
 
 	// remove conflicts that cannot be chosen, to save some memory
 	removeLowPriorityConflicts(node.conflicts);
 }
 
 
-void ECBS::computeConflictPriority(shared_ptr<Conflict>& con, ECBSNode& node)
+void ECBS::computeConflictPriority(ConflictPtr& con, ECBSNode& node)
 {
     int a1 = con->a1, a2 = con->a2;
 	int timestep = get<3>(con->constraint1.back());
@@ -780,12 +867,102 @@ void ECBS::releaseNodes()
     for (auto& node : allNodes_table)
         delete node;
     allNodes_table.clear();
+    ct_memory = 0;
+    next_eviction = 0;
+}
+
+// SMA*-style memory bound: the paths and conflicts of the worst unexpanded nodes are dropped
+// until the CT nodes use at most 3/4 of the memory limit.
+// Only unexpanded nodes are evicted, so the paths of the ancestors of any node are always resident.
+void ECBS::evictNodes()
+{
+	vector<ECBSNode*> candidates;
+	for (auto node : cleanup_list)
+	{
+		if (!node->evicted && node != dummy_start)
+			candidates.push_back(node);
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const ECBSNode* n1, const ECBSNode* n2)
+	{
+		if (n1->getFHatVal() == n2->getFHatVal())
+		{
+			if (n1->getFVal() == n2->getFVal())
+				return n1->distance_to_go > n2->distance_to_go;
+			return n1->getFVal() > n2->getFVal();
+		}
+		return n1->getFHatVal() > n2->getFHatVal();
+	}); // worst first
+	for (auto node : candidates)
+	{
+		if (ct_memory <= memory_limit / 4 * 3)
+			break;
+		for (auto& path : node->paths)
+			Path().swap(path.second.first);
+		node->clear();
+		node->evicted = true;
+		updateMemoryUsage(*node);
+		num_evicted_nodes++;
+	}
+	// the expanded nodes cannot be evicted, so wait for the memory usage to grow again before the next pass
+	next_eviction = ct_memory + memory_limit / 4;
+	if (screen > 1)
+		cout << "	Evict " << num_evicted_nodes << " nodes in total, CT memory = " << ct_memory << " bytes" << endl;
 }
 
+// Recompute the paths of the replanned agents of an evicted node from the paths of its parent, and then its conflicts.
+// The low-level search breaks ties randomly, so the paths can differ from the evicted ones.
+void ECBS::regenerateNode(ECBSNode* node)
+{
+	clock_t t = clock();
+	updatePaths(node->parent); // the parent has been expanded, so its paths are resident
+	node->makespan = node->parent->makespan; // as in generateChild, since the low-level search depends on it
+	for (auto& path : node->paths)
+	{
+		int ag = path.first;
+		auto new_path = search_engines[ag]->findSuboptimalPath(*node, initial_constraints[ag], conflict_avoidance_table, ag, min_f_vals[ag], suboptimality);
+		num_LL_expanded += search_engines[ag]->num_expanded;
+		num_LL_generated += search_engines[ag]->num_generated;
+		runtime_build_CT += search_engines[ag]->runtime_build_CT;
+		runtime_build_CAT += search_engines[ag]->runtime_build_CAT;
+		assert(!new_path.first.empty());
+		node->g_val += new_path.second - path.second.second;
+		path.second = new_path;
+		paths[ag] = &path.second.first;
+		conflict_avoidance_table.updatePath(ag, paths[ag]);
+		resetWorkspaces(ag); // the path is stored at the same address as the evicted one
+		min_f_vals[ag] = new_path.second;
+		node->makespan = max(node->makespan, new_path.first.size() - 1);
+	}
+	runtime_path_finding += (double)(clock() - t) / CLOCKS_PER_SEC;
+	node->sum_of_costs = 0;
+	for (int i = 0; i < num_of_agents; i++)
+		node->sum_of_costs += (int)paths[i]->size() - 1;
+
+	// detect all conflicts from scratch, as the conflicts of the parent have been released
+	clock_t t2 = clock();
+	vector<int> conflicting_agents;
+	for (int a1 = 0; a1 < num_of_agents; a1++)
+	{
+		conflict_avoidance_table.getConflictingAgents(a1, conflicting_agents);
+		for (int a2 : conflicting_agents)
+		{
+			if (a1 < a2)
+				findConflicts(*node, a1, a2);
+		}
+	}
+	runtime_detect_conflicts += (double)(clock() - t2) / CLOCKS_PER_SEC;
+	node->updateDistanceToGo();
+	node->evicted = false;
+	num_regenerated_nodes++;
+	updateMemoryUsage(*node);
+}
+
+
 void ECBS::clear()
 {
     mdd_helper.clear();
     heuristic_helper.clear();
+    rectangle_helper.clear();
     releaseNodes();
     paths.clear();
     paths_found_initially.clear();
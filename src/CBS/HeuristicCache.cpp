@@ -0,0 +1,159 @@
+#include "HeuristicCache.h"
+
+static inline uint64_t mix(uint64_t x) // splitmix64
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+size_t HeuristicCache::PairKey::Hasher::operator()(const PairKey& key) const
+{
+	uint64_t rst = mix(((uint64_t)key.a1 << 32) | (uint32_t)key.a2);
+	for (const auto& constraints : key.constraints)
+	{
+		for (const auto& con : constraints)
+		{
+			rst = mix(rst ^ (((uint64_t)get<0>(con) << 32) | (uint32_t)get<1>(con)));
+			rst = mix(rst ^ (((uint64_t)get<2>(con) << 32) | (uint32_t)get<3>(con)) ^ get<4>(con));
+		}
+		rst = mix(rst);
+	}
+	return rst;
+}
+
+bool HeuristicCache::findPair(const PairKey& key, const SingleAgentSolver& solver1, const SingleAgentSolver& solver2,
+	int& h, int& length1, int& length2)
+{
+	auto got = pairs.find(key);
+	if (got == pairs.end())
+	{
+		num_pair_misses++;
+		return false;
+	}
+	const auto& entry = got->second;
+	int cost = entry.h + entry.lengths[0] + entry.lengths[1];
+	for (int i = 0; i < 2; i++)
+	{
+		if (getFingerprint(solver1, solver2, cost, i) != entry.fingerprints[i]) // the region has changed
+		{
+			num_pair_misses++;
+			return false;
+		}
+	}
+	num_pair_hits++;
+	h = entry.h;
+	length1 = entry.lengths[0];
+	length2 = entry.lengths[1];
+	return true;
+}
+
+void HeuristicCache::insertPair(const PairKey& key, const SingleAgentSolver& solver1, const SingleAgentSolver& solver2,
+	int h, int length1, int length2)
+{
+	if (h >= MAX_COST) // the region of an unsolvable sub-problem is unbounded
+		return;
+	PairEntry entry;
+	entry.h = h;
+	entry.lengths[0] = length1;
+	entry.lengths[1] = length2;
+	for (int i = 0; i < 2; i++)
+		entry.fingerprints[i] = getFingerprint(solver1, solver2, h + length1 + length2, i);
+	auto got = pairs.find(key);
+	if (got != pairs.end()) // replace the outdated entry
+	{
+		got->second = entry;
+		return;
+	}
+	if (pairs.size() >= max_num_of_pairs)
+	{
+		pairs.erase(*insertion_order.front());
+		insertion_order.pop();
+	}
+	auto rst = pairs.emplace(key, entry);
+	insertion_order.push(&rst.first->first);
+}
+
+const MDD* HeuristicCache::findMDD(int agent, const SingleAgentSolver& solver)
+{
+	auto got = mdds.find(agent);
+	if (got == mdds.end() ||
+		getFingerprint(solver, (int)got->second.mdd->levels.size() - 1) != got->second.fingerprint)
+	{
+		num_mdd_misses++;
+		return nullptr;
+	}
+	num_mdd_hits++;
+	return got->second.mdd.get();
+}
+
+void HeuristicCache::insertMDD(int agent, const SingleAgentSolver& solver, const MDD& mdd)
+{
+	if (mdd.levels.empty()) // no path
+		return;
+	auto& entry = mdds[agent];
+	entry.mdd.reset(new MDD(mdd));
+	entry.fingerprint = getFingerprint(solver, (int)mdd.levels.size() - 1);
+}
+
+void HeuristicCache::clear()
+{
+	pairs.clear();
+	insertion_order = std::queue<const PairKey*>();
+	mdds.clear();
+}
+
+// a path of agent i no longer than max_length visits location loc only at
+// timesteps [distance from the start to loc, max_length - distance from loc to the goal],
+// and the path table affects it only via vertex, edge and target conflicts at these locations and adjacent timesteps
+uint64_t HeuristicCache::getFingerprint(const SingleAgentSolver& solver, int max_length)
+{
+	uint64_t rst = 0;
+	if (solver.my_heuristic[solver.start_location] > max_length)
+		return rst;
+	if (distances.empty())
+		distances.assign(solver.instance.map_size, -1);
+	distances[solver.start_location] = 0;
+	region.push_back(solver.start_location);
+	for (size_t i = 0; i < region.size(); i++) // BFS
+	{
+		int loc = region[i];
+		int t_min = distances[loc] - 1;
+		int t_max = (loc == solver.goal_location)? MAX_TIMESTEP : // the agent stays at its goal location forever
+				max_length - solver.my_heuristic[loc] + 1;
+		if (!path_table.table.empty())
+		{
+			const auto& agents = path_table.table[loc];
+			for (int t = max(t_min, 0); t < (int)agents.size() && t <= t_max; t++)
+			{
+				if (agents[t] != NO_AGENT)
+					rst ^= mix(((uint64_t)loc << 32 | (uint32_t)t) ^ mix(agents[t]));
+			}
+		}
+		if (!path_table.goals.empty() && path_table.goals[loc] <= t_max)
+			rst ^= mix(((uint64_t)loc << 32 | (uint32_t)path_table.goals[loc]) ^ mix(-1));
+		for (int next : solver.getNeighbors(loc))
+		{
+			if (distances[next] < 0 && distances[loc] + 1 + solver.my_heuristic[next] <= max_length)
+			{
+				distances[next] = distances[loc] + 1;
+				region.push_back(next);
+			}
+		}
+	}
+	for (int loc : region)
+		distances[loc] = -1;
+	region.clear();
+	return rst;
+}
+
+// the path of agent i is no longer than cost minus the distance of the other agent
+uint64_t HeuristicCache::getFingerprint(const SingleAgentSolver& solver1, const SingleAgentSolver& solver2,
+	int cost, int i)
+{
+	if (i == 0)
+		return getFingerprint(solver1, cost - solver2.my_heuristic[solver2.start_location]);
+	else
+		return getFingerprint(solver2, cost - solver1.my_heuristic[solver1.start_location]);
+}
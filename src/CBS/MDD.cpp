@@ -1,4 +1,6 @@
 #include "MDD.h"
+#include "HeuristicCache.h"
+#include <algorithm>
 #include <iostream>
 #include "common.h"
 
@@ -26,6 +28,7 @@ bool MDD::buildMDD(ConstraintTable& constraint_table, const SingleAgentSolver* _
 		int timestep = -1;
 		int h_val = -1;
 		list<Node*> parents;
+		bool in_mdd = false;
 		MDDNode* mdd_node = nullptr;
 		struct compare_node
 		{
@@ -119,10 +122,10 @@ bool MDD::buildMDD(ConstraintTable& constraint_table, const SingleAgentSolver* _
 
 	// Backward
 	assert(goal_node != nullptr);
-	levels.resize(goal_node->timestep + 1);
+	vector<vector<Node*> > level_nodes(goal_node->timestep + 1);
 	list<Node*> Q;
-	goal_node->mdd_node = new MDDNode(goal_node->location, goal_node->timestep);
-	levels.back().push_back(goal_node->mdd_node);
+	goal_node->in_mdd = true;
+	level_nodes.back().push_back(goal_node);
 	Q.push_back(goal_node);
 	while (!Q.empty())
 	{
@@ -132,17 +135,51 @@ bool MDD::buildMDD(ConstraintTable& constraint_table, const SingleAgentSolver* _
 		{
 			if (curr == goal_node && parent->location == goal_node->location) 
 				continue;  // the parent of the goal node should not be at the goal location
-			if (parent->mdd_node == nullptr) // a new node
+			if (!parent->in_mdd) // a new node
 			{
-				parent->mdd_node = new MDDNode(parent->location, parent->timestep);
-				levels[parent->timestep].push_back(parent->mdd_node);
+				parent->in_mdd = true;
+				level_nodes[parent->timestep].push_back(parent);
 				Q.push_back(parent);
 			}
-			parent->mdd_node->children.push_back(curr->mdd_node); // add forward edge			
-			curr->mdd_node->parents.push_back(parent->mdd_node); // add backward edge	
 		}
 	}
-	assert(!levels[0].empty());
+	assert(!level_nodes[0].empty());
+
+	// copy the nodes to the MDD level by level, sorted by their locations
+	size_t num_of_mdd_nodes = 0;
+	for (const auto& nodes : level_nodes)
+		num_of_mdd_nodes += nodes.size();
+	vector<MDDNode> block;
+	block.reserve(num_of_mdd_nodes);
+	for (auto& nodes : level_nodes)
+	{
+		std::sort(nodes.begin(), nodes.end(), [](const Node* n1, const Node* n2) { return n1->location < n2->location; });
+		for (auto node : nodes)
+			block.emplace_back(node->location, node->timestep, goal_node->timestep);
+	}
+	auto mdd_node = addNodes(block);
+	vector<vector<MDDNode*> > mdd_levels(level_nodes.size());
+	for (auto& nodes : level_nodes)
+	{
+		for (auto node : nodes)
+		{
+			node->mdd_node = mdd_node++;
+			mdd_levels[node->timestep].push_back(node->mdd_node);
+		}
+	}
+	vector<pair<MDDNode*, MDDNode*> > edges;
+	for (const auto& nodes : level_nodes)
+	{
+		for (auto node : nodes)
+		{
+			for (auto parent : node->parents)
+			{
+				if (parent->in_mdd && !(node == goal_node && parent->location == goal_node->location))
+					edges.emplace_back(parent->mdd_node, node->mdd_node);
+			}
+		}
+	}
+	setLinks(mdd_levels, edges);
 	// release memory
 	for (auto it : allNodes_table)
 		delete it;
@@ -155,88 +192,148 @@ bool MDD::buildMDD(const ConstraintTable& ct,
         int num_of_levels, const SingleAgentSolver* _solver)
 {
     this->solver = _solver;
-    auto root = new MDDNode(solver->start_location, nullptr); // Root
-	std::queue<MDDNode*> open;
-	list<MDDNode*> closed;
-	open.push(root);
-	closed.push_back(root);
-	levels.resize(num_of_levels);
-	while (!open.empty())
+	// Forward: the locations at each level (sorted) and the edges from the previous level
+	vector<vector<int> > locations(num_of_levels);
+	vector<vector<pair<int, int> > > level_edges(num_of_levels); // <index of the parent, index of the child>
+	vector<pair<int, int> > moves; // <next location, index of the current location>
+	locations[0].push_back(solver->start_location);
+	for (int t = 0; t < num_of_levels - 1; t++)
 	{
-		auto curr = open.front();
-		open.pop();
-		// Here we suppose all edge cost equals 1
-		if (curr->level == num_of_levels - 1)
-		{
-			levels.back().push_back(curr);
-			assert(open.empty());
-			break;
-		}
 		// We want (g + 1)+h <= f = numOfLevels - 1, so h <= numOfLevels - g - 2. -1 because it's the bound of the children.
-		int heuristicBound = num_of_levels - curr->level - 2;
-		list<int> next_locations = solver->getNextLocations(curr->location);
-		for (int next_location : next_locations) // Try every possible move. We only add backward edges in this step.
+		int heuristicBound = num_of_levels - t - 2;
+		moves.clear();
+		for (int i = 0; i < (int)locations[t].size(); i++)
 		{
-			if (solver->my_heuristic[next_location] <= heuristicBound &&
-				!ct.constrained(next_location, curr->level + 1) &&
-				!ct.constrained(curr->location, next_location, curr->level + 1)) // valid move
+			int curr = locations[t][i];
+			for (int next_location : solver->getNextLocations(curr))
 			{
-				auto child = closed.rbegin();
-				bool find = false;
-				for (; child != closed.rend() && ((*child)->level == curr->level + 1); ++child)
-				{
-					if ((*child)->location == next_location) // If the child node exists
-					{
-						(*child)->parents.push_back(curr); // then add corresponding parent link and child link
-						find = true;
-						break;
-					}
-				}
-				if (!find) // Else generate a new mdd node
-				{
-					auto childNode = new MDDNode(next_location, curr);
-                    childNode->cost = num_of_levels - 1;
-					open.push(childNode);
-					closed.push_back(childNode);
-				}
+				if (solver->my_heuristic[next_location] <= heuristicBound &&
+					!ct.constrained(next_location, t + 1) &&
+					!ct.constrained(curr, next_location, t + 1)) // valid move
+					moves.emplace_back(next_location, i);
 			}
 		}
+		std::sort(moves.begin(), moves.end());
+		for (const auto& move : moves)
+		{
+			if (locations[t + 1].empty() || locations[t + 1].back() != move.first)
+				locations[t + 1].push_back(move.first);
+			level_edges[t + 1].emplace_back(move.second, (int)locations[t + 1].size() - 1);
+		}
 	}
-	assert(levels.back().size() == 1);
-
-	// Backward
-	auto goal_node = levels.back().back();
-	for (auto parent : goal_node->parents)
+	assert(locations.back().size() == 1);
+
+	// Backward: keep the nodes that reach the goal node
+	vector<vector<int> > index(num_of_levels); // index of the node in the block, or -1 if it is useless
+	for (int t = 0; t < num_of_levels; t++)
+		index[t].assign(locations[t].size(), -1);
+	index.back()[0] = 0;
+	size_t num_of_mdd_nodes = 1;
+	for (int t = num_of_levels - 1; t > 0; t--)
 	{
-		if (parent->location == goal_node->location) // the parent of the goal node should not be at the goal location
-			continue;
-		levels[num_of_levels - 2].push_back(parent);
-		parent->children.push_back(goal_node); // add forward edge	
+		for (const auto& edge : level_edges[t])
+		{
+			if (index[t][edge.second] < 0 || index[t - 1][edge.first] >= 0 ||
+				(t == num_of_levels - 1 && locations[t - 1][edge.first] == locations[t][edge.second]))
+				continue;  // the parent of the goal node should not be at the goal location
+			index[t - 1][edge.first] = 0;
+			num_of_mdd_nodes++;
+		}
 	}
-	for (int t = num_of_levels - 2; t > 0; t--)
+	vector<MDDNode> block;
+	block.reserve(num_of_mdd_nodes);
+	for (int t = 0; t < num_of_levels; t++)
 	{
-		for (auto node : levels[t])
+		for (int i = 0; i < (int)locations[t].size(); i++)
 		{
-			for (auto parent : node->parents)
-			{
-				if (parent->children.empty()) // a new node
-				{
-					levels[t - 1].push_back(parent);
-				}
-				parent->children.push_back(node); // add forward edge	
-			}
+			if (index[t][i] < 0)
+				continue;
+			index[t][i] = (int)block.size();
+			block.emplace_back(locations[t][i], t, num_of_levels - 1);
 		}
 	}
-
-	// Delete useless nodes (nodes who don't have any children)
-	for (auto it : closed)
-		if (it->children.empty() && it->level < num_of_levels - 1)
-			delete it;
-	closed.clear();
+	auto first = addNodes(block);
+	vector<vector<MDDNode*> > level_nodes(num_of_levels);
+	vector<pair<MDDNode*, MDDNode*> > edges;
+	for (int t = 0; t < num_of_levels; t++)
+	{
+		for (int i : index[t])
+		{
+			if (i >= 0)
+				level_nodes[t].push_back(first + i);
+		}
+		for (const auto& edge : level_edges[t])
+		{
+			int parent = index[t - 1][edge.first];
+			int child = index[t][edge.second];
+			if (parent >= 0 && child >= 0)
+				edges.emplace_back(first + parent, first + child);
+		}
+	}
+	setLinks(level_nodes, edges);
     assert(levels.back().front()->location == solver->goal_location);
 	return true;
 }
 
+MDDNode* MDD::addNodes(vector<MDDNode>& block)
+{
+	for (auto& node : block)
+		node.id = num_of_nodes++;
+	node_blocks.push_back(std::move(block));
+	return node_blocks.back().data();
+}
+
+void MDD::setLinks(vector<vector<MDDNode*> >& level_nodes, const vector<pair<MDDNode*, MDDNode*> >& edges)
+{
+	size_t num_of_links = 2 * edges.size();
+	for (auto& nodes : level_nodes)
+	{
+		std::sort(nodes.begin(), nodes.end(), [](const MDDNode* n1, const MDDNode* n2) { return n1->location < n2->location; });
+		num_of_links += nodes.size();
+	}
+	links.resize(num_of_links);
+	auto ptr = links.data();
+	levels.resize(level_nodes.size());
+	for (size_t t = 0; t < level_nodes.size(); t++)
+	{
+		levels[t].first = ptr;
+		levels[t].num = (int)level_nodes[t].size();
+		ptr = std::copy(level_nodes[t].begin(), level_nodes[t].end(), ptr);
+	}
+
+	// count the children and parents, and then fill in their ranges
+	for (auto& block : node_blocks)
+	{
+		for (auto& node : block)
+		{
+			node.children.num = 0;
+			node.parents.num = 0;
+		}
+	}
+	for (const auto& edge : edges)
+	{
+		edge.first->children.num++;
+		edge.second->parents.num++;
+	}
+	for (auto& block : node_blocks)
+	{
+		for (auto& node : block)
+		{
+			node.children.first = ptr;
+			ptr += node.children.num;
+			node.children.num = 0;
+			node.parents.first = ptr;
+			ptr += node.parents.num;
+			node.parents.num = 0;
+		}
+	}
+	for (const auto& edge : edges)
+	{
+		edge.first->children.first[edge.first->children.num++] = edge.second;
+		edge.second->parents.first[edge.second->parents.num++] = edge.first;
+	}
+}
+
 /*bool MDD::buildMDD(const std::vector <std::list< std::pair<int, int> > >& constraints, int numOfLevels,
 	int start_location, const int* moves_offset, const std::vector<int>& my_heuristic, int map_size, int num_col)
 {
@@ -313,75 +410,156 @@ bool MDD::buildMDD(const ConstraintTable& ct,
 }*/
 
 
-void MDD::deleteNode(MDDNode* node)
+void MDD::clear()
 {
-	levels[node->level].remove(node);
-	for (auto child = node->children.begin(); child != node->children.end(); ++child)
-	{
-		(*child)->parents.remove(node);
-		if((*child)->parents.empty())
-			deleteNode(*child);
-	}
-	for (auto parent = node->parents.begin(); parent != node->parents.end(); ++parent)
-	{
-		(*parent)->children.remove(node);
-		if ((*parent)->children.empty())
-			deleteNode(*parent);
-	}
+	node_blocks.clear();
+	links.clear();
+	levels.clear();
+	num_of_nodes = 0;
 }
 
-void MDD::clear()
+MDDNode* MDD::find(int location, int level) const
 {
-	if(levels.empty())
-		return;
-	for (auto & level : levels)
+	if (level < (int)levels.size())
 	{
-		for (auto & it : level)
-			delete it;
+		auto it = std::lower_bound(levels[level].begin(), levels[level].end(), location,
+			[](const MDDNode* node, int location) { return node->location < location; });
+		if (it != levels[level].end() && (*it)->location == location)
+			return *it;
 	}
-	levels.clear();
+	return nullptr;
 }
 
-MDDNode* MDD::find(int location, int level) const
+size_t MDD::getMemoryUsage() const
 {
-	if(level < (int)levels.size())
-		for (auto it : levels[level])
-			if(it->location == location)
-				return it;
-	return nullptr;
+	size_t rst = sizeof(MDD) + node_blocks.capacity() * sizeof(vector<MDDNode>) +
+		links.capacity() * sizeof(MDDNode*) + levels.capacity() * sizeof(MDDNodeRange);
+	for (const auto& block : node_blocks)
+		rst += block.capacity() * sizeof(MDDNode);
+	return rst;
 }
 
-MDD::MDD(const MDD & cpy) // deep copy
+MDD::MDD(const MDD & cpy): solver(cpy.solver) // deep copy into a single block
 {
-	levels.resize(cpy.levels.size());
-	auto root = new MDDNode(cpy.levels[0].front()->location, nullptr);
-	levels[0].push_back(root);
-	for(size_t t = 0; t < levels.size() - 1; t++)
+	vector<bool> kept(cpy.num_of_nodes, true);
+	copyNodes(cpy, kept, vector<tuple<int, int, int> >());
+}
+
+void MDD::copyNodes(const MDD& other, const vector<bool>& kept, const vector<tuple<int, int, int> >& removed_edges)
+{
+	size_t num_of_kept_nodes = 0;
+	for (const auto& level : other.levels)
+		for (auto node : level)
+			if (kept[node->id])
+				num_of_kept_nodes++;
+	vector<MDDNode> block;
+	block.reserve(num_of_kept_nodes);
+	vector<int> index(other.num_of_nodes, -1); // index of the copy of each node in the block
+	for (const auto& level : other.levels)
 	{
-		for (auto node = levels[t].begin(); node != levels[t].end(); ++node)
+		for (auto node : level)
 		{
-			MDDNode* cpyNode = cpy.find((*node)->location, (*node)->level);
-			for (list<MDDNode*>::const_iterator cpyChild = cpyNode->children.begin(); cpyChild != cpyNode->children.end(); ++cpyChild)
+			if (!kept[node->id])
+				continue;
+			index[node->id] = (int)block.size();
+			block.emplace_back(node->location, node->level, node->cost);
+		}
+	}
+	auto first = addNodes(block);
+	vector<vector<MDDNode*> > level_nodes(other.levels.size());
+	vector<pair<MDDNode*, MDDNode*> > edges;
+	for (const auto& level : other.levels)
+	{
+		for (auto node : level)
+		{
+			if (index[node->id] < 0)
+				continue;
+			auto copy = first + index[node->id];
+			level_nodes[copy->level].push_back(copy);
+			for (auto child : node->children)
 			{
-				MDDNode* child = find((*cpyChild)->location, (*cpyChild)->level);
-				if (child == nullptr)
-				{
-					child = new MDDNode((*cpyChild)->location, (*node));
-          child->cost = (*cpyChild)->cost;
-					levels[child->level].push_back(child);
-					(*node)->children.push_back(child);
-				}
-				else
+				if (index[child->id] >= 0 && std::find(removed_edges.begin(), removed_edges.end(),
+						make_tuple(node->location, child->location, child->level)) == removed_edges.end())
+					edges.emplace_back(copy, first + index[child->id]);
+			}
+		}
+	}
+	setLinks(level_nodes, edges);
+}
+
+// The new constraints only remove nodes and edges from the MDD of the parent CT node, so the nodes that
+// are still on a path from the root to the goal form the MDD of the child CT node.
+// Return false if no such path exists, i.e., the MDD has to be built with more levels.
+bool MDD::buildMDD(const MDD& parent, const ConstraintLayer* new_constraints, size_t map_size)
+{
+	solver = parent.solver;
+	int num_of_levels = (int)parent.levels.size();
+	vector<bool> kept(parent.num_of_nodes, false);
+	for (const auto& level : parent.levels)
+		for (auto node : level)
+			kept[node->id] = true;
+	vector<tuple<int, int, int> > removed_edges; // <from, to, t>
+	if (new_constraints != nullptr)
+	{
+		for (const auto& constraint : new_constraints->constraints)
+		{
+			int t_min = constraint.second.first, t_max = min(constraint.second.second, num_of_levels);
+			if (constraint.first < map_size) // vertex constraint
+			{
+				for (int t = max(t_min, 0); t < t_max; t++)
 				{
-					child->parents.push_back(*node);
-					(*node)->children.push_back(child);
+					auto node = parent.find((int)constraint.first, t);
+					if (node != nullptr)
+						kept[node->id] = false;
 				}
 			}
+			else // edge constraint
+			{
+				int from = (int)(constraint.first / map_size) - 1, to = (int)(constraint.first % map_size);
+				for (int t = max(t_min, 1); t < t_max; t++)
+					removed_edges.emplace_back(from, to, t);
+			}
+		}
+		for (const auto& landmark : new_constraints->landmarks)
+		{
+			if (landmark.first >= num_of_levels)
+				continue;
+			for (auto node : parent.levels[landmark.first])
+				if (node->location != landmark.second)
+					kept[node->id] = false;
 		}
-		
 	}
+	auto removed = [&](const MDDNode* from, const MDDNode* to)
+	{
+		return std::find(removed_edges.begin(), removed_edges.end(),
+			make_tuple(from->location, to->location, to->level)) != removed_edges.end();
+	};
 
-  solver = cpy.solver;
+	// Forward: remove the nodes that cannot be reached from the root
+	for (int t = 1; t < num_of_levels; t++)
+	{
+		for (auto node : parent.levels[t])
+		{
+			if (kept[node->id] && std::none_of(node->parents.begin(), node->parents.end(),
+					[&](const MDDNode* p) { return kept[p->id] && !removed(p, node); }))
+				kept[node->id] = false;
+		}
+	}
+	// Backward: remove the nodes that cannot reach the goal node
+	for (int t = num_of_levels - 2; t >= 0; t--)
+	{
+		for (auto node : parent.levels[t])
+		{
+			if (kept[node->id] && std::none_of(node->children.begin(), node->children.end(),
+					[&](const MDDNode* c) { return kept[c->id] && !removed(node, c); }))
+				kept[node->id] = false;
+		}
+	}
+	if (!kept[parent.levels[0].front()->id])
+		return false;
+	copyNodes(parent, kept, removed_edges);
+	assert(levels.back().size() == 1 && levels.back().front()->location == solver->goal_location);
+	return true;
 }
 
 MDD::~MDD()
@@ -389,33 +567,58 @@ MDD::~MDD()
 	clear();
 }
 
+// The nodes are identified by their ids here, as the new nodes are allocated in a new block at the end.
 void MDD::increaseBy(const ConstraintTable&ct, int dLevel, SingleAgentSolver* solver){
-  auto oldHeight = levels.size();
-  auto numOfLevels = levels.size() + dLevel;
-	levels.resize(numOfLevels);
-  for (int l = 0; l < numOfLevels - 1; l++){
-    double heuristicBound = numOfLevels - l - 2+ 0.001;
-
-    auto node_map = collectMDDlevel(this, l + 1);
+  int oldHeight = levels.size();
+  int numOfLevels = oldHeight + dLevel;
+  int oldNumOfNodes = num_of_nodes;
+  vector<MDDNode*> old_nodes(oldNumOfNodes);
+  for (auto& block : node_blocks)
+    for (auto& node : block)
+      old_nodes[node.id] = &node;
+  vector<MDDNode> new_nodes;
+  vector<int> locations(oldNumOfNodes), costs(oldNumOfNodes);
+  vector<vector<int> > children(oldNumOfNodes), parents(oldNumOfNodes);
+  for (auto node : old_nodes){
+    locations[node->id] = node->location;
+    costs[node->id] = node->cost;
+    for (auto child : node->children)
+      children[node->id].push_back(child->id);
+    for (auto parent : node->parents)
+      parents[node->id].push_back(parent->id);
+  }
+  vector<vector<int> > level_ids(numOfLevels);
+  for (int l = 0; l < oldHeight; l++)
+    for (auto node : levels[l])
+      level_ids[l].push_back(node->id);
 
-    for (auto & it: levels[l]){
-      MDDNode* node_ptr = it;
+  unordered_map<int, int> node_map; // location -> id of the node at the next level
+  for (int l = 0; l < numOfLevels - 1; l++){
+    int heuristicBound = numOfLevels - l - 2;
+    node_map.clear();
+    for (int id : level_ids[l + 1])
+      node_map[locations[id]] = id;
 
-      auto next_locations = solver->getNextLocations(it->location);
+    for (int id : level_ids[l]){
+      auto next_locations = solver->getNextLocations(locations[id]);
       for (int newLoc: next_locations)
-        // for (int i = 0; i < 5; i++) // Try every possible move. We only add backward edges in this step.
         {
-          // int newLoc = node_ptr->location + solver.moves_offset[i];
           if (solver->my_heuristic[newLoc] <= heuristicBound &&
-              !ct.constrained(newLoc, it->level + 1) &&
-              !ct.constrained(it->location, newLoc, it->level + 1)) // valid move
+              !ct.constrained(newLoc, l + 1) &&
+              !ct.constrained(locations[id], newLoc, l + 1)) // valid move
             {
-              if (node_map.find(newLoc) == node_map.end()){
-                auto newNode = new MDDNode(newLoc, node_ptr);
-                levels[l + 1].push_back(newNode);
-                node_map[newLoc] = newNode;
+              auto it = node_map.find(newLoc);
+              if (it == node_map.end()){
+                int newId = (int)locations.size();
+                new_nodes.emplace_back(newLoc, l + 1, 0); // the cost is set backward
+                locations.push_back(newLoc);
+                costs.push_back(0);
+                children.emplace_back();
+                parents.emplace_back(1, id);
+                level_ids[l + 1].push_back(newId);
+                node_map[newLoc] = newId;
               }else{
-                node_map[newLoc]->parents.push_back(node_ptr);
+                parents[it->second].push_back(id);
               }
             }
         }
@@ -423,57 +626,70 @@ void MDD::increaseBy(const ConstraintTable&ct, int dLevel, SingleAgentSolver* so
   }
 
 	// Backward
+  vector<int> closed(locations.size(), -1); // the level of the last BFS that reached the node
   for (int l = oldHeight; l < numOfLevels; l++){
-    MDDNode* goal_node = nullptr;
-    for(auto it:levels[l]){
-      if (it->location == solver->goal_location){
-        goal_node = it;
+    int goal_id = -1;
+    for (int id : level_ids[l]){
+      if (locations[id] == solver->goal_location){
+        goal_id = id;
         break;
       }
     }
+    if (goal_id < 0) // the agent cannot reach its goal location at this level
+      continue;
 
-    std::queue<MDDNode*> bfs_q({goal_node});
-    boost::unordered_set<MDDNode*> closed;
-
+    std::queue<int> bfs_q({goal_id});
     while (!bfs_q.empty()){
-      auto ptr = bfs_q.front();
-      ptr->cost = l;
+      int id = bfs_q.front();
+      costs[id] = l;
 
       bfs_q.pop();
-      for (auto parent_ptr:ptr->parents){
-        parent_ptr->children.push_back(ptr); // add forward edge
+      for (int parent_id : parents[id]){
+        children[parent_id].push_back(id); // add forward edge
 
-        if (closed.find(parent_ptr) == closed.end() && parent_ptr->cost == 0){
-          bfs_q.push(parent_ptr);
-          closed.insert(parent_ptr);
+        if (closed[parent_id] != l && costs[parent_id] == 0){
+          bfs_q.push(parent_id);
+          closed[parent_id] = l;
         }
       }
     }
   }
 
-	// Delete useless nodes (nodes who don't have any children)
-  for (int l = 0; l < numOfLevels - 1; l++){
-    auto it = levels[l].begin();
-    while (it != levels[l].end()){
-      if (( *it )->children.empty()){
-        it = levels[l].erase(it);
+	// Delete useless nodes (nodes who don't have any children, or the nodes at the last level other than the goal node)
+  for (int l = 0; l < numOfLevels; l++){
+    auto it = level_ids[l].begin();
+    while (it != level_ids[l].end()){
+      if (l < numOfLevels - 1 ? children[*it].empty() : costs[*it] != l){
+        it = level_ids[l].erase(it);
       }else{
         it++;
       }
     }
   }
+
+  for (int id = 0; id < oldNumOfNodes; id++)
+    old_nodes[id]->cost = costs[id];
+  for (auto& node : new_nodes)
+    node.cost = costs[oldNumOfNodes + (&node - new_nodes.data())];
+  auto first = new_nodes.empty()? nullptr : addNodes(new_nodes);
+  auto node = [&](int id) { return id < oldNumOfNodes ? old_nodes[id] : first + (id - oldNumOfNodes); };
+  vector<vector<MDDNode*> > level_nodes(numOfLevels);
+  for (int l = 0; l < numOfLevels; l++)
+    for (int id : level_ids[l])
+      level_nodes[l].push_back(node(id));
+  vector<pair<MDDNode*, MDDNode*> > edges;
+  for (int id = 0; id < (int)children.size(); id++)
+    for (int child_id : children[id])
+      edges.emplace_back(node(id), node(child_id));
+  setLinks(level_nodes, edges);
 }
 
 MDDNode* MDD::goalAt(int level){
-  if (level >= levels.size()){return nullptr;}
-
-  for (MDDNode* ptr: levels[level]){
-    if (ptr->location == solver->goal_location && ptr->cost == level){
-      return ptr;
-    }
+  auto node = find(solver->goal_location, level);
+  if (node != nullptr && node->cost == level){
+    return node;
   }
   return nullptr;
-  // return levels[level][goal_location].get();
 }
 
 void MDD::printNodes() const
@@ -508,30 +724,22 @@ std::ostream& operator<<(std::ostream& os, const MDD& mdd)
 SyncMDD::SyncMDD(const MDD & cpy) // deep copy of a MDD
 {
 	levels.resize(cpy.levels.size());
-	auto root = new SyncMDDNode(cpy.levels[0].front()->location, nullptr);
-	levels[0].push_back(root);
-	for (int t = 0; t < (int)levels.size() - 1; t++)
+	vector<SyncMDDNode*> nodes(cpy.getNumOfNodes(), nullptr); // the copies of the MDD nodes indexed by their ids
+	for (size_t t = 0; t < cpy.levels.size(); t++)
 	{
-		for (auto node = levels[t].begin(); node != levels[t].end(); ++node)
+		for (auto node : cpy.levels[t])
 		{
-			MDDNode* cpyNode = cpy.find((*node)->location, t);
-			for (list<MDDNode*>::const_iterator cpyChild = cpyNode->children.begin(); cpyChild != cpyNode->children.end(); ++cpyChild)
+			auto copy = new SyncMDDNode(node->location, nullptr);
+			nodes[node->id] = copy;
+			levels[t].push_back(copy);
+			for (auto parent : node->parents)
 			{
-				SyncMDDNode* child = find((*cpyChild)->location, (*cpyChild)->level);
-				if (child == nullptr)
-				{
-					child = new SyncMDDNode((*cpyChild)->location, (*node));
-					levels[t + 1].push_back(child);
-					(*node)->children.push_back(child);
-				}
-				else
-				{
-					child->parents.push_back(*node);
-					(*node)->children.push_back(child);
-				}
+				if (nodes[parent->id] == nullptr)
+					continue;
+				copy->parents.push_back(nodes[parent->id]);
+				nodes[parent->id]->children.push_back(copy);
 			}
 		}
-
 	}
 }
 
@@ -559,6 +767,7 @@ void SyncMDD::deleteNode(SyncMDDNode* node, int level)
 		if ((*parent)->children.empty())
 			deleteNode(*parent, level - 1);
 	}
+	delete node;
 }
 
 
@@ -585,7 +794,7 @@ MDD* MDDTable::findMDD(HLNode& node, int agent) const
     ConstraintsHasher c(agent, &node);
     auto got = lookupTable[c.a].find(c);
     if (got != lookupTable[c.a].end())
-        return got->second;
+        return got->second.mdd;
     else
         return nullptr;
 }
@@ -596,23 +805,60 @@ MDD * MDDTable::getMDD(HLNode& node, int id, size_t mdd_levels)
 	auto got = lookupTable[c.a].find(c);
 	if (got != lookupTable[c.a].end())
 	{
-		assert((node.getName() == "CBS Node" &&  got->second->levels.size() == mdd_levels) ||
-			(node.getName() == "ECBS Node" &&  got->second->levels.size() <= mdd_levels));
-		return got->second;
+		assert((node.getName() == "CBS Node" &&  got->second.mdd->levels.size() == mdd_levels) ||
+			(node.getName() == "ECBS Node" &&  got->second.mdd->levels.size() <= mdd_levels));
+		lru_list.splice(lru_list.begin(), lru_list, got->second.lru_position);
+		num_hits++;
+		return got->second.mdd;
 	}
-	releaseMDDMemory(id);
+	num_misses++;
 	clock_t t = clock();
-	MDD * mdd = new MDD();
-	ConstraintTable ct(initial_constraints[id]);
-	ct.build(node, id);
-	if (node.getName() == "CBS Node")
-		mdd->buildMDD(ct, mdd_levels, search_engines[id]);
-	else // ECBS node
-		mdd->buildMDD(ct, search_engines[id]);
+	MDD * mdd = nullptr;
+	bool root = node.parent == nullptr && heuristic_cache != nullptr;
+	if (root)
+	{
+		auto cached = heuristic_cache->findMDD(agent_ids[id], *search_engines[id]);
+		if (cached != nullptr && (node.getName() == "ECBS Node" || cached->levels.size() == mdd_levels))
+			mdd = new MDD(*cached);
+	}
+	if (mdd == nullptr && node.parent != nullptr && node.getName() == "CBS Node")
+	{ // prune the MDD of the parent if the cost of the agent does not increase
+		auto parent_mdd = findMDD(*node.parent, id);
+		if (parent_mdd != nullptr && parent_mdd->levels.size() == mdd_levels)
+		{
+			const auto& ct = initial_constraints[id];
+			ConstraintLayer new_constraints;
+			ct.addConstraints(new_constraints, node, id);
+			mdd = new MDD();
+			if (mdd->buildMDD(*parent_mdd, new_constraints.empty() ? nullptr : &new_constraints, ct.map_size))
+				num_derived_mdds++;
+			else
+			{
+				delete mdd;
+				mdd = nullptr;
+			}
+		}
+	}
+	if (mdd == nullptr)
+	{
+		mdd = new MDD();
+		ConstraintTable ct(initial_constraints[id]);
+		ct.build(node, id);
+		if (node.getName() == "CBS Node")
+			mdd->buildMDD(ct, mdd_levels, search_engines[id]);
+		else // ECBS node
+			mdd->buildMDD(ct, search_engines[id]);
+		if (root)
+			heuristic_cache->insertMDD(agent_ids[id], *search_engines[id], *mdd);
+	}
 	if (!lookupTable.empty())
 	{
 		// ConstraintsHasher c(id, &node);
-		lookupTable[c.a][c] = mdd;
+		lru_list.emplace_front(c.a, c);
+		auto memory = mdd->getMemoryUsage();
+		lookupTable[c.a].emplace(c, Entry{mdd, memory, lru_list.begin()});
+		memory_usage += memory;
+		releaseMDDMemory();
 	}
 	accumulated_runtime += (double)(clock() - t) / CLOCKS_PER_SEC;
 	return mdd;
@@ -628,28 +874,18 @@ MDD * MDDTable::getMDD(HLNode& node, int id, size_t mdd_levels)
 		delete mdd;
 }*/
 
-void MDDTable::releaseMDDMemory(int id)
+void MDDTable::releaseMDDMemory()
 {
-	if (id < 0 || lookupTable.empty() || (int)lookupTable[id].size() < max_num_of_mdds)
-		return;
-	int minLength = MAX_TIMESTEP;
-	for (auto mdd : lookupTable[id])
+	while (memory_usage > memory_limit && lru_list.size() > MIN_NUM_OF_MDDS)
 	{
-		if ((int)mdd.second->levels.size() < minLength)
-			minLength = mdd.second->levels.size();
-	}
-	for (auto mdd = lookupTable[id].begin(); mdd != lookupTable[id].end();)
-	{
-		if ((int)mdd->second->levels.size() == minLength)
-		{
-			delete mdd->second;
-			mdd = lookupTable[id].erase(mdd);
-			num_released_mdds++;
-		}
-		else
-		{
-			mdd++;
-		}
+		const auto& key = lru_list.back();
+		auto got = lookupTable[key.first].find(key.second);
+		assert(got != lookupTable[key.first].end());
+		memory_usage -= got->second.memory;
+		delete got->second.mdd;
+		lookupTable[key.first].erase(got);
+		lru_list.pop_back();
+		num_evicted_mdds++;
 	}
 }
 
@@ -659,10 +895,12 @@ void MDDTable::clear()
 	{
 		for (auto mdd : mdds)
 		{
-			delete mdd.second;
+			delete mdd.second.mdd;
 		}
+		mdds.clear(); // keep the memory of the hash table
 	}
-	lookupTable.clear();
+	lru_list.clear();
+	memory_usage = 0;
 }
 
 unordered_map<int, MDDNode*> collectMDDlevel(MDD* mdd, int i){
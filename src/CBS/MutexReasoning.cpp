@@ -2,7 +2,7 @@
 #include "ConstraintPropagation.h"
 
 
-shared_ptr<Conflict> MutexReasoning::run(int a1, int a2, CBSNode& node, MDD* mdd_1, MDD* mdd_2)
+ConflictPtr MutexReasoning::run(int a1, int a2, CBSNode& node, MDD* mdd_1, MDD* mdd_2)
 {
 	clock_t t = clock();
 	auto conflict = findMutexConflict(a1, a2, node, mdd_1, mdd_2);
@@ -11,7 +11,7 @@ shared_ptr<Conflict> MutexReasoning::run(int a1, int a2, CBSNode& node, MDD* mdd
 }
 
 
-shared_ptr<Conflict> MutexReasoning::findMutexConflict(int a1, int a2, CBSNode& node, MDD* mdd_1, MDD* mdd_2){
+ConflictPtr MutexReasoning::findMutexConflict(int a1, int a2, CBSNode& node, MDD* mdd_1, MDD* mdd_2){
   ConstraintPropagation cp(mdd_1, mdd_2);
   cp.init_mutex();
   cp.fwd_mutex_prop();
@@ -30,7 +30,7 @@ shared_ptr<Conflict> MutexReasoning::findMutexConflict(int a1, int a2, CBSNode&
 	ConstraintsHasher c_1(a1, &node);
 	ConstraintsHasher c_2(a2, &node);
 
-  shared_ptr<Conflict> mutex_conflict = nullptr;
+  ConflictPtr mutex_conflict = nullptr;
   if (lookupTable.find(c_1) != lookupTable.end()){
     if (lookupTable[c_1].find(c_2) != lookupTable[c_1].end()){
       mutex_conflict = lookupTable[c_1][c_2];
@@ -39,7 +39,7 @@ shared_ptr<Conflict> MutexReasoning::findMutexConflict(int a1, int a2, CBSNode&
 
   if (mutex_conflict == nullptr){
     // generate constraint;
-    mutex_conflict = make_shared<Conflict>();
+    mutex_conflict = ConflictPtr(new Conflict());
     mutex_conflict->mutexConflict(a1, a2);
 
     MDD mdd_1_cpy(*mdd_1);
@@ -65,14 +65,14 @@ shared_ptr<Conflict> MutexReasoning::findMutexConflict(int a1, int a2, CBSNode&
       get<0>(con) = a2;
       mutex_conflict->constraint2.push_back(con);
     }
-    // mutex_conflict->constraint1 = list<Constraint>(a.begin(), a.end());
-    // mutex_conflict->constraint2 = list<Constraint>(b.begin(), b.end());
+    // mutex_conflict->constraint1 = ConstraintList(a.begin(), a.end());
+    // mutex_conflict->constraint2 = ConstraintList(b.begin(), b.end());
 
     lookupTable[c_1][c_2] = mutex_conflict;
   }
 
   // prepare for return
-  shared_ptr<Conflict> conflict_to_return = make_shared<Conflict>(*mutex_conflict);
+  ConflictPtr conflict_to_return = ConflictPtr(new Conflict(*mutex_conflict));
 
   if (swapped){
     std::swap(conflict_to_return->a1, conflict_to_return->a2);
@@ -1,17 +1,33 @@
 #include "RectangleReasoning.h"
 
 
-shared_ptr<Conflict> RectangleReasoning::run(const vector<Path*>& paths, int timestep,
-	int a1, int a2, const MDD* mdd1, const MDD* mdd2)
+ConflictPtr RectangleReasoning::run(const vector<Path*>& paths, int timestep,
+	int a1, int a2, const MDD* mdd1, const MDD* mdd2, HLNode& node)
 {
 	clock_t t = clock();
+	LookupKey key{ ConstraintsHasher(a1, &node), ConstraintsHasher(a2, &node), timestep, paths[a1]->at(timestep).location,
+		(int)paths[a1]->size(), (int)paths[a2]->size() };
+	auto got = lookupTable.find(key);
+	if (got != lookupTable.end() && (got->second.rectangle == nullptr ||
+		(blocked(*paths[a1], got->second.rectangle->constraint1) && blocked(*paths[a2], got->second.rectangle->constraint2))))
+	{
+		num_hits++;
+		saved_runtime += got->second.runtime;
+		accumulated_runtime += (double)(clock() - t) / CLOCKS_PER_SEC;
+		if (got->second.rectangle == nullptr)
+			return nullptr;
+		return ConflictPtr(new Conflict(*got->second.rectangle)); // the caller modifies the priorities of the conflict
+	}
+	num_misses++;
 	auto rectangle = findRectangleConflictByRM(paths, timestep, a1, a2, mdd1, mdd2);
-	accumulated_runtime += (double)(clock() - t) / CLOCKS_PER_SEC;
+	double runtime = (double)(clock() - t) / CLOCKS_PER_SEC;
+	lookupTable[key] = LookupEntry{ (rectangle == nullptr) ? nullptr : ConflictPtr(new Conflict(*rectangle)), runtime };
+	accumulated_runtime += runtime;
 	return rectangle;
 }
 
 
-shared_ptr<Conflict> RectangleReasoning::findRectangleConflictByGR(const vector<Path*>& paths, int timestep,
+ConflictPtr RectangleReasoning::findRectangleConflictByGR(const vector<Path*>& paths, int timestep,
 	int a1, int a2, const MDD* mdd1, const MDD* mdd2)
 {
 	assert(timestep > 0);
@@ -23,7 +39,7 @@ shared_ptr<Conflict> RectangleReasoning::findRectangleConflictByGR(const vector<
 		abs(from1 - from2) == 2 || abs(from1 - from2) == instance.getCols() * 2) //opposite direction
 		return nullptr;
 
-	list<Constraint> B1;
+	ConstraintList B1;
 	int t_start = getStartCandidate(*paths[a1], loc - from1, loc - from2, timestep);
 	int t_end = getGoalCandidate(*paths[a1], loc - from1, loc - from2, timestep);
 	bool haveBarriers = ExtractBarriers(*mdd1, loc, timestep, loc - from1, loc - from2, 
@@ -31,7 +47,7 @@ shared_ptr<Conflict> RectangleReasoning::findRectangleConflictByGR(const vector<
 	if (!haveBarriers)
 		return nullptr;
 
-	list<Constraint> B2;
+	ConstraintList B2;
 	t_start = getStartCandidate(*paths[a2], loc - from1, loc - from2, timestep);
 	t_end = getGoalCandidate(*paths[a2], loc - from1, loc - from2, timestep);
 
@@ -49,8 +65,8 @@ shared_ptr<Conflict> RectangleReasoning::findRectangleConflictByGR(const vector<
 		return nullptr;
 	int Rg_t = timestep + instance.getManhattanDistance(instance.getCoordinate(loc), Rg);
 	
-	list<Constraint> constraint1;
-	list<Constraint> constraint2;
+	ConstraintList constraint1;
+	ConstraintList constraint2;
 	bool succ;
 	if (abs(loc - from1) == 1 || abs(loc - from2) > 1) // first agent moves horizontally and second agent moves vertically
 	{
@@ -69,7 +85,7 @@ shared_ptr<Conflict> RectangleReasoning::findRectangleConflictByGR(const vector<
 
 	if (!blocked(*paths[a1], constraint1) || !blocked(*paths[a2], constraint2))
 		return nullptr;
-	auto rectangle = shared_ptr<Conflict>(new Conflict());
+	auto rectangle = ConflictPtr(new Conflict());
 	rectangle->rectangleConflict(a1, a2, Rs, Rg, Rg_t, constraint1, constraint2);
 	if (type == 2)
 		rectangle->priority = conflict_priority::CARDINAL;
@@ -81,10 +97,10 @@ shared_ptr<Conflict> RectangleReasoning::findRectangleConflictByGR(const vector<
 }
 
 
-shared_ptr<Conflict> RectangleReasoning::findRectangleConflictByRM(const vector<Path*>& paths, int timestep,
+ConflictPtr RectangleReasoning::findRectangleConflictByRM(const vector<Path*>& paths, int timestep,
         int a1, int a2, const MDD* mdd1, const MDD* mdd2)
 {
-    shared_ptr<Conflict> rectangle = nullptr;
+    ConflictPtr rectangle = nullptr;
     //Rectangle reasoning for semi and non cardinal vertex conflicts
     list<int>	s1s = getStartCandidates(*paths[a1], *mdd1,  timestep);
     list<int>	g1s = getGoalCandidates(*paths[a1], *mdd1, timestep);
@@ -120,15 +136,15 @@ shared_ptr<Conflict> RectangleReasoning::findRectangleConflictByRM(const vector<
                     if (new_type > type || (new_type == type && new_area > area))
                     {
                         int Rg_t = timestep + abs(Rg.first - location.first) + abs(Rg.second - location.second);
-						list<Constraint> constraint1;
-						list<Constraint> constraint2;
+						ConstraintList constraint1;
+						ConstraintList constraint2;
 						bool succ = addModifiedBarrierConstraints(a1, a2, Rs, Rg, s1, s2, 
 							Rg_t, mdd1, mdd2, constraint1, constraint2);
                         if (succ && blocked(*paths[a1], constraint1) && blocked(*paths[a2], constraint2))
                         {
 							type = new_type;
 							area = new_area;
-							rectangle = shared_ptr<Conflict>(new Conflict());
+							rectangle = ConflictPtr(new Conflict());
 							rectangle->rectangleConflict(a1, a2, Rs, Rg, Rg_t, constraint1, constraint2);
                             if (type == 2)
 							{
@@ -152,7 +168,7 @@ shared_ptr<Conflict> RectangleReasoning::findRectangleConflictByRM(const vector<
 
 
 bool RectangleReasoning::ExtractBarriers(const MDD& mdd, int loc, int timestep,
-					int dir1, int dir2, int start, int goal, int start_time, list<Constraint>& B)
+					int dir1, int dir2, int start, int goal, int start_time, ConstraintList& B)
 {
 	int num_barrier;
 	int sign1 = dir1 / abs(dir1);
@@ -169,7 +185,7 @@ bool RectangleReasoning::ExtractBarriers(const MDD& mdd, int loc, int timestep,
 	vector<int> extent_L(num_barrier, MAX_TIMESTEP);
 	vector<int> extent_U(num_barrier, -1);
 
-	unordered_map<MDDNode*, vector<bool>> blocking;
+	vector<vector<bool>> blocking(mdd.getNumOfNodes()); // indexed by the ids of the MDD nodes
 
 	auto n = mdd.levels[0].front();
 	vector<bool> block(num_barrier, false);
@@ -192,7 +208,7 @@ bool RectangleReasoning::ExtractBarriers(const MDD& mdd, int loc, int timestep,
 		block[0] = true;
 		//hasStart = true;
 	}
-	blocking[n] = block;
+	blocking[n->id] = block;
 
 	for (size_t t = 1; t < mdd.levels.size(); t++)
 	{
@@ -201,7 +217,7 @@ bool RectangleReasoning::ExtractBarriers(const MDD& mdd, int loc, int timestep,
 			vector<bool> block(num_barrier, true);
 			for (auto parent : n->parents)
 			{
-				vector<bool> parent_block = blocking[parent];
+				const vector<bool>& parent_block = blocking[parent->id];
 				for (int i = 0; i < num_barrier; i++)
 				{
 					if (!parent_block[i])
@@ -232,12 +248,12 @@ bool RectangleReasoning::ExtractBarriers(const MDD& mdd, int loc, int timestep,
 					block[barrier_id] = true;
 				}
 			}
-			blocking[n] = block;
+			blocking[n->id] = block;
 		}
 	}
 
 	n = mdd.levels.back().front();
-	block = blocking[n];
+	block = blocking[n->id];
 	for (int i = 0; i < num_barrier; i++)
 	{
 		if (block[i])
@@ -378,7 +394,7 @@ bool RectangleReasoning::isCut(const Constraint b, const pair<int, int>& Rs, con
 
 void RectangleReasoning::generalizedRectangle(const vector<PathEntry>& path1, const vector<PathEntry>& path2, 
 	const MDD& mdd1, const MDD& mdd2,
-	const list<Constraint>& B1, const list<Constraint>& B2, int timestep,
+	const ConstraintList& B1, const ConstraintList& B2, int timestep,
 	int& best_type, pair<int, int>& best_Rs, pair<int, int>& best_Rg)
 {
 	int loc = path1[timestep].location;
@@ -391,8 +407,8 @@ void RectangleReasoning::generalizedRectangle(const vector<PathEntry>& path1, co
 			if (isEntryBarrier(b1_entry, b2_entry, dir1) && isEntryBarrier(b2_entry, b1_entry, dir2))
 			{
 				pair<int, int> Rs = getIntersection(b1_entry, b2_entry);
-				list<Constraint>::const_reverse_iterator  b1_exit = B1.rbegin();
-				list<Constraint>::const_reverse_iterator  b2_exit = B2.rbegin();
+				ConstraintList::const_reverse_iterator  b1_exit = B1.rbegin();
+				ConstraintList::const_reverse_iterator  b2_exit = B2.rbegin();
 				while (b1_exit != B1.rend() && b2_exit != B2.rend())
 				{
 					if (!isExitBarrier(*b1_exit, b2_entry, dir1))
@@ -613,7 +629,7 @@ bool RectangleReasoning::addModifiedBarrierConstraints(int a1, int a2,
 	const pair<int, int>& Rs, const pair<int, int>& Rg,
 	const pair<int, int>& s1, const pair<int, int>& s2, int Rg_t,
 	const MDD* mdd1, const MDD* mdd2,
-	list<Constraint>& constraint1, list<Constraint>& constraint2)
+	ConstraintList& constraint1, ConstraintList& constraint2)
 {
 	if ((s2.first - s1.first) * (s1.first - Rg.first) > 0 && (s2.second - s1.second) * (s1.second - Rg.second) > 0) // s1 in the middle
 	{
@@ -736,14 +752,8 @@ bool RectangleReasoning::hasNodeOnBarrier(const MDD* mdd, int y_start, int y_end
 			loc = instance.linearizeCoordinate(x, y_start + (t2 - t_min) * sign);
 		else
 			loc = instance.linearizeCoordinate(y_start + (t2 - t_min) * sign, x);
-		MDDNode* it = nullptr;
-		for (MDDNode* n : mdd->levels[t2])
-		{
-			if (n->location == loc)
-			{
-				return true;
-			}
-		}
+		if (mdd->find(loc, t2) != nullptr)
+			return true;
 	}
 	return false;
 }
@@ -751,7 +761,7 @@ bool RectangleReasoning::hasNodeOnBarrier(const MDD* mdd, int y_start, int y_end
 
 // add a horizontal modified barrier constraint
 bool RectangleReasoning::addModifiedHorizontalBarrierConstraint(int agent, const MDD* mdd, int x,
-	int Ri_y, int Rg_y, int Rg_t, list<Constraint>& constraints)
+	int Ri_y, int Rg_y, int Rg_t, ConstraintList& constraints)
 {
 	int sign = Ri_y < Rg_y ? 1 : -1;
 	int Ri_t = Rg_t - abs(Ri_y - Rg_y);
@@ -761,15 +771,7 @@ bool RectangleReasoning::addModifiedHorizontalBarrierConstraint(int agent, const
 	for (int t2 = t_min; t2 <= t_max; t2++)
 	{
 		int loc = instance.linearizeCoordinate(x,  (Ri_y + (t2 - Ri_t) * sign));
-		MDDNode* it = nullptr;
-		for (MDDNode* n : mdd->levels[t2])
-		{
-			if (n->location == loc)
-			{
-				it = n;
-				break;
-			}
-		}
+		MDDNode* it = mdd->find(loc, t2);
 		if (it == nullptr && t1 >= 0) // add constraints [t1, t2)
 		{
 			int loc1 = instance.linearizeCoordinate(x, (Ri_y + (t1 - Ri_t) * sign));
@@ -800,7 +802,7 @@ bool RectangleReasoning::addModifiedHorizontalBarrierConstraint(int agent, const
 
 // add a vertival modified barrier constraint
 bool RectangleReasoning::addModifiedVerticalBarrierConstraint(int agent, const MDD* mdd, int y,
-	int Ri_x, int Rg_x, int Rg_t, list<Constraint>& constraints)
+	int Ri_x, int Rg_x, int Rg_t, ConstraintList& constraints)
 {
 	int sign = Ri_x < Rg_x ? 1 : -1;
 	int Ri_t = Rg_t - abs(Ri_x - Rg_x);
@@ -810,15 +812,7 @@ bool RectangleReasoning::addModifiedVerticalBarrierConstraint(int agent, const M
 	for (int t2 = t_min; t2 <= t_max; t2++)
 	{
 		int loc = instance.linearizeCoordinate((Ri_x + (t2 - Ri_t) * sign), y);
-		MDDNode* it = nullptr;
-		for (MDDNode* n : mdd->levels[t2])
-		{
-			if (n->location == loc)
-			{
-				it = n;
-				break;
-			}
-		}
+		MDDNode* it = mdd->find(loc, t2);
 		if (it == nullptr && t1 >= 0) // add constraints [t1, t2)
 		{
 			int loc1 = instance.linearizeCoordinate((Ri_x + (t1 - Ri_t) * sign), y);
@@ -846,7 +840,7 @@ bool RectangleReasoning::addModifiedVerticalBarrierConstraint(int agent, const M
 		return true;
 }
 
-bool RectangleReasoning::blocked(const Path& path, const list<Constraint>& constraints)
+bool RectangleReasoning::blocked(const Path& path, const ConstraintList& constraints)
 {
 	for (auto constraint : constraints)
 	{
@@ -28,77 +28,73 @@
 }*/
 
 
-// build the constraint table and the conflict avoidance table
-void ReservationTable::buildCAT(int agent, const vector<Path*>& paths)
+// build the conflict avoidance table
+void ReservationTable::buildCAT(int agent, const ConflictAvoidanceTable& cat)
 {
-	for (size_t ag = 0; ag < paths.size(); ag++)
+	vector<KeyedTimeRange> conflicts;
+	for (int ag = 0; ag < cat.getNumOfAgents(); ag++)
 	{
-		if (ag == agent || paths[ag] == nullptr)
+		const auto& path = cat.getPath(ag);
+		if (ag == agent || path.empty())
 			continue;
-		if (paths[ag]->size() == 1) // its start location is its goal location
+		if (path.size() == 1) // its start location is its goal location
 		{
-			cat[paths[ag]->front().location].emplace_back(0, MAX_TIMESTEP);
+			conflicts.emplace_back(path.front().location, TimeRange(0, MAX_TIMESTEP));
 			continue;
 		}
-		int prev_location = paths[ag]->front().location;
+		int prev_location = path.front().location;
 		int prev_timestep = 0;
-		for (int timestep = 0; timestep < (int) paths[ag]->size(); timestep++)
+		for (int timestep = 0; timestep < (int) path.size(); timestep++)
 		{
-			int curr_location = paths[ag]->at(timestep).location;
+			int curr_location = path[timestep].location;
 			if (prev_location != curr_location)
 			{
-				cat[prev_location].emplace_back(prev_timestep, timestep); // add vertex conflict
-				cat[getEdgeIndex(curr_location, prev_location)].emplace_back(timestep, timestep + 1); // add edge conflict
+				conflicts.emplace_back(prev_location, TimeRange(prev_timestep, timestep)); // add vertex conflict
+				conflicts.emplace_back(getEdgeIndex(curr_location, prev_location), TimeRange(timestep, timestep + 1)); // add edge conflict
 				prev_location = curr_location;
 				prev_timestep = timestep;
 			}
 		}
-		cat[paths[ag]->back().location].emplace_back(paths[ag]->size() - 1, MAX_TIMESTEP);
+		conflicts.emplace_back(path.back().location, TimeRange(path.size() - 1, MAX_TIMESTEP));
 	}
+	sortAndMerge(conflicts, cat_ranges);
 }
 
 int ReservationTable::getNumOfConflictsForStep(size_t curr_id, size_t next_id, size_t next_timestep) const
 {
 	int rst = 0;
-	const auto& it = cat.find(next_id);
-	if (it != cat.end())
+	for (auto key : {next_id, getEdgeIndex(curr_id, next_id)})
 	{
-		for (const auto& constraint : it->second)
+		auto range = findRanges(cat_ranges, key);
+		for (auto it = range.first; it != range.second; ++it)
 		{
-			if (constraint.first <= (int)next_timestep && (int)next_timestep < constraint.second)
-				rst++;
-		}
-	}
-	const auto& it2 = cat.find(getEdgeIndex(curr_id, next_id));
-	if (it2 != cat.end())
-	{
-		for (const auto& constraint : it2->second)
-		{
-			if (constraint.first <= (int)next_timestep && (int)next_timestep < constraint.second)
+			if (it->second.first <= (int)next_timestep && (int)next_timestep < it->second.second)
 				rst++;
 		}
 	}
 	return rst;
 }
 
-void ReservationTable::insert2RT(size_t location, size_t t_min, size_t t_max)
+void ReservationTable::insert2RT(size_t t_min, size_t t_max)
 {
 	assert(t_min >= 0 && t_min < t_max);
-    if (sit.find(location) == sit.end())
+    if (!sit_buffer_created)
     {
 		assert(length_min <= length_max);
 		int latest_timestep = min(length_max, MAX_TIMESTEP - 1) + 1;
 		if (t_min > 0)
 		{
-			sit[location].emplace_back(0, t_min, 0);
+			sit_buffer.emplace_back(0, t_min, 0);
+			sit_buffer_created = true;
 		}
 		if ((int)t_max < latest_timestep)
 		{
-			sit[location].emplace_back(t_max, latest_timestep, 0);
+			sit_buffer.emplace_back(t_max, latest_timestep, 0);
+			sit_buffer_created = true;
 		}
         return;
     }
-    for (auto it = sit[location].begin(); it != sit[location].end();)
+    for (auto it = sit_buffer.begin(); it != sit_buffer.end();)
     {
         if (t_min >= get<1>(*it))
 			++it; 
@@ -116,58 +112,67 @@ void ReservationTable::insert2RT(size_t location, size_t t_min, size_t t_max)
         }
         else if (get<0>(*it) < t_min && t_max < get<1>(*it))
         {
-			sit[location].insert(it, make_tuple(get<0>(*it), t_min, 0));
-            (*it) = make_tuple(t_max, get<1>(*it), 0);
+			auto t_end = get<1>(*it);
+			it = sit_buffer.insert(it, make_tuple(get<0>(*it), t_min, 0));
+			++it;
+            (*it) = make_tuple(t_max, t_end, 0);
             break;
         }
         else // constraint_min <= get<0>(*it) && get<1> <= constraint_max
         {
-            it = sit[location].erase(it);
+            it = sit_buffer.erase(it);
         }
     }
 }
 
 
-void ReservationTable::insertSoftConstraint2RT(size_t location, size_t t_min, size_t t_max)
+void ReservationTable::insertSoftConstraint2RT(size_t t_min, size_t t_max)
 {
-    if (sit.find(location) == sit.end())
+    if (!sit_buffer_created)
     {
         if (t_min > 0)
         {
-			sit[location].emplace_back(0, t_min, 0);
+			sit_buffer.emplace_back(0, t_min, 0);
         }
-		sit[location].emplace_back(t_min, t_max, 1);
-		sit[location].emplace_back(t_max, min(length_max, MAX_TIMESTEP - 1) + 1, 0);
+		sit_buffer.emplace_back(t_min, t_max, 1);
+		sit_buffer.emplace_back(t_max, min(length_max, MAX_TIMESTEP - 1) + 1, 0);
+		sit_buffer_created = true;
         return;
     }
-    for (auto it = sit[location].begin(); it != sit[location].end(); it++)
+    for (auto it = sit_buffer.begin(); it != sit_buffer.end(); it++)
     {
         if (t_min >= get<1>(*it))
             continue;
         else if (t_max <= get<0>(*it))
             break;
 
+        auto t_begin = get<0>(*it);
+        auto t_end = get<1>(*it);
         auto conflicts = get<2>(*it);
 
-        if (get<0>(*it) < t_min && get<1>(*it) <= t_max)
+        if (t_begin < t_min && t_end <= t_max)
         {
-			sit[location].insert(it, make_tuple(get<0>(*it), t_min, conflicts));
-            (*it) = make_tuple(t_min, get<1>(*it), conflicts + 1);
+			it = sit_buffer.insert(it, make_tuple(t_begin, t_min, conflicts));
+			++it;
+            (*it) = make_tuple(t_min, t_end, conflicts + 1);
         }
-        else if (t_min <= get<0>(*it) && t_max < get<1>(*it))
+        else if (t_min <= t_begin && t_max < t_end)
         {
-			sit[location].insert(it, make_tuple(get<0>(*it), t_max, conflicts + 1));
-            (*it) = make_tuple(t_max, get<1>(*it), conflicts);
+			it = sit_buffer.insert(it, make_tuple(t_begin, t_max, conflicts + 1));
+			++it;
+            (*it) = make_tuple(t_max, t_end, conflicts);
         }
-        else if (get<0>(*it) < t_min && t_max < get<1>(*it))
+        else if (t_begin < t_min && t_max < t_end)
         {
-			sit[location].insert(it, make_tuple(get<0>(*it), t_min, conflicts));
-			sit[location].insert(it, make_tuple(t_min, t_max, conflicts + 1));
-            (*it) = make_tuple(t_max, get<1>(*it), conflicts);
+			it = sit_buffer.insert(it, make_tuple(t_begin, t_min, conflicts));
+			++it;
+			it = sit_buffer.insert(it, make_tuple(t_min, t_max, conflicts + 1));
+			++it;
+            (*it) = make_tuple(t_max, t_end, conflicts);
         }
         else // constraint_min <= get<0>(*it) && get<1> <= constraint_max
         {
-            (*it) = make_tuple(get<0>(*it), get<1>(*it), conflicts + 1);
+            (*it) = make_tuple(t_begin, t_end, conflicts + 1);
         }
     }
 }
@@ -198,96 +203,127 @@ void ReservationTable::insertSoftConstraint2RT(size_t location, size_t t_min, si
 
 
 // update SIT at the gvien location
-void ReservationTable::updateSIT(size_t location)
+// return the slot [begin, end) of its safe intervals in sit_intervals, or (-1, -1) if the location is not constrained
+pair<int, int> ReservationTable::updateSIT(size_t location)
 {
-	if (sit.find(location) == sit.end())
+	vector<pair<size_t, pair<int, int> > >::iterator edge_slot;
+	if (location < map_size)
+	{
+		if (sit_slots.empty())
+			sit_slots.assign(map_size, make_pair(-1, -1));
+		else if (sit_slots[location].first >= 0)
+			return sit_slots[location];
+	}
+	else
+	{
+		edge_slot = std::lower_bound(sit_edge_slots.begin(), sit_edge_slots.end(), location,
+			[](const pair<size_t, pair<int, int> >& slot, size_t edge) { return slot.first < edge; });
+		if (edge_slot != sit_edge_slots.end() && edge_slot->first == location)
+			return edge_slot->second;
+	}
+	auto ct_range = findRanges(ct_ranges, location);
+	auto cat_range = findRanges(cat_ranges, location);
+	if (location >= map_size && ct_range.first == ct_range.second && cat_range.first == cat_range.second)
+		return make_pair(-1, -1); // most edges are not constrained, so we do not store them
+
+	sit_buffer.clear();
+	sit_buffer_created = false;
+	bool goal = location < map_size && (int)location == goal_location;
+	// length constraints for the goal location
+	if (goal) // we need to divide the same intevals into 2 parts [0, length_min) and [length_min, length_max + 1)
 	{
-		// length constraints for the goal location
-		if (location == goal_location) // we need to divide the same intevals into 2 parts [0, length_min) and [length_min, length_max + 1)
+		int latest_timestep = min(length_max, MAX_TIMESTEP - 1) + 1;
+		sit_buffer_created = true;
+		if (length_min > length_max) // the location is blocked for the entire time horizon
+		{
+			sit_buffer.emplace_back(0, 0, 0);
+		}
+		else
 		{
-			int latest_timestep = min(length_max, MAX_TIMESTEP - 1) + 1;
-			if (length_min > length_max) // the location is blocked for the entire time horizon
-			{
-				sit[location].emplace_back(0, 0, 0);
-				return;
-			}
 			if (0 < length_min)
 			{
-				sit[location].emplace_back(0, length_min, 0);
+				sit_buffer.emplace_back(0, length_min, 0);
 			}
 			assert(length_min >= 0);
-			sit[location].emplace_back(length_min, latest_timestep, 0);
+			sit_buffer.emplace_back(length_min, latest_timestep, 0);
 		}
+	}
 
+	bool soft_constraints = false;
+	if (!(goal && length_min > length_max))
+	{
 		// negative constraints
-		const auto& it = ct.find(location); 
-		if (it != ct.end())
-		{
-			for (auto time_range : it->second)
-				insert2RT(location, time_range.first, time_range.second);
-			ct.erase(it);
-		}
+		for (auto it = ct_range.first; it != ct_range.second; ++it)
+			insert2RT(it->second.first, it->second.second);
 
 		// positive constraints
 		if (location < map_size)
 		{
-			for (auto landmark : landmarks)
+			for (int t = 0; t < (int)landmarks.size(); t++)
 			{
-				if (landmark.second != location)
+				if (landmarks[t] >= 0 && landmarks[t] != (int)location)
 				{
-					insert2RT(location, landmark.first, landmark.first + 1);
+					insert2RT(t, t + 1);
 				}
 			}
 		}
 
 		// soft constraints
-		const auto& it2 = cat.find(location);
-		if (it2 != cat.end())
+		for (auto it = cat_range.first; it != cat_range.second; ++it)
+			insertSoftConstraint2RT(it->second.first, it->second.second);
+		soft_constraints = cat_range.first != cat_range.second;
+	}
+
+	if (soft_constraints) // merge the intervals if possible
+	{
+		auto prev = sit_buffer.begin();
+		auto curr = prev;
+		++curr;
+		while (curr != sit_buffer.end())
 		{
-			for (auto time_range : it2->second)
-				insertSoftConstraint2RT(location, time_range.first, time_range.second);
-			cat.erase(it2);
-			// merge the intervals if possible
-			auto prev = sit[location].begin();
-			auto curr = prev;
-			++curr;
-			while (curr != sit[location].end())
+			if (get<1>(*prev) == get<0>(*curr) && get<2>(*prev) == get<2>(*curr) &&
+				(!goal || get<1>(*prev) != (size_t)length_min))
 			{
-				if (get<1>(*prev) == get<0>(*curr) && get<2>(*prev) == get<2>(*curr) &&
-					(location != goal_location || get<1>(*prev) != length_min))
-				{
-					*prev = make_tuple(get<0>(*prev), get<1>(*curr), get<2>(*prev));
-					curr = sit[location].erase(curr);
-				}
-				else
-				{
-					prev = curr;
-					++curr;
-				}
+				*prev = make_tuple(get<0>(*prev), get<1>(*curr), get<2>(*prev));
+				curr = sit_buffer.erase(curr);
+			}
+			else
+			{
+				prev = curr;
+				++curr;
 			}
 		}
 	}
+
+	if (!sit_buffer_created)
+		sit_buffer.emplace_back(0, min(length_max, MAX_TIMESTEP - 1) + 1, 0);
+	pair<int, int> slot((int)sit_intervals.size(), (int)(sit_intervals.size() + sit_buffer.size()));
+	sit_intervals.insert(sit_intervals.end(), sit_buffer.begin(), sit_buffer.end());
+	if (location < map_size)
+		sit_slots[location] = slot;
+	else
+		sit_edge_slots.emplace(edge_slot, location, slot);
+	return slot;
 }
 
 // [lower_bound, upper_bound)
-list<Interval> ReservationTable::get_safe_intervals(size_t location, size_t lower_bound, size_t upper_bound)
+vector<Interval> ReservationTable::get_safe_intervals(size_t location, size_t lower_bound, size_t upper_bound)
 {
-    list<Interval> rst;
+    vector<Interval> rst;
     if (lower_bound >= upper_bound)
         return rst;
 
-	updateSIT(location);
-	
-	const auto& it = sit.find(location);
+    auto slot = updateSIT(location);
 
-    if (it == sit.end())
+    if (slot.first < 0)
     {
 		rst.emplace_back(0, min(length_max, MAX_TIMESTEP - 1) + 1, 0);
 		return rst;
     }
 
-    for(auto interval : sit[location])
+    for (int i = slot.first; i < slot.second; i++)
     {
+        const auto& interval = sit_intervals[i];
         if (lower_bound >= get<1>(interval))
             continue;
         else if (upper_bound <= get<0>(interval))
@@ -302,12 +338,12 @@ list<Interval> ReservationTable::get_safe_intervals(size_t location, size_t lowe
 }
 
 // [lower_bound, upper_bound)
-list<Interval> ReservationTable::get_safe_intervals(size_t from, size_t to, size_t lower_bound, size_t upper_bound)
+vector<Interval> ReservationTable::get_safe_intervals(size_t from, size_t to, size_t lower_bound, size_t upper_bound)
 {
-	list<Interval> safe_vertex_intervals = get_safe_intervals(to, lower_bound, upper_bound);
-	list<Interval> safe_edge_intervals = get_safe_intervals(getEdgeIndex(from, to), lower_bound, upper_bound);
+	vector<Interval> safe_vertex_intervals = get_safe_intervals(to, lower_bound, upper_bound);
+	vector<Interval> safe_edge_intervals = get_safe_intervals(getEdgeIndex(from, to), lower_bound, upper_bound);
 
-	list<Interval> rst;
+	vector<Interval> rst;
 	auto it1 = safe_vertex_intervals.begin();
 	auto it2 = safe_edge_intervals.begin();
 	while (it1 != safe_vertex_intervals.end() && it2 != safe_edge_intervals.end())
@@ -326,34 +362,33 @@ list<Interval> ReservationTable::get_safe_intervals(size_t from, size_t to, size
 
 Interval ReservationTable::get_first_safe_interval(size_t location)
 {
-	updateSIT(location);
-    const auto& it = sit.find(location);
-    if (it == sit.end())
+	auto slot = updateSIT(location);
+    if (slot.first < 0)
 		return Interval(0, min(length_max, MAX_TIMESTEP - 1) + 1, 0);
-    else
-		return it->second.front();
+    assert(slot.first < slot.second);
+    return sit_intervals[slot.first];
 }
 
 // find a safe interval with t_min as given
 bool ReservationTable::find_safe_interval(Interval& interval, size_t location, size_t t_min)
 {
-	if (t_min >= min(length_max, MAX_TIMESTEP - 1) + 1)
+	if (t_min >= (size_t)min(length_max, MAX_TIMESTEP - 1) + 1)
 		return false;
-	updateSIT(location);
-	const auto& it = sit.find(location);
-    if (it == sit.end())
+	auto slot = updateSIT(location);
+    if (slot.first < 0)
     {
 		interval = Interval(t_min, min(length_max, MAX_TIMESTEP - 1) + 1, 0);
 		return true;
     }
-    for( auto i : it->second)
+    for (int j = slot.first; j < slot.second; j++)
     {
-        if ((int)get<0>(i) <= t_min && t_min < (int)get<1>(i))
+        const auto& i = sit_intervals[j];
+        if (get<0>(i) <= t_min && t_min < get<1>(i))
         {
             interval = Interval(t_min, get<1>(i), get<2>(i));
             return true;
         }
-        else if (t_min < (int)get<0>(i))
+        else if (t_min < get<0>(i))
             break;
     }
     return false;
@@ -362,13 +397,15 @@ bool ReservationTable::find_safe_interval(Interval& interval, size_t location, s
 
 void ReservationTable::print() const
 {
-    for (const auto& entry : sit)
+    for (size_t loc = 0; loc < sit_slots.size(); loc++)
     {
-        cout << "loc=" << entry.first << ":";
-        for (const auto& interval : entry.second)
+        if (sit_slots[loc].first < 0)
+            continue;
+        cout << "loc=" << loc << ":";
+        for (int i = sit_slots[loc].first; i < sit_slots[loc].second; i++)
         {
-            cout << "[" << get<0>(interval) << "," << get<1>(interval) << "],";
+            cout << "[" << get<0>(sit_intervals[i]) << "," << get<1>(sit_intervals[i]) << "],";
         }
     }
     cout << endl;
-}
\ No newline at end of file
+}
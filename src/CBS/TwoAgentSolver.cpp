@@ -0,0 +1,132 @@
+#include "TwoAgentSolver.h"
+#include <queue>
+
+int TwoAgentSolver::solve(int min_length1, int min_length2, int lowerbound, int node_limit)
+{
+	min_lengths[0] = min_length1;
+	min_lengths[1] = min_length2;
+	for (int i = 0; i < 2; i++)
+		holding_times[i] = constraint_tables[i]->getHoldingTime();
+
+	std::priority_queue<Node, vector<Node>, Node::compare_node> open;
+	unordered_map<uint64_t, int> best_g_vals; // key -> the smallest g_val of the node generated so far
+	Node root;
+	root.timestep = 0;
+	root.g_val = 0;
+	root.h_val = 0;
+	root.finished = 0;
+	root.time_generated = 0;
+	for (int i = 0; i < 2; i++)
+	{
+		root.locations[i] = solvers[i]->start_location;
+		root.h_val += computeHeuristic(i, root.locations[i], 0);
+	}
+	root.h_val = max(root.h_val, lowerbound);
+	open.push(root);
+	best_g_vals[getKey(root)] = 0;
+	num_generated++;
+
+	vector<pair<int, bool> > moves[2];
+	while (!open.empty())
+	{
+		if (num_expanded >= (uint64_t)node_limit) // node out
+		{
+			optimal = false;
+			return max(lowerbound, open.top().getFVal());
+		}
+		auto curr = open.top();
+		open.pop();
+		if (best_g_vals[getKey(curr)] < curr.g_val) // the node has been generated with a smaller g_val
+			continue;
+		if (curr.finished == 3) // both agents have finished
+		{
+			optimal = true;
+			return curr.g_val;
+		}
+		num_expanded++;
+
+		getMoves(curr, 0, moves[0]);
+		getMoves(curr, 1, moves[1]);
+		for (const auto& move1 : moves[0])
+		{
+			for (const auto& move2 : moves[1])
+			{
+				if (move1.first == move2.first) // vertex conflict
+					continue;
+				if (move1.first == curr.locations[1] && move2.first == curr.locations[0]) // edge conflict
+					continue;
+				Node next;
+				next.locations[0] = move1.first;
+				next.locations[1] = move2.first;
+				next.timestep = curr.timestep + 1;
+				next.finished = (move1.second? 1 : 0) | (move2.second? 2 : 0);
+				next.time_generated = num_generated;
+				next.g_val = curr.g_val;
+				next.h_val = 0;
+				for (int i = 0; i < 2; i++)
+				{
+					if (next.finished & (1 << i))
+						continue;
+					next.g_val++;
+					next.h_val += computeHeuristic(i, next.locations[i], next.timestep);
+				}
+				// no solution costs less than the lower bound, so the nodes below it are expanded depth-first
+				next.h_val = max(next.h_val, lowerbound - next.g_val);
+				auto it = best_g_vals.find(getKey(next));
+				if (it != best_g_vals.end())
+				{
+					if (it->second <= next.g_val)
+						continue;
+					it->second = next.g_val;
+				}
+				else
+				{
+					best_g_vals[getKey(next)] = next.g_val;
+				}
+				open.push(next);
+				num_generated++;
+			}
+		}
+	}
+	optimal = true;
+	return MAX_COST; // no solution
+}
+
+void TwoAgentSolver::getMoves(const Node& curr, int agent, vector<pair<int, bool> >& moves) const
+{
+	moves.clear();
+	int location = curr.locations[agent];
+	if (curr.finished & (1 << agent))
+	{
+		moves.emplace_back(location, true);
+		return;
+	}
+	const auto& constraint_table = *constraint_tables[agent];
+	if (location == solvers[agent]->goal_location && curr.timestep >= holding_times[agent] &&
+		curr.timestep <= constraint_table.length_max) // the agent can finish at the current timestep
+	{
+		moves.emplace_back(location, true);
+	}
+	int next_timestep = curr.timestep + 1;
+	if (next_timestep > constraint_table.length_max) // the agent cannot finish in the future
+		return;
+	for (int next_location : solvers[agent]->getNextLocations(location))
+	{
+		if (constraint_table.constrained(next_location, next_timestep) ||
+			constraint_table.constrained(location, next_location, next_timestep))
+			continue;
+		moves.emplace_back(next_location, false);
+	}
+}
+
+int TwoAgentSolver::computeHeuristic(int agent, int location, int timestep) const
+{
+	return max(solvers[agent]->my_heuristic[location],
+		max(holding_times[agent], min_lengths[agent]) - timestep);
+}
+
+uint64_t TwoAgentSolver::getKey(const Node& node) const
+{
+	uint64_t map_size = solvers[0]->instance.map_size;
+	return ((uint64_t)(node.timestep * 4 + node.finished) * map_size + node.locations[0]) * map_size + node.locations[1];
+}
@@ -0,0 +1,210 @@
+#include "WeightedVertexCover.h"
+#include <algorithm>
+
+
+int WeightedVertexCover::solve(const vector<int>& G, int num_of_nodes, const steady_clock::time_point& _start_time, double _time_limit)
+{
+	assert(num_of_nodes <= MAX_NUM_OF_NODES);
+	vector<int> key;
+	key.reserve(1 + num_of_nodes * (num_of_nodes - 1) / 2);
+	key.push_back(num_of_nodes);
+	for (int i = 0; i < num_of_nodes; i++)
+		for (int j = i + 1; j < num_of_nodes; j++)
+			key.push_back(G[i * num_of_nodes + j]);
+	auto got = memo.find(key);
+	if (got != memo.end())
+	{
+		num_memoization++;
+		return got->second;
+	}
+
+	n = num_of_nodes;
+	weights = G;
+	start_time = _start_time;
+	time_limit = _time_limit;
+	timeout = false;
+	for (int i = 0; i < n; i++)
+	{
+		adj[i] = 0;
+		for (int j = 0; j < n; j++)
+		{
+			if (i != j && weights[i * n + j] > 0)
+				adj[i] |= (uint64_t)1 << j;
+		}
+	}
+	vector<int> lb(n, 0);
+	uint64_t remaining = (n == 64) ? ~(uint64_t)0 : ((uint64_t)1 << n) - 1;
+	int rst = kernelize(lb, remaining);
+	bool exact = true;
+	while (remaining != 0) // solve the connected components of the reduced graph one by one
+	{
+		uint64_t component = remaining & (~remaining + 1);
+		uint64_t open = component;
+		while (open != 0)
+		{
+			int v = __builtin_ctzll(open);
+			open &= open - 1;
+			uint64_t neighbors = adj[v] & remaining & ~component;
+			component |= neighbors;
+			open |= neighbors;
+		}
+		remaining &= ~component;
+		rst += solveComponent(component, lb, exact);
+		if (timeout)
+			return -1;
+	}
+	if (exact)
+	{
+		if (memo.size() >= MAX_MEMO_SIZE)
+			memo.clear();
+		memo[key] = rst;
+	}
+	else
+		num_aborted++;
+	return rst;
+}
+
+// Remove the edges that are covered by the lower bounds of their endpoints and the nodes without edges, and
+// remove every leaf v with neighbor u by fixing x_v = lb_v and requiring x_u >= w_uv - lb_v,
+// as raising x_u instead of x_v never makes a solution worse.
+int WeightedVertexCover::kernelize(vector<int>& lb, uint64_t& remaining)
+{
+	int rst = 0;
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		for (uint64_t rest = remaining; rest != 0; rest &= rest - 1)
+		{
+			int v = __builtin_ctzll(rest);
+			for (uint64_t neighbors = adj[v]; neighbors != 0; neighbors &= neighbors - 1)
+			{
+				int u = __builtin_ctzll(neighbors);
+				if (lb[v] + lb[u] >= weights[v * n + u])
+				{
+					adj[v] &= ~((uint64_t)1 << u);
+					adj[u] &= ~((uint64_t)1 << v);
+				}
+			}
+			if (adj[v] == 0)
+			{
+				rst += lb[v];
+				remaining &= ~((uint64_t)1 << v);
+				changed = true;
+			}
+			else if ((adj[v] & (adj[v] - 1)) == 0) // a leaf
+			{
+				int u = __builtin_ctzll(adj[v]);
+				lb[u] = max(lb[u], weights[v * n + u] - lb[v]);
+				rst += lb[v];
+				adj[v] = 0;
+				adj[u] &= ~((uint64_t)1 << v);
+				remaining &= ~((uint64_t)1 << v);
+				changed = true;
+			}
+		}
+	}
+	return rst;
+}
+
+int WeightedVertexCover::lowerBound(const vector<int>& need, uint64_t unassigned) const
+{
+	int rst = 0;
+	for (uint64_t rest = unassigned; rest != 0; rest &= rest - 1)
+		rst += need[__builtin_ctzll(rest)];
+	// the residual weights of the edges in a matching have to be covered separately
+	uint64_t unmatched = unassigned;
+	while (unmatched != 0)
+	{
+		int v = __builtin_ctzll(unmatched);
+		unmatched &= unmatched - 1;
+		int best_residual = 0, best_u = -1;
+		for (uint64_t neighbors = adj[v] & unmatched; neighbors != 0; neighbors &= neighbors - 1)
+		{
+			int u = __builtin_ctzll(neighbors);
+			int residual = weights[v * n + u] - need[v] - need[u];
+			if (residual > best_residual)
+			{
+				best_residual = residual;
+				best_u = u;
+			}
+		}
+		if (best_u >= 0)
+		{
+			rst += best_residual;
+			unmatched &= ~((uint64_t)1 << best_u);
+		}
+	}
+	return rst;
+}
+
+int WeightedVertexCover::solveComponent(uint64_t component, const vector<int>& lb, bool& exact)
+{
+	order.clear();
+	for (uint64_t rest = component; rest != 0; rest &= rest - 1)
+		order.push_back(__builtin_ctzll(rest));
+	std::sort(order.begin(), order.end(), [&](int v1, int v2) // high degree first
+		{ return __builtin_popcountll(adj[v1]) > __builtin_popcountll(adj[v2]); });
+
+	// an initial solution: every node takes the largest value that its remaining edges require
+	vector<int> need(lb);
+	best = 0;
+	uint64_t unassigned = component;
+	for (int v : order)
+	{
+		unassigned &= ~((uint64_t)1 << v);
+		int value = need[v];
+		for (uint64_t neighbors = adj[v] & unassigned; neighbors != 0; neighbors &= neighbors - 1)
+			value = max(value, weights[v * n + __builtin_ctzll(neighbors)]);
+		best += value;
+	}
+
+	needs.resize(order.size() + 1);
+	needs[0] = lb;
+	num_expanded = 0;
+	branch(0, 0, component);
+	if (num_expanded > NODE_LIMIT)
+	{
+		exact = false;
+		return lowerBound(lb, component);
+	}
+	return best;
+}
+
+void WeightedVertexCover::branch(int k, int sum, uint64_t unassigned)
+{
+	if (timeout || num_expanded > NODE_LIMIT)
+		return;
+	num_expanded++;
+	if ((num_expanded & 1023) == 0 && getElapsedTime(start_time) > time_limit)
+	{
+		timeout = true;
+		return;
+	}
+	if (sum + lowerBound(needs[k], unassigned) >= best)
+		return;
+	if (k == (int)order.size())
+	{
+		best = sum;
+		return;
+	}
+	int v = order[k];
+	uint64_t rest = unassigned & ~((uint64_t)1 << v);
+	// a value larger than w_vu - need_u does not help to cover any edge (v, u)
+	int max_value = needs[k][v];
+	for (uint64_t neighbors = adj[v] & rest; neighbors != 0; neighbors &= neighbors - 1)
+	{
+		int u = __builtin_ctzll(neighbors);
+		max_value = max(max_value, weights[v * n + u] - needs[k][u]);
+	}
+	for (int value = needs[k][v]; value <= max_value; value++)
+	{
+		needs[k + 1] = needs[k];
+		for (uint64_t neighbors = adj[v] & rest; neighbors != 0; neighbors &= neighbors - 1)
+		{
+			int u = __builtin_ctzll(neighbors);
+			needs[k + 1][u] = max(needs[k + 1][u], weights[v * n + u] - value);
+		}
+		branch(k + 1, sum + value, rest);
+	}
+}
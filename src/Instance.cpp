@@ -2,6 +2,7 @@
 #include <algorithm>    // std::shuffle
 #include <random>      // std::default_random_engine
 #include <chrono>       // std::chrono::system_clock
+#include <queue>
 #include"Instance.h"
 
 int RANDOM_WALK_STEPS = 100000;
@@ -25,6 +26,7 @@ Instance::Instance(const string& map_fname, const string& agent_fname,
 			exit(-1);
 		}
 	}
+	findCorridors();
 
 	succ = loadAgents();
 	if (!succ)
@@ -300,6 +302,93 @@ bool Instance::loadMap()
 }
 
 
+void Instance::findCorridors()
+{
+	corridor_ids.assign(map_size, -1);
+	corridor_indices.assign(map_size, -1);
+	corridors.clear();
+	for (int loc = 0; loc < map_size; loc++)
+	{
+		if (my_map[loc] || corridor_ids[loc] >= 0 || getDegree(loc) != 2)
+			continue;
+		// walk to one end of the chain
+		int prev = getNeighbors(loc).front();
+		int curr = loc;
+		while (prev != loc && getDegree(prev) == 2)
+		{
+			auto neighbors = getNeighbors(prev);
+			int next = (neighbors.front() == curr) ? neighbors.back() : neighbors.front();
+			curr = prev;
+			prev = next;
+		}
+		Corridor corridor;
+		corridor.endpoints[0] = (prev == loc) ? -1 : prev; // prev == loc for a ring
+		// walk to the other end and label the cells on the way
+		while (true)
+		{
+			corridor_ids[curr] = (int)corridors.size();
+			corridor_indices[curr] = (int)corridor.cells.size();
+			corridor.cells.push_back(curr);
+			auto neighbors = getNeighbors(curr);
+			int next = (neighbors.front() == prev) ? neighbors.back() : neighbors.front();
+			prev = curr;
+			curr = next;
+			if (getDegree(curr) != 2)
+			{
+				corridor.endpoints[1] = curr;
+				break;
+			}
+			if (corridor_ids[curr] >= 0) // back to the beginning of a ring
+			{
+				corridor.endpoints[1] = -1;
+				break;
+			}
+		}
+		corridors.push_back(corridor);
+	}
+	bypass_lengths.assign(corridors.size(), -1);
+}
+
+
+int Instance::getBypassLength(int id) const
+{
+	std::lock_guard<std::mutex> lock(bypass_mutex);
+	if (bypass_lengths[id] >= 0)
+		return bypass_lengths[id];
+	const auto& corridor = corridors[id];
+	int start = corridor.endpoints[0], goal = corridor.endpoints[1];
+	int length = MAX_TIMESTEP;
+	if (start == goal && start >= 0)
+		length = 0;
+	else if (start >= 0 && goal >= 0)
+	{ // BFS from one endpoint to the other without entering the corridor
+		vector<int> distances(map_size, -1);
+		std::queue<int> open;
+		distances[start] = 0;
+		open.push(start);
+		while (!open.empty() && length == MAX_TIMESTEP)
+		{
+			int curr = open.front();
+			open.pop();
+			for (int next : getNeighbors(curr))
+			{
+				if (distances[next] >= 0 || corridor_ids[next] == id)
+					continue;
+				distances[next] = distances[curr] + 1;
+				if (next == goal)
+				{
+					length = distances[next];
+					break;
+				}
+				open.push(next);
+			}
+		}
+	}
+	bypass_lengths[id] = length;
+	return length;
+}
+
+
 void Instance::printMap() const
 {
 	for (int i = 0; i< num_of_rows; i++)
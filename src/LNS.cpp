@@ -1,13 +1,52 @@
 #include "LNS.h"
 #include <queue>
+#include <thread>
+#include <condition_variable>
 
 LNS::LNS(const Instance& instance, double time_limit, string init_algo_name, string replan_algo_name, string destory_name,
-         int neighbor_size, int num_of_iterations, int screen, PIBTPPS_option pipp_option) :
-         instance(instance), time_limit(time_limit), init_algo_name(std::move(init_algo_name)),
-         replan_algo_name(replan_algo_name), neighbor_size(neighbor_size), num_of_iterations(num_of_iterations),
-         screen(screen), path_table(instance.map_size),pipp_option(pipp_option), replan_time_limit(time_limit / 100)
+         int neighbor_size, int num_of_iterations, int screen, PIBTPPS_option pipp_option, int num_of_threads,
+         bool init_lns, double portfolio_grace_period, int window, int commit_steps, bool parallel_root) :
+         instance(instance), time_limit(time_limit), replan_time_limit(time_limit / 100),
+         init_algo_name(std::move(init_algo_name)), replan_algo_name(replan_algo_name), screen(screen),
+         neighbor_size(neighbor_size), num_of_iterations(num_of_iterations), num_of_threads(num_of_threads),
+         parallel_root(parallel_root), init_lns(init_lns), portfolio_grace_period(portfolio_grace_period),
+         window(window > 0 ? window : MAX_TIMESTEP), commit_steps(commit_steps),
+         path_table(instance.map_size), heuristic_cache(path_table), pipp_option(pipp_option),
+         random_generator((unsigned)rand()) // seeded by the driver
 {
     start_time = Time::now();
+    if (init_lns)
+        this->init_algo_name = "InitLNS";
+    else if (this->init_algo_name.find('+') != string::npos) // e.g., PP+PIBT+EECBS
+    {
+        size_t begin = 0;
+        while (begin <= this->init_algo_name.size())
+        {
+            size_t end = min(this->init_algo_name.find('+', begin), this->init_algo_name.size());
+            portfolio.push_back(this->init_algo_name.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        for (const auto& name : portfolio)
+        {
+            if (name != "EECBS" && name != "PP" && name != "PIBT" && name != "PPS" && name != "winPIBT" &&
+                name != "CBS" && name != "InitLNS")
+            {
+                cerr <<  "Initial MAPF solver " << name << " does not exist!" << endl;
+                exit(-1);
+            }
+        }
+    }
+    if (this->window < MAX_TIMESTEP)
+    {
+        if (this->init_algo_name != "PP" || replan_algo_name != "PP")
+        {
+            cerr << "Windowed LNS only supports PP as the initial and replanning algorithms" << endl;
+            exit(-1);
+        }
+        if (this->commit_steps <= 0 || this->commit_steps > this->window)
+            this->commit_steps = max(this->window / 2, 1);
+        path_table = PathTable(instance.map_size, this->window);
+    }
     if (destory_name == "Adaptive")
     {
         ALNS = true;
@@ -43,34 +82,83 @@ bool LNS::run()
         sum_of_distances += agent.path_planner.my_heuristic[agent.path_planner.start_location];
     }
 
-    initial_solution_runtime = 0;
+    start_time = Time::now();
+    if (window < MAX_TIMESTEP)
+    {
+        if (!runRollingHorizon())
+            return false;
+    }
+    else
+    {
+        if (!findInitialSolution())
+            return false; // terminate because no initial solution is found
+        improveSolution(time_limit);
+    }
+
+    average_group_size = - iteration_stats.front().num_of_agents * num_of_windows;
+    for (const auto& data : iteration_stats)
+        average_group_size += data.num_of_agents;
+    if (average_group_size > 0)
+        average_group_size /= (double)(iteration_stats.size() - num_of_windows);
+    cout << getSolverName() << ": Iterations = " << iteration_stats.size() << ", "
+         << "solution cost = " << sum_of_costs << ", "
+         << "initial solution cost = " << initial_sum_of_costs << ", "
+         << "runtime = " << runtime << ", "
+         << "group size = " << average_group_size << ", "
+         << "failed iterations = " << num_of_failures << endl;
+    if (window < MAX_TIMESTEP)
+        cout << "Windows = " << num_of_windows << ", "
+             << "cost of the first window plan (collision-free only within the window) = "
+             << first_window_sum_of_costs << endl;
+    if (screen >= 2)
+        cout << "Heuristic cache: " << heuristic_cache.num_pair_hits << " hits and "
+             << heuristic_cache.num_pair_misses << " misses of 2-agent sub-problems, "
+             << heuristic_cache.num_mdd_hits << " hits and "
+             << heuristic_cache.num_mdd_misses << " misses of root MDDs" << endl;
+    return true;
+}
+
+// retry the initial solver until it succeeds or runs out of time
+bool LNS::findInitialSolution()
+{
+    initial_solution_runtime = ((fsec)(Time::now() - start_time)).count();
     bool succ = false;
     int count = 0;
-    start_time = Time::now();
     while (!succ && initial_solution_runtime < time_limit)
     {
         succ = getInitialSolution();
         initial_solution_runtime = ((fsec)(Time::now() - start_time)).count();
         count++;
     }
-    iteration_stats.emplace_back(neighbor.agents.size(),
-                                 initial_sum_of_costs, initial_solution_runtime, init_algo_name);
+    iteration_stats.emplace_back(neighbor.agents.size(), getSolutionCost(), initial_solution_runtime,
+                                 portfolio.empty() ? init_algo_name : portfolio_winner);
     runtime = initial_solution_runtime;
     if (succ)
     {
         if (screen >= 1)
-            cout << "Initial solution cost = " << initial_sum_of_costs << ", "
-                 << "runtime = " << initial_solution_runtime << endl;
+            cout << (committed_paths.empty() ? "Initial solution cost = " : "Initial cost with the committed paths = ")
+                 << getSolutionCost() << ", runtime = " << initial_solution_runtime << endl;
     }
     else
     {
         cout << "Failed to find an initial solution in "
              << runtime << " seconds and  " << count << " iterations" << endl;
-        return false; // terminate because no initial solution is found
     }
+    return succ;
+}
 
-    while (runtime < time_limit && iteration_stats.size() <= num_of_iterations)
+// run LNS iterations until end_time or until num_of_iterations iterations succeed in generating neighborhoods
+void LNS::improveSolution(double end_time)
+{
+    size_t num_of_stats = iteration_stats.size();
+    bool succ;
+    while (runtime < end_time && iteration_stats.size() - num_of_stats < num_of_iterations)
     {
+        // in the rolling-horizon mode, stop improving the window once no agent has delays,
+        // e.g., when every agent only waits at its goal
+        if (!committed_paths.empty() &&
+            std::all_of(agents.begin(), agents.end(), [](const Agent& agent) { return agent.getNumOfDelays() == 0; }))
+            break;
         runtime =((fsec)(Time::now() - start_time)).count();
         if(screen >= 1)
             validateSolution();
@@ -91,7 +179,7 @@ bool LNS::run()
                     neighbor.agents[i] = i;
                 if (neighbor.agents.size() > neighbor_size)
                 {
-                    std::random_shuffle(neighbor.agents.begin(), neighbor.agents.end());
+                    std::shuffle(neighbor.agents.begin(), neighbor.agents.end(), random_generator);
                     neighbor.agents.resize(neighbor_size);
                 }
                 succ = true;
@@ -100,7 +188,7 @@ bool LNS::run()
                 cerr << "Wrong neighbor generation strategy" << endl;
                 exit(-1);
         }
-        if(!succ)
+        if(!succ || neighbor.agents.empty())
             continue;
 
         // store the neighbor information
@@ -120,6 +208,10 @@ bool LNS::run()
             succ = runCBS();
         else if (replan_algo_name == "PP")
             succ = runPP();
+        else if (replan_algo_name == "PIBT")
+            succ = runPIBT();
+        else if (replan_algo_name == "winPIBT")
+            succ = runWinPIBT();
         else
         {
             cerr << "Wrong replanning strategy" << endl;
@@ -141,26 +233,105 @@ bool LNS::run()
         if (screen >= 1)
             cout << "Iteration " << iteration_stats.size() << ", "
                  << "group size = " << neighbor.agents.size() << ", "
-                 << "solution cost = " << sum_of_costs << ", "
+                 << "solution cost = " << getSolutionCost() << ", "
                  << "remaining time = " << time_limit - runtime << endl;
-        iteration_stats.emplace_back(neighbor.agents.size(), sum_of_costs, runtime, replan_algo_name);
+        iteration_stats.emplace_back(neighbor.agents.size(), getSolutionCost(), runtime, replan_algo_name);
     }
+}
 
+// Plan the paths from the current locations with collisions resolved only within the window, improve them by LNS,
+// and commit their first commit_steps timesteps. Repeat from the new locations until every agent reaches its goal
+// within the committed timesteps, so the memory of the path table is bounded by the window instead of the makespan.
+bool LNS::runRollingHorizon()
+{
+    vector<int> start_locations(agents.size());
+    committed_paths.assign(agents.size(), Path());
+    finish_times.assign(agents.size(), 0);
+    for (int i = 0; i < (int)agents.size(); i++)
+    {
+        start_locations[i] = agents[i].path_planner.start_location;
+        committed_paths[i].emplace_back(start_locations[i]);
+    }
+    committed_timestep = 0;
+    num_of_windows = 0;
+    double window_time = -1; // time for improving the paths of each window
+    bool succ;
+    while (true)
+    {
+        path_table.reset();
+        succ = findInitialSolution();
+        if (!succ)
+            break;
+        num_of_windows++;
+        if (first_window_sum_of_costs < 0)
+            first_window_sum_of_costs = initial_sum_of_costs;
+        int makespan = 0;
+        for (const auto& agent : agents)
+            makespan = max(makespan, (int)agent.path.size() - 1);
+        if (window_time < 0) // split half of the time among the windows of the first makespan, and keep the rest for delays
+            window_time = time_limit * commit_steps / (2.0 * max(makespan, commit_steps));
+        improveSolution(runtime + min(window_time, (time_limit - runtime) / 2));
+        makespan = 0;
+        for (const auto& agent : agents)
+            makespan = max(makespan, (int)agent.path.size() - 1);
+        int steps = min(makespan, commit_steps);
+        for (int i = 0; i < (int)agents.size(); i++)
+        {
+            const auto& path = agents[i].path;
+            int goal = agents[i].path_planner.goal_location;
+            for (int t = 1; t <= steps; t++)
+            {
+                int loc = path[min(t, (int)path.size() - 1)].location;
+                if (loc == goal && committed_paths[i].back().location != goal)
+                    finish_times[i] = committed_timestep + t;
+                committed_paths[i].emplace_back(loc);
+            }
+            agents[i].path_planner.start_location = committed_paths[i].back().location;
+        }
+        committed_timestep += steps;
+        if (screen >= 1)
+            cout << "Commit " << steps << " timesteps, " << committed_timestep << " timesteps in total" << endl;
+        if (makespan <= commit_steps) // every agent has reached its goal and stays there
+            break;
+    }
 
-    average_group_size = - iteration_stats.front().num_of_agents;
-    for (const auto& data : iteration_stats)
-        average_group_size += data.num_of_agents;
-    if (average_group_size > 0)
-        average_group_size /= (double)(iteration_stats.size() - 1);
-    cout << getSolverName() << ": Iterations = " << iteration_stats.size() << ", "
-         << "solution cost = " << sum_of_costs << ", "
-         << "initial solution cost = " << initial_sum_of_costs << ", "
-         << "runtime = " << runtime << ", "
-         << "group size = " << average_group_size << ", "
-         << "failed iterations = " << num_of_failures << endl;
+    for (int i = 0; i < (int)agents.size(); i++)
+        agents[i].path_planner.start_location = start_locations[i];
+    if (!succ)
+        return false;
+    path_table = PathTable(instance.map_size);
+    sum_of_costs = 0;
+    for (int i = 0; i < (int)agents.size(); i++)
+    {
+        agents[i].path.assign(committed_paths[i].begin(), committed_paths[i].begin() + finish_times[i] + 1);
+        path_table.insertPath(agents[i].id, agents[i].path);
+        sum_of_costs += finish_times[i];
+    }
+    committed_paths.clear();
+    finish_times.clear();
+    // the committed paths are the first collision-free solution over the full horizon
+    initial_sum_of_costs = sum_of_costs;
+    initial_solution_runtime = ((fsec)(Time::now() - start_time)).count();
+    runtime = initial_solution_runtime;
     return true;
 }
 
+// the sum of costs of the committed paths followed by the current paths
+int LNS::getSolutionCost() const
+{
+    if (committed_paths.empty())
+        return sum_of_costs;
+    int cost = 0;
+    for (int i = 0; i < (int)agents.size(); i++)
+    {
+        if (agents[i].path.size() > 1)
+            cost += committed_timestep + (int)agents[i].path.size() - 1;
+        else // the agent stays at its goal
+            cost += finish_times[i];
+    }
+    return cost;
+}
+
 
 bool LNS::getInitialSolution()
 {
@@ -169,8 +340,13 @@ bool LNS::getInitialSolution()
         neighbor.agents[i] = i;
     neighbor.old_sum_of_costs = MAX_COST;
     neighbor.sum_of_costs = 0;
+    neighbor.old_paths.clear();
     bool succ = false;
-    if (init_algo_name == "EECBS")
+    if (!portfolio.empty())
+        succ = runPortfolio();
+    else if (init_lns)
+        succ = runInitLNS();
+    else if (init_algo_name == "EECBS")
         succ = runEECBS();
     else if (init_algo_name == "PP")
         succ = runPP();
@@ -209,41 +385,52 @@ bool LNS::runEECBS()
         search_engines.push_back(&agents[i].path_planner);
     }
 
-    ECBS ecbs(search_engines, path_table, screen - 1);
-    ecbs.setPrioritizeConflicts(true);
-    ecbs.setDisjointSplitting(false);
-    ecbs.setBypass(true);
-    ecbs.setRectangleReasoning(true);
-    ecbs.setCorridorReasoning(true);
-    ecbs.setHeuristicType(heuristics_type::WDG, heuristics_type::GLOBAL);
-    ecbs.setTargetReasoning(true);
-    ecbs.setMutexReasoning(false);
-    ecbs.setConflictSelectionRule(conflict_selection::EARLIEST);
-    ecbs.setNodeSelectionRule(node_selection::NODE_CONFLICTPAIRS);
-    ecbs.setSavingStats(false);
+    if (ecbs == nullptr) // the solver and its memory are reused across iterations
+    {
+        ecbs.reset(new ECBS(search_engines, path_table, screen - 1));
+        ecbs->setPrioritizeConflicts(true);
+        ecbs->setDisjointSplitting(false);
+        ecbs->setBypass(true);
+        ecbs->setRectangleReasoning(true);
+        ecbs->setCorridorReasoning(true);
+        ecbs->setHeuristicType(heuristics_type::WDG, heuristics_type::GLOBAL);
+        ecbs->setTargetReasoning(true);
+        ecbs->setMutexReasoning(false);
+        ecbs->setConflictSelectionRule(conflict_selection::EARLIEST);
+        ecbs->setNodeSelectionRule(node_selection::NODE_CONFLICTPAIRS);
+        ecbs->setSavingStats(false);
+        ecbs->setNumOfThreads(num_of_threads);
+        ecbs->setParallelRoot(parallel_root);
+        ecbs->setInterruptFlag(interrupted);
+    }
+    else
+    {
+        ecbs->reset(search_engines);
+    }
+    ecbs->setHeuristicCache(&heuristic_cache, neighbor.agents);
     double w;
     if (iteration_stats.empty())
         w = 2; // initial run
     else
         w = 1.1; // replan
-    ecbs.setHighLevelSolver(high_level_solver_type::EES, w);
+    ecbs->setHighLevelSolver(high_level_solver_type::EES, w);
     runtime = ((fsec)(Time::now() - start_time)).count();
     double T = time_limit - runtime;
     if (!iteration_stats.empty()) // replan
         T = min(T, replan_time_limit);
-    bool succ = ecbs.solve(T, 0);
-    if (succ && ecbs.solution_cost < neighbor.old_sum_of_costs) // accept new paths
+    bool succ = ecbs->solve(T, 0);
+    if (succ && ecbs->solution_cost < neighbor.old_sum_of_costs) // accept new paths
     {
         auto id = neighbor.agents.begin();
         for (size_t i = 0; i < neighbor.agents.size(); i++)
         {
-            agents[*id].path = *ecbs.paths[i];
+            agents[*id].path = *ecbs->paths[i];
             path_table.insertPath(agents[*id].id, agents[*id].path);
             ++id;
         }
-        neighbor.sum_of_costs = ecbs.solution_cost;
+        neighbor.sum_of_costs = ecbs->solution_cost;
         if (sum_of_costs_lowerbound < 0)
-            sum_of_costs_lowerbound = ecbs.getLowerBound();
+            sum_of_costs_lowerbound = ecbs->getLowerBound();
     }
     else // stick to old paths
     {
@@ -272,36 +459,47 @@ bool LNS::runCBS()
         search_engines.push_back(&agents[i].path_planner);
     }
 
-    CBS cbs(search_engines, path_table, screen - 1);
-    cbs.setPrioritizeConflicts(true);
-    cbs.setDisjointSplitting(false);
-    cbs.setBypass(true);
-    cbs.setRectangleReasoning(true);
-    cbs.setCorridorReasoning(true);
-    cbs.setHeuristicType(heuristics_type::WDG, heuristics_type::ZERO);
-    cbs.setTargetReasoning(true);
-    cbs.setMutexReasoning(false);
-    cbs.setConflictSelectionRule(conflict_selection::EARLIEST);
-    cbs.setNodeSelectionRule(node_selection::NODE_CONFLICTPAIRS);
-    cbs.setSavingStats(false);
-    cbs.setHighLevelSolver(high_level_solver_type::ASTAR, 1);
+    if (cbs == nullptr) // the solver and its memory are reused across iterations
+    {
+        cbs.reset(new CBS(search_engines, path_table, screen - 1));
+        cbs->setPrioritizeConflicts(true);
+        cbs->setDisjointSplitting(false);
+        cbs->setBypass(true);
+        cbs->setRectangleReasoning(true);
+        cbs->setCorridorReasoning(true);
+        cbs->setHeuristicType(heuristics_type::WDG, heuristics_type::ZERO);
+        cbs->setTargetReasoning(true);
+        cbs->setMutexReasoning(false);
+        cbs->setConflictSelectionRule(conflict_selection::EARLIEST);
+        cbs->setNodeSelectionRule(node_selection::NODE_CONFLICTPAIRS);
+        cbs->setSavingStats(false);
+        cbs->setHighLevelSolver(high_level_solver_type::ASTAR, 1);
+        cbs->setNumOfThreads(num_of_threads);
+        cbs->setParallelRoot(parallel_root);
+        cbs->setInterruptFlag(interrupted);
+    }
+    else
+    {
+        cbs->reset(search_engines);
+    }
+    cbs->setHeuristicCache(&heuristic_cache, neighbor.agents);
     runtime = ((fsec)(Time::now() - start_time)).count();
     double T = time_limit - runtime; // time limit
     if (!iteration_stats.empty()) // replan
         T = min(T, replan_time_limit);
-    bool succ = cbs.solve(T, 0);
-    if (succ && cbs.solution_cost < neighbor.old_sum_of_costs) // accept new paths
+    bool succ = cbs->solve(T, 0);
+    if (succ && cbs->solution_cost < neighbor.old_sum_of_costs) // accept new paths
     {
         auto id = neighbor.agents.begin();
         for (size_t i = 0; i < neighbor.agents.size(); i++)
         {
-            agents[*id].path = *cbs.paths[i];
+            agents[*id].path = *cbs->paths[i];
             path_table.insertPath(agents[*id].id, agents[*id].path);
             ++id;
         }
-        neighbor.sum_of_costs = cbs.solution_cost;
+        neighbor.sum_of_costs = cbs->solution_cost;
         if (sum_of_costs_lowerbound < 0)
-            sum_of_costs_lowerbound = cbs.getLowerBound();
+            sum_of_costs_lowerbound = cbs->getLowerBound();
     }
     else // stick to old paths
     {
@@ -323,7 +521,7 @@ bool LNS::runCBS()
 bool LNS::runPP()
 {
     auto shuffled_agents = neighbor.agents;
-    std::random_shuffle(shuffled_agents.begin(), shuffled_agents.end());
+    std::shuffle(shuffled_agents.begin(), shuffled_agents.end(), random_generator);
     if (screen >= 2) {
         for (auto id : shuffled_agents)
             cout << id << "(" << agents[id].path_planner.my_heuristic[agents[id].path_planner.start_location] <<
@@ -335,10 +533,10 @@ bool LNS::runPP()
     neighbor.sum_of_costs = 0;
     runtime = ((fsec)(Time::now() - start_time)).count();
     double T = time_limit - runtime; // time limit
-    if (!iteration_stats.empty()) // replan
+    if (!neighbor.old_paths.empty()) // replan
         T = min(T, replan_time_limit);
     auto time = Time::now();
-    while (p != shuffled_agents.end() && ((fsec)(Time::now() - time)).count() < T)
+    while (p != shuffled_agents.end() && ((fsec)(Time::now() - time)).count() < T && !isInterrupted())
     {
         int id = *p;
         if (screen >= 3)
@@ -388,18 +586,228 @@ bool LNS::runPP()
     }
 }
 
+// Plan the agents one by one while minimizing the number of collisions with the agents planned so far,
+// and then repair the collisions by LNS, which replans the colliding agents in the same way and
+// keeps the new paths only if they do not increase the number of colliding pairs.
+bool LNS::runInitLNS()
+{
+    path_table_wc = PathTableWC(instance.map_size);
+    collision_graph.assign(agents.size(), set<int>());
+    auto shuffled_agents = neighbor.agents;
+    std::shuffle(shuffled_agents.begin(), shuffled_agents.end(), random_generator);
+    for (int id : shuffled_agents)
+    {
+        agents[id].path = agents[id].path_planner.findMinCollisionPath(path_table_wc);
+        path_table_wc.insertPath(agents[id].id, agents[id].path);
+    }
+    int num_of_colliding_pairs = 0;
+    for (int id : shuffled_agents)
+    {
+        path_table_wc.getCollidingAgents(id, agents[id].path, collision_graph[id]);
+        num_of_colliding_pairs += (int)collision_graph[id].size();
+    }
+    num_of_colliding_pairs /= 2;
+    if (screen >= 1)
+        cout << "Collision-tolerant initial solution has " << num_of_colliding_pairs << " colliding pairs" << endl;
+
+    int num_of_iterations = 0;
+    vector< set<int> > old_colliding_agents;
+    runtime = ((fsec)(Time::now() - start_time)).count();
+    while (num_of_colliding_pairs > 0 && runtime < time_limit && !isInterrupted())
+    {
+        num_of_iterations++;
+        if (!generateNeighborByCollisionGraph())
+            continue;
+
+        // remove the neighborhood from the path table and the collision graph
+        neighbor.old_paths.resize(neighbor.agents.size());
+        old_colliding_agents.resize(neighbor.agents.size());
+        neighbor.old_sum_of_costs = 0;
+        for (int i = 0; i < (int)neighbor.agents.size(); i++)
+        {
+            int id = neighbor.agents[i];
+            neighbor.old_paths[i] = agents[id].path;
+            neighbor.old_sum_of_costs += (int)agents[id].path.size() - 1;
+            old_colliding_agents[i] = collision_graph[id];
+            path_table_wc.deletePath(id, agents[id].path);
+        }
+        int new_colliding_pairs = num_of_colliding_pairs;
+        for (int id : neighbor.agents)
+        {
+            for (int a : collision_graph[id])
+            {
+                if (collision_graph[a].erase(id) > 0)
+                    new_colliding_pairs--;
+            }
+            collision_graph[id].clear();
+        }
+
+        // replan the neighborhood
+        shuffled_agents = neighbor.agents;
+        std::shuffle(shuffled_agents.begin(), shuffled_agents.end(), random_generator);
+        neighbor.sum_of_costs = 0;
+        for (int id : shuffled_agents)
+        {
+            agents[id].path = agents[id].path_planner.findMinCollisionPath(path_table_wc);
+            path_table_wc.insertPath(id, agents[id].path);
+            neighbor.sum_of_costs += (int)agents[id].path.size() - 1;
+        }
+        for (int id : shuffled_agents)
+        {
+            set<int> colliding_agents;
+            path_table_wc.getCollidingAgents(id, agents[id].path, colliding_agents);
+            for (int a : colliding_agents)
+            {
+                if (collision_graph[id].insert(a).second)
+                {
+                    collision_graph[a].insert(id);
+                    new_colliding_pairs++;
+                }
+            }
+        }
+
+        if (new_colliding_pairs < num_of_colliding_pairs ||
+            (new_colliding_pairs == num_of_colliding_pairs && neighbor.sum_of_costs <= neighbor.old_sum_of_costs))
+        {
+            num_of_colliding_pairs = new_colliding_pairs; // accept new paths
+        }
+        else // stick to old paths
+        {
+            for (int id : neighbor.agents)
+            {
+                path_table_wc.deletePath(id, agents[id].path);
+                for (int a : collision_graph[id])
+                    collision_graph[a].erase(id);
+                collision_graph[id].clear();
+            }
+            for (int i = 0; i < (int)neighbor.agents.size(); i++)
+            {
+                int id = neighbor.agents[i];
+                agents[id].path = neighbor.old_paths[i];
+                path_table_wc.insertPath(id, agents[id].path);
+                collision_graph[id] = old_colliding_agents[i];
+                for (int a : collision_graph[id])
+                    collision_graph[a].insert(id);
+            }
+        }
+        runtime = ((fsec)(Time::now() - start_time)).count();
+        if (screen >= 2)
+            cout << "Init LNS iteration " << num_of_iterations << ", "
+                 << "group size = " << neighbor.agents.size() << ", "
+                 << "colliding pairs = " << num_of_colliding_pairs << ", "
+                 << "remaining time = " << time_limit - runtime << endl;
+    }
+    if (screen >= 1)
+        cout << "Init LNS: " << num_of_iterations << " iterations, "
+             << num_of_colliding_pairs << " colliding pairs left" << endl;
+
+    // restore the neighborhood of the whole problem, as getInitialSolution expects
+    neighbor.agents.resize(agents.size());
+    for (int i = 0; i < (int)agents.size(); i++)
+        neighbor.agents[i] = i;
+    neighbor.old_paths.clear();
+    neighbor.old_sum_of_costs = MAX_COST;
+    if (num_of_colliding_pairs > 0)
+        return false;
+
+    path_table_wc = PathTableWC();
+    collision_graph.clear();
+    neighbor.sum_of_costs = 0;
+    for (auto& agent : agents)
+    {
+        path_table.insertPath(agent.id, agent.path);
+        neighbor.sum_of_costs += (int)agent.path.size() - 1;
+    }
+    return true;
+}
+
+LNS::LNS(const LNS& parent, const string& init_algo_name, const std::atomic<bool>* interrupted, unsigned seed) :
+         agents(parent.agents), instance(parent.instance), time_limit(parent.time_limit),
+         replan_time_limit(parent.replan_time_limit), init_algo_name(init_algo_name),
+         replan_algo_name(parent.replan_algo_name), screen(parent.screen - 1), neighbor_size(parent.neighbor_size),
+         num_of_iterations(parent.num_of_iterations), num_of_threads(1), parallel_root(false), init_lns(init_algo_name == "InitLNS"),
+         portfolio_grace_period(0), interrupted(interrupted), window(MAX_TIMESTEP), commit_steps(0),
+         start_time(parent.start_time),
+         path_table(instance.map_size), heuristic_cache(path_table), pipp_option(parent.pipp_option),
+         random_generator(seed) {}
+
+// Run the initial solvers of the portfolio concurrently, and retry each of them until it succeeds.
+// Once the first solution is found, the other solvers may keep running for portfolio_grace_period seconds
+// to find a cheaper one before they are interrupted.
+bool LNS::runPortfolio()
+{
+    std::atomic<bool> stop(false);
+    vector< std::unique_ptr<LNS> > members;
+    for (const auto& name : portfolio)
+        members.emplace_back(new LNS(*this, name, &stop, random_generator()));
+    std::mutex mtx;
+    std::condition_variable cv;
+    int num_of_finished = 0;
+    bool found = false;
+    vector<std::thread> threads;
+    for (auto& member : members)
+    {
+        LNS* m = member.get();
+        threads.emplace_back([&, m]()
+        {
+            getTieBreakGenerator().seed(m->random_generator());
+            bool succ = false;
+            while (!succ && !stop && ((fsec)(Time::now() - start_time)).count() < time_limit)
+                succ = m->getInitialSolution();
+            std::lock_guard<std::mutex> lock(mtx);
+            num_of_finished++;
+            found = found || succ;
+            if (succ && screen >= 1)
+                cout << m->init_algo_name << " finds an initial solution of cost " << m->initial_sum_of_costs
+                     << " at " << ((fsec)(Time::now() - start_time)).count() << " seconds" << endl;
+            cv.notify_one();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [&]() { return found || num_of_finished == (int)members.size(); });
+        if (found && portfolio_grace_period > 0)
+            cv.wait_for(lock, std::chrono::duration<double>(portfolio_grace_period),
+                        [&]() { return num_of_finished == (int)members.size(); });
+    }
+    stop = true;
+    for (auto& thread : threads)
+        thread.join();
+
+    const LNS* best = nullptr;
+    for (const auto& member : members)
+    {
+        if (member->initial_sum_of_costs >= 0 &&
+            (best == nullptr || member->initial_sum_of_costs < best->initial_sum_of_costs))
+            best = member.get();
+    }
+    if (best == nullptr)
+        return false;
+    neighbor.sum_of_costs = 0;
+    for (int i = 0; i < (int)agents.size(); i++)
+    {
+        agents[i].path = best->agents[i].path;
+        path_table.insertPath(agents[i].id, agents[i].path);
+        neighbor.sum_of_costs += (int)agents[i].path.size() - 1;
+    }
+    sum_of_costs_lowerbound = best->sum_of_costs_lowerbound;
+    portfolio_winner = best->init_algo_name;
+    return true;
+}
+
 bool LNS::runPPS(){
     auto shuffled_agents = neighbor.agents;
-    std::random_shuffle(shuffled_agents.begin(), shuffled_agents.end());
+    std::shuffle(shuffled_agents.begin(), shuffled_agents.end(), random_generator);
 
     MAPF P = preparePIBTProblem(shuffled_agents);
     P.setTimestepLimit(pipp_option.timestepLimit);
 
     // seed for solver
-    std::mt19937* MT_S = new std::mt19937(0);
-    PPS solver(&P,MT_S);
+    std::mt19937 MT_S(0);
+    PPS solver(&P,&MT_S);
+    solver.setDistanceOracle(pibt_distances.get());
     solver.setTimeLimit(time_limit);
-//    solver.WarshallFloyd();
+    solver.setInterruptFlag(interrupted);
     bool result = solver.solve();
     if (result)
         updatePIBTResult(P.getA(),shuffled_agents);
@@ -407,44 +815,79 @@ bool LNS::runPPS(){
 }
 bool LNS::runPIBT(){
     auto shuffled_agents = neighbor.agents;
-     std::random_shuffle(shuffled_agents.begin(), shuffled_agents.end());
+     std::shuffle(shuffled_agents.begin(), shuffled_agents.end(), random_generator);
 
     MAPF P = preparePIBTProblem(shuffled_agents);
 
     // seed for solver
-    std::mt19937* MT_S = new std::mt19937(0);
-    PIBT solver(&P,MT_S);
-    solver.setTimeLimit(time_limit);
-    bool result = solver.solve();
-    if (result)
-        updatePIBTResult(P.getA(),shuffled_agents);
-    return result;
+    std::mt19937 MT_S(0);
+    PIBT solver(&P,&MT_S);
+    solver.setDistanceOracle(pibt_distances.get());
+    return solvePIBTProblem(solver, P, shuffled_agents);
 }
 
 bool LNS::runWinPIBT(){
     auto shuffled_agents = neighbor.agents;
-    std::random_shuffle(shuffled_agents.begin(), shuffled_agents.end());
+    std::shuffle(shuffled_agents.begin(), shuffled_agents.end(), random_generator);
 
     MAPF P = preparePIBTProblem(shuffled_agents);
     P.setTimestepLimit(pipp_option.timestepLimit);
 
     // seed for solver
-    std::mt19937* MT_S = new std::mt19937(0);
-    winPIBT solver(&P,pipp_option.windowSize,pipp_option.winPIBTSoft,MT_S);
-    solver.setTimeLimit(time_limit);
-    bool result = solver.solve();
-    if (result)
-        updatePIBTResult(P.getA(),shuffled_agents);
-    return result;
+    std::mt19937 MT_S(0);
+    winPIBT solver(&P,pipp_option.windowSize,pipp_option.winPIBTSoft,&MT_S);
+    solver.setDistanceOracle(pibt_distances.get());
+    return solvePIBTProblem(solver, P, shuffled_agents);
+}
+
+// When replanning, the agents outside the neighborhood keep their paths in path_table,
+// and the PIBT solvers treat them as moving obstacles.
+bool LNS::solvePIBTProblem(Solver& solver, MAPF& P, const vector<int>& shuffled_agents){
+    std::unique_ptr<DistanceOracle> distances;
+    solver.setInterruptFlag(interrupted);
+    if (iteration_stats.empty())
+        solver.setTimeLimit(time_limit);
+    else // replan
+    {
+        runtime = ((fsec)(Time::now() - start_time)).count();
+        solver.setTimeLimit(min(time_limit - runtime, replan_time_limit));
+        solver.setFixedPaths(&path_table);
+        // the agents that are not replanned eventually wait at their goals forever,
+        // so guide the neighborhood around these goals
+        vector<bool> blocked(instance.map_size, false);
+        for (int loc = 0; loc < instance.map_size; loc++)
+            blocked[loc] = path_table.goals[loc] < MAX_COST;
+        distances.reset(new DistanceOracle(pibt_graph.get(), std::move(blocked)));
+        solver.setDistanceOracle(distances.get());
+        // once the timestep reaches the old sum of costs, the new paths cannot be better
+        solver.setTimestepLimit(max(neighbor.old_sum_of_costs, path_table.makespan) + 1);
+    }
+    bool succ = solver.solve();
+    if (succ)
+        succ = updatePIBTResult(P.getA(),shuffled_agents);
+    else if (!neighbor.old_paths.empty()) // stick to old paths
+    {
+        for (int id : neighbor.agents)
+            path_table.insertPath(agents[id].id, agents[id].path);
+        neighbor.sum_of_costs = neighbor.old_sum_of_costs;
+    }
+    if (!succ && !neighbor.old_paths.empty())
+        num_of_failures++;
+    return succ;
 }
 
-MAPF LNS::preparePIBTProblem(vector<int> shuffled_agents){
+MAPF LNS::preparePIBTProblem(const vector<int>& shuffled_agents){
 
     // seed for problem and graph
-    std::mt19937* MT_PG = new std::mt19937(0);
-
-//    Graph* G = new SimpleGrid(instance);
-    Graph* G = new SimpleGrid(instance.getMapFile());
+    pibt_random_generator.seed(0);
+    if (pibt_graph == nullptr)
+    {
+        pibt_graph.reset(new InstanceGrid(instance, &pibt_random_generator));
+        pibt_distances.reset(new DistanceOracle(pibt_graph.get()));
+        for (const auto& agent : agents)
+            pibt_distances->setTable(agent.path_planner.goal_location, &agent.path_planner.my_heuristic);
+    }
+    Graph* G = pibt_graph.get();
 
     std::vector<Task*> T;
     PIBT_Agents A;
@@ -452,7 +895,7 @@ MAPF LNS::preparePIBTProblem(vector<int> shuffled_agents){
     for (int i : shuffled_agents){
         assert(G->existNode(agents[i].path_planner.start_location));
         assert(G->existNode(agents[i].path_planner.goal_location));
-        PIBT_Agent* a = new PIBT_Agent(G->getNode( agents[i].path_planner.start_location));
+        PIBT_Agent* a = new PIBT_Agent((int)A.size(), G->getNode( agents[i].path_planner.start_location));
 
 //        PIBT_Agent* a = new PIBT_Agent(G->getNode( agents[i].path_planner.start_location));
         A.push_back(a);
@@ -465,46 +908,108 @@ MAPF LNS::preparePIBTProblem(vector<int> shuffled_agents){
         }
     }
 
-    return MAPF(G, A, T, MT_PG);
+    return MAPF(G, A, T, &pibt_random_generator);
 
 }
 
-void LNS::updatePIBTResult(const PIBT_Agents& A,vector<int> shuffled_agents){
+bool LNS::updatePIBTResult(const PIBT_Agents& A, const vector<int>& shuffled_agents){
     int soc = 0;
+    vector<Path> paths(A.size());
     for (int i=0; i<A.size();i++){
         int a_id = shuffled_agents[i];
-
-        agents[a_id].path.resize(A[i]->getHist().size());
-        int last_goal_visit = 0;
+        const auto& hist = A[i]->getHist();
         if(screen>=2)
             std::cout<<A[i]->logStr()<<std::endl;
-        for (int n_index = 0; n_index < A[i]->getHist().size(); n_index++){
-            auto n = A[i]->getHist()[n_index];
-            agents[a_id].path[n_index] = PathEntry(n->v->getId());
 
-            //record the last time agent reach the goal from a non-goal vertex.
-            if(agents[a_id].path_planner.goal_location == n->v->getId() 
-                && n_index - 1>=0
-                && agents[a_id].path_planner.goal_location !=  agents[a_id].path[n_index - 1].location)
-                last_goal_visit = n_index;
-
-        }
-        //resize to last goal visit time
-        agents[a_id].path.resize(last_goal_visit + 1);
+        //find the last time agent reach the goal from a non-goal vertex.
+        int goal = agents[a_id].path_planner.goal_location;
+        int last_goal_visit = (int)hist.size() - 1;
+        while (last_goal_visit > 0 &&
+            (hist[last_goal_visit].v->getId() != goal || hist[last_goal_visit - 1].v->getId() == goal))
+            last_goal_visit--;
+
+        //copy the path up to the last goal visit time
+        paths[i].resize(last_goal_visit + 1);
+        for (int t = 0; t <= last_goal_visit; t++)
+            paths[i][t].location = hist[t].v->getId();
         if(screen>=2)
-            std::cout<<" Length: "<< agents[a_id].path.size() <<std::endl;
+            std::cout<<" Length: "<< paths[i].size() <<std::endl;
         if(screen>=5){
             cout <<"Agent "<<a_id<<":";
-            for (auto loc : agents[a_id].path){
+            for (auto loc : paths[i]){
                 cout <<loc.location<<",";
             }
             cout<<endl;
         }
-        path_table.insertPath(agents[a_id].id, agents[a_id].path);
-        soc += agents[a_id].path.size()-1;
+        soc += paths[i].size()-1;
     }
 
+    if (!neighbor.old_paths.empty()) // replan
+    {
+        // an agent that cannot move away from a fixed agent stays in place, so check the paths again
+        bool valid = true;
+        for (int i = 0; i < (int)paths.size() && valid; i++)
+        {
+            for (int t = 1; t < (int)paths[i].size() && valid; t++)
+                valid = !path_table.constrained(paths[i][t - 1].location, paths[i][t].location, t);
+            const auto& agents_at_goal = path_table.table[paths[i].back().location];
+            for (int t = (int)paths[i].size(); t < (int)agents_at_goal.size() && valid; t++)
+                valid = agents_at_goal[t] == NO_AGENT;
+        }
+        if (!valid || soc >= neighbor.old_sum_of_costs) // stick to old paths
+        {
+            for (int id : neighbor.agents)
+                path_table.insertPath(agents[id].id, agents[id].path);
+            neighbor.sum_of_costs = neighbor.old_sum_of_costs;
+            return valid;
+        }
+    }
+
+    for (int i=0; i<A.size();i++){
+        int a_id = shuffled_agents[i];
+        agents[a_id].path = std::move(paths[i]);
+        path_table.insertPath(agents[a_id].id, agents[a_id].path);
+    }
     neighbor.sum_of_costs =soc;
+    return true;
+}
+
+// The neighborhood of init LNS consists of the agents in the connected component of a random colliding agent
+// in the collision graph, and is filled up with random agents if the component is small.
+bool LNS::generateNeighborByCollisionGraph()
+{
+    vector<int> colliding_agents;
+    for (int i = 0; i < (int)agents.size(); i++)
+    {
+        if (!collision_graph[i].empty())
+            colliding_agents.push_back(i);
+    }
+    if (colliding_agents.empty())
+        return false;
+    int start = colliding_agents[getRandomInt((int)colliding_agents.size())];
+    set<int> neighbors_set;
+    neighbors_set.insert(start);
+    std::queue<int> open;
+    open.push(start);
+    while (!open.empty() && (int)neighbors_set.size() < neighbor_size)
+    {
+        int curr = open.front();
+        open.pop();
+        for (int next : collision_graph[curr])
+        {
+            if (neighbors_set.insert(next).second)
+                open.push(next);
+            if ((int)neighbors_set.size() >= neighbor_size)
+                break;
+        }
+    }
+    int target_size = min(neighbor_size, (int)agents.size());
+    while ((int)neighbors_set.size() < target_size)
+        neighbors_set.insert(getRandomInt((int)agents.size()));
+    neighbor.agents.assign(neighbors_set.begin(), neighbors_set.end());
+    if (screen >= 3)
+        cout << "Generate " << neighbor.agents.size() << " neighbors by the collision graph of agent " << start << endl;
+    return true;
 }
 
 void LNS::chooseDestroyHeuristicbyALNS()
@@ -518,7 +1023,7 @@ void LNS::chooseDestroyHeuristicbyALNS()
         for (const auto& h : destroy_weights)
             cout << h / sum << ",";
     }
-    double r = (double) rand() / RAND_MAX;
+    double r = std::uniform_real_distribution<double>(0, 1)(random_generator);
     double threshold = destroy_weights[0];
     selected_neighbor = 0;
     while (threshold < r * sum)
@@ -569,9 +1074,9 @@ bool LNS::generateNeighborByIntersection(bool temporal)
     if (neighbors_set.size() <= 1)
         return false;*/
     auto pt = intersections.begin();
-    std::advance(pt, rand() % intersections.size());
+    std::advance(pt, getRandomInt((int)intersections.size()));
     int location = *pt;
-    path_table.get_agents(neighbors_set, neighbor_size, location);
+    path_table.get_agents(neighbors_set, neighbor_size, location, random_generator);
     if (neighbors_set.size() < neighbor_size)
     {
         set<int> closed;
@@ -590,7 +1095,7 @@ bool LNS::generateNeighborByIntersection(bool temporal)
                 closed.insert(next);
                 if (instance.getDegree(next) >= 3)
                 {
-                    path_table.get_agents(neighbors_set, neighbor_size, next);
+                    path_table.get_agents(neighbors_set, neighbor_size, next, random_generator);
                     if ((int) neighbors_set.size() == neighbor_size)
                         break;
                 }
@@ -600,7 +1105,7 @@ bool LNS::generateNeighborByIntersection(bool temporal)
     neighbor.agents.assign(neighbors_set.begin(), neighbors_set.end());
     if (neighbor.agents.size() > neighbor_size)
     {
-        std::random_shuffle(neighbor.agents.begin(), neighbor.agents.end());
+        std::shuffle(neighbor.agents.begin(), neighbor.agents.end(), random_generator);
         neighbor.agents.resize(neighbor_size);
     }
     if (screen >= 2)
@@ -628,11 +1133,11 @@ bool LNS::generateNeighborByRandomWalk()
     int count = 0;
     while (neighbors_set.size() < neighbor_size && count < 10)
     {
-        int t = rand() % agents[a].path.size();
+        int t = getRandomInt((int)agents[a].path.size());
         randomWalk(a, agents[a].path[t].location, t, neighbors_set, neighbor_size, (int) agents[a].path.size() - 1);
         count++;
         // select the next agent randomly
-        int idx = rand() % neighbors_set.size();
+        int idx = getRandomInt((int)neighbors_set.size());
         int i = 0;
         for (auto n : neighbors_set)
         {
@@ -681,10 +1186,10 @@ int LNS::findMostDelayedAgent()
     return a;
 }
 
-int LNS::findRandomAgent() const
+int LNS::findRandomAgent()
 {
     int a = 0;
-    int pt = rand() % (sum_of_costs - sum_of_distances) + 1;
+    int pt = getRandomInt(sum_of_costs - sum_of_distances) + 1;
     int sum = 0;
     for (; a < (int) agents.size(); a++)
     {
@@ -707,7 +1212,7 @@ void LNS::randomWalk(int agent_id, int start_location, int start_timestep,
         next_locs.push_back(loc);
         while (!next_locs.empty())
         {
-            int step = rand() % next_locs.size();
+            int step = getRandomInt((int)next_locs.size());
             auto it = next_locs.begin();
             advance(it, step);
             int next_h_val = agents[agent_id].path_planner.my_heuristic[*it];
@@ -765,7 +1270,7 @@ void LNS::validateSolution() const
             const auto a1 = a1_.path.size() <= a2_.path.size()? a1_ : a2_;
             const auto a2 = a1_.path.size() <= a2_.path.size()? a2_ : a1_;
             int t = 1;
-            for (; t < (int) a1.path.size(); t++)
+            for (; t < (int) a1.path.size() && t <= path_table.window; t++)
             {
                 if (a1.path[t].location == a2.path[t].location) // vertex conflict
                 {
@@ -783,7 +1288,7 @@ void LNS::validateSolution() const
                 }
             }
             int target = a1.path.back().location;
-            for (; t < (int) a2.path.size(); t++)
+            for (; t < (int) a2.path.size() && t <= path_table.window; t++)
             {
                 if (a2.path[t].location == target)  // target conflict
                 {
@@ -0,0 +1,56 @@
+/*
+ * distanceoracle.cpp
+ *
+ * Purpose: shortest distances to goal nodes, shared by the PIBT family
+ */
+
+#include <queue>
+#include "distanceoracle.h"
+
+const std::vector<int>& DistanceOracle::getTable(Node* g) {
+  auto itr = tables.find(g->getId());
+  if (itr != tables.end()) return *itr->second;
+
+  if (G->isDirected() && predecessors.empty()) {
+    predecessors.resize(G->getIdRange());
+    for (auto v : G->getNodes())
+      for (auto u : G->neighbor(v)) predecessors[u->getId()].push_back(v);
+  }
+
+  auto table = new std::vector<int>(G->getIdRange(), UNREACHABLE);
+  std::queue<Node*> OPEN;
+  (*table)[g->getId()] = 0;
+  OPEN.push(g);
+  while (!OPEN.empty()) {
+    Node* v = OPEN.front();
+    OPEN.pop();
+    const Nodes& C = G->isDirected() ? predecessors[v->getId()] : G->neighbor(v);
+    for (auto u : C) {
+      if ((*table)[u->getId()] != UNREACHABLE) continue;
+      (*table)[u->getId()] = (*table)[v->getId()] + 1;
+      if (!blocked.empty() && blocked[u->getId()]) continue;  // reachable, but not passable
+      OPEN.push(u);
+    }
+  }
+  ownTables.emplace_back(table);
+  tables[g->getId()] = table;
+  return *table;
+}
+
+Nodes DistanceOracle::getPath(Node* s, Node* g) {
+  const auto& table = getTable(g);
+  if (table[s->getId()] >= UNREACHABLE) return {};
+
+  Nodes path = { s };
+  Node* v = s;
+  while (v != g) {
+    for (auto u : G->neighbor(v)) {
+      if (table[u->getId()] == table[v->getId()] - 1) {
+        v = u;
+        break;
+      }
+    }
+    path.push_back(v);
+  }
+  return path;
+}
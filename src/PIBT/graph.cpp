@@ -35,16 +35,14 @@ Graph::~Graph() {
 }
 
 Node* Graph::getNode(int id) {
-  auto itr = std::find_if(nodes.begin(), nodes.end(),
-                          [id](Node* v){ return v->getId() == id; });
   // error check
-  if (itr == nodes.end()) {
+  if (!existNode(id)) {
     std::cout << "error@Graph::getNode, "
               << "node index is over, " << id << "\n";
     std::exit(1);
   }
 
-  return *itr;
+  return nodeTable[id];
 }
 
 Node* Graph::getNode(int x, int y) {
@@ -57,20 +55,18 @@ Node* Graph::getNode(int x, int y) {
 }
 
 bool Graph::existNode(int id) {
-  auto itr = std::find_if(nodes.begin(), nodes.end(),
-                          [id](Node* v){ return v->getId() == id; });
-  return itr != nodes.end();
+  return 0 <= id && id < (int)nodeTable.size() && nodeTable[id] != nullptr;
 }
 
 int Graph::getNodeIndex(Node* v) {
   return v->getIndex();
 }
 
-Nodes Graph::neighbor(Node* v) {
+const Nodes& Graph::neighbor(Node* v) {
   return v->getNeighbor();
 }
 
-Nodes Graph::neighbor(int i) {
+const Nodes& Graph::neighbor(int i) {
   return getNode(i)->getNeighbor();
 }
 
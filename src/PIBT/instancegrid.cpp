@@ -0,0 +1,61 @@
+/*
+ * instancegrid.cpp
+ *
+ * Purpose: grid built from the map of an Instance
+ */
+
+#include "util.h"
+#include "instancegrid.h"
+
+InstanceGrid::InstanceGrid(const Instance& _instance, std::mt19937* _MT)
+  : Grid(_MT), instance(_instance)
+{
+  setSize(instance.num_of_cols, instance.num_of_rows);
+  createNodes();
+  createEdges();
+  // all nodes are target
+  starts = nodes;
+  goals = nodes;
+}
+
+InstanceGrid::~InstanceGrid() {}
+
+// node ids are the locations of the instance
+void InstanceGrid::createNodes() {
+  nodeTable.assign(instance.map_size, nullptr);
+  for (int id = 0; id < instance.map_size; ++id) {
+    if (instance.isObstacle(id)) continue;
+    Node* v = new Node(id, nodes.size());
+    v->setPos(instance.getRowCoordinate(id), instance.getColCoordinate(id));
+    nodes.push_back(v);
+    nodeTable[id] = v;
+  }
+}
+
+// the same order of neighbors as SimpleGrid, i.e., up, left, right and down
+void InstanceGrid::createEdges() {
+  int w = getW();
+  Nodes neighbor;
+  for (auto v : nodes) {
+    int id = v->getId();
+    neighbor.clear();
+    for (int u : { id - w, id - 1, id + 1, id + w }) {
+      if (instance.validMove(id, u)) neighbor.push_back(nodeTable[u]);
+    }
+    v->setNeighbor(neighbor);
+  }
+}
+
+Node* InstanceGrid::getNewGoal(Node* v) {
+  Node* u;
+  do {
+    u = randomChoose(goals, MT);
+  } while (u == v);
+  return u;
+}
+
+std::string InstanceGrid::logStr() {
+  std::string str = Grid::logStr();
+  str += "[graph] filename:" + instance.getMapFile() + "\n";
+  return str;
+}
@@ -77,10 +77,10 @@ std::string MAPF::logStr() {
   int cnt;
   int pathsize;
   for (auto a : A) {
-    auto hist = a->getHist();
+    const auto& hist = a->getHist();
     auto itr = hist.end() - 1;
     cnt = 0;
-    while ((*itr)->v == a->getGoal()) {
+    while (itr->v == a->getGoal()) {
       ++cnt;
       --itr;
     }
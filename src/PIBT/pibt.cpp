@@ -39,23 +39,36 @@ void PIBT::init() {
     eta.push_back(0);
     priority.push_back(epsilon[i] + eta[i]);
   }
+
+  order.resize(agentNum);
+  undecided.resize(agentNum);
+  occupied.assign(G->getNodesNum(), -1);
+  closed.assign(G->getNodesNum(), -1);
+  stamp = -1;
+  // the depth of priority inheritance is at most the number of agents,
+  // so that the buffers are never reallocated while they are referred
+  candidates.resize(agentNum + 1);
 }
 
 
 bool PIBT::solve() {
   solveStart();
 
-  while (!P->isSolved()) {
+  while (!isSolved()) {
     allocate();
     update();
     P->update();
       if(time_limit&&((fsec)(std::chrono::system_clock::now()-startT)).count()>time_limit){
           break;
       }
+      if(timestep_limit&&P->getTimestep()>=timestep_limit){
+          break;
+      }
+      if (isInterrupted()) break;
   }
 
   solveEnd();
-  return P->isSolved();
+  return isSolved();
 }
 
 void PIBT::allocate() {
@@ -82,25 +95,24 @@ void PIBT::allocate() {
 void PIBT::update() {
   updatePriority();
 
-  std::vector<float> PL(priority.size());  // priority list
-  std::copy(priority.begin(), priority.end(), PL.begin());
-
-  Nodes CLOSE_NODE;
-  PIBT_Agents OPEN_AGENT(A.size());
-  std::copy(A.begin(), A.end(), OPEN_AGENT.begin());
-
-  // choose one agent with the highest priority
-  auto itr = std::max_element(PL.begin(), PL.end());
-  int index = std::distance(PL.begin(), itr);
-  PIBT_Agent* a = OPEN_AGENT[index];
-
-  while (!OPEN_AGENT.empty()) {
-    priorityInheritance(a, CLOSE_NODE, OPEN_AGENT, PL);
-
-    itr = std::max_element(PL.begin(), PL.end());
-    index = std::distance(PL.begin(), itr);
-    a = OPEN_AGENT[index];
+  ++stamp;  // open all nodes
+  for (int i = 0; i < A.size(); ++i) {
+    order[i] = i;
+    undecided[i] = true;
+    occupied[A[i]->getNode()->getIndex()] = i;
+  }
+  // higher priority first, ties are broken by the order of agents
+  std::sort(order.begin(), order.end(),
+            [this] (int i, int j) {
+              if (priority[i] != priority[j]) return priority[i] > priority[j];
+              return i < j;
+            });
+
+  for (auto i : order) {
+    if (undecided[i]) priorityInheritance(i, nullptr, 0);
   }
+
+  for (auto a : A) occupied[a->getNode()->getIndex()] = -1;
 }
 
 void PIBT::updatePriority() {
@@ -148,33 +160,13 @@ float PIBT::getDensity(PIBT_Agent* a) {
   return density;
 }
 
-bool PIBT::priorityInheritance(PIBT_Agent* a,
-                               Nodes& CLOSE_NODE,
-                               PIBT_Agents& OPEN_AGENT,
-                               std::vector<float>& PL) {
-  Nodes C = createCandidates(a, CLOSE_NODE);
-  return priorityInheritance(a, C, CLOSE_NODE, OPEN_AGENT, PL);
-}
-
-bool PIBT::priorityInheritance(PIBT_Agent* a,
-                               PIBT_Agent* aFrom,
-                               Nodes& CLOSE_NODE,
-                               PIBT_Agents& OPEN_AGENT,
-                               std::vector<float>& PL) {
-  Nodes C = createCandidates(a, CLOSE_NODE, aFrom->getNode());
-  return priorityInheritance(a, C, CLOSE_NODE, OPEN_AGENT, PL);
-}
-
-bool PIBT::priorityInheritance(PIBT_Agent* a,
-                               Nodes C,
-                               Nodes& CLOSE_NODE,
-                               PIBT_Agents& OPEN_AGENT,
-                               std::vector<float>& PL)
+// decide the next node of agent i, which must not be "from" (the node of its parent)
+bool PIBT::priorityInheritance(int i, Node* from, int depth)
 {
-  // remove agent from OPEN_AGENT, Priority List
-  auto itr = std::find(OPEN_AGENT.begin(), OPEN_AGENT.end(), a);
-  PL.erase(PL.begin() + std::distance(OPEN_AGENT.begin(), itr));
-  OPEN_AGENT.erase(itr);
+  undecided[i] = false;
+  PIBT_Agent* a = A[i];
+  Nodes& C = candidates[depth];
+  createCandidates(a, from, C);
 
   Node* target;
 
@@ -183,59 +175,55 @@ bool PIBT::priorityInheritance(PIBT_Agent* a,
 
     // choose target
     target = chooseNode(a, C);
-    CLOSE_NODE.push_back(target);
-
-    bool isAgent = false;
-    for (auto b : OPEN_AGENT) {
-      if (target == b->getNode()) {  // If there is an agent
-        if (priorityInheritance(b, a, CLOSE_NODE, OPEN_AGENT, PL)) {
-          // priority inheritance success
-          a->setNode(target);
-          return true;
-        } else {
-          // priority inheritance fail
-          updateC(C, target, CLOSE_NODE);
-          isAgent = true;
-          break;
-        }
-      }
-    }
+    closed[target->getIndex()] = stamp;
 
     // If there is an agent
-    if (!isAgent) {
-      a->setNode(target);
+    int j = occupied[target->getIndex()];
+    if (j >= 0 && undecided[j]) {
+      if (priorityInheritance(j, a->getNode(), depth + 1)) {
+        // priority inheritance success
+        move(i, target);
+        return true;
+      }
+      // priority inheritance fail
+      updateC(C);
+    } else {
+      move(i, target);
       return true;
     }
   }
 
   // failed
-  a->setNode(a->getNode());
+  move(i, a->getNode());
   return false;
 }
 
-Nodes PIBT::createCandidates(PIBT_Agent* a, Nodes CLOSE_NODE) {
-  Nodes C;
-  for (auto v : G->neighbor(a->getNode())) {
-    if (!inArray(v, CLOSE_NODE)) C.push_back(v);
+void PIBT::createCandidates(PIBT_Agent* a, Node* from, Nodes& C) {
+  C.clear();
+  Node* u = a->getNode();
+  int t = P->getTimestep() + 1;
+  for (auto v : G->neighbor(u)) {
+    if (closed[v->getIndex()] != stamp && v != from && !constrained(u, v, t)) C.push_back(v);
   }
-  if (!inArray(a->getNode(), CLOSE_NODE)) C.push_back(a->getNode());
-  return C;
+  if (closed[u->getIndex()] != stamp && u != from && !constrained(u, u, t)) C.push_back(u);
 }
 
-Nodes PIBT::createCandidates(PIBT_Agent* a, Nodes CLOSE_NODE, Node* tmp) {
-  CLOSE_NODE.push_back(tmp);
-  Nodes C = createCandidates(a, CLOSE_NODE);
-  CLOSE_NODE.erase(CLOSE_NODE.end() - 1);
-  return C;
+void PIBT::move(int i, Node* target) {
+  int v = A[i]->getNode()->getIndex();
+  if (occupied[v] == i) occupied[v] = -1;  // another agent may have already come
+  occupied[target->getIndex()] = i;
+  A[i]->setNode(target);
 }
 
-Node* PIBT::chooseNode(PIBT_Agent* a, Nodes C) {
-  if (C.empty()) {
+Node* PIBT::chooseNode(PIBT_Agent* a, const Nodes& _C) {
+  if (_C.empty()) {
     std::cout << "error@PIBT::chooseNode, C is empty" << "\n";
     std::exit(1);
   }
 
   // randomize
+  Nodes& C = shuffled;
+  C.assign(_C.begin(), _C.end());
   std::shuffle(C.begin(), C.end(), *MT);
 
   if (!a->hasGoal()) {
@@ -246,15 +234,12 @@ Node* PIBT::chooseNode(PIBT_Agent* a, Nodes C) {
     }
   }
 
-  Nodes cs;
-  int minCost = 10000;
+  Nodes& cs = ties;
+  cs.clear();
+  int minCost = std::numeric_limits<int>::max();
   int cost;
   Node* g = a->getGoal();
 
-  // fast implementation
-  Nodes p = G->getPath(a->getNode(), g);
-  if (p.size() > 1 && inArray(p[1], C)) return p[1];
-
   for (auto v : C) {
     cost = pathDist(v, g);
     if (cost < minCost) {
@@ -269,22 +254,18 @@ Node* PIBT::chooseNode(PIBT_Agent* a, Nodes C) {
   if (cs.size() == 1) return cs[0];
 
   // tie break
-  bool contained;
   for (auto v : cs) {  // avoid tabu list
-    contained = std::any_of(A.begin(), A.end(),
-                            [v](PIBT_Agent* b){ return b->getNode() == v; });
-    if (!contained) return v;
+    if (occupied[v->getIndex()] < 0) return v;
   }
 
   return cs[0];
 }
 
-void PIBT::updateC(Nodes& C, Node* target, Nodes CLOSE_NODE) {
-  for (auto v : CLOSE_NODE) {
-    auto itr2 = std::find_if(C.begin(), C.end(),
-                             [v] (Node* u) { return v == u; });
-    if (itr2 != C.end()) C.erase(itr2);
-  }
+// remove closed nodes from C
+void PIBT::updateC(Nodes& C) {
+  C.erase(std::remove_if(C.begin(), C.end(),
+                         [this] (Node* v) { return closed[v->getIndex()] == stamp; }),
+          C.end());
 }
 
 std::string PIBT::logStr() {
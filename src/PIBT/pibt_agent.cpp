@@ -9,18 +9,16 @@
 #include "pibt_agent.h"
 #include "util.h"
 
-int PIBT_Agent::cntId = 0;
+std::atomic<int> PIBT_Agent::cntId(0);
 
-PIBT_Agent::PIBT_Agent() : id(cntId) {
-    ++cntId;
+PIBT_Agent::PIBT_Agent() : id(cntId++) {
     g = nullptr;
     tau = nullptr;
     updated = false;
     beforeNode = nullptr;
 }
 
-PIBT_Agent::PIBT_Agent(Node* _v) : id(cntId) {
-    ++cntId;
+PIBT_Agent::PIBT_Agent(Node* _v) : id(cntId++) {
     g = nullptr;
     tau = nullptr;
     v = nullptr;
@@ -28,16 +26,20 @@ PIBT_Agent::PIBT_Agent(Node* _v) : id(cntId) {
     updated = false;
 }
 
-PIBT_Agent::~PIBT_Agent() {
-    for (auto s : hist) delete s;
-    hist.clear();
+PIBT_Agent::PIBT_Agent(int _id, Node* _v) : id(_id) {
+    g = nullptr;
+    tau = nullptr;
+    v = nullptr;
+    setNode(_v);
+    updated = false;
 }
 
+PIBT_Agent::~PIBT_Agent() {}
+
 void PIBT_Agent::setNode(Node* _v) {
     // error check
     if (v != nullptr) {
-        auto neigh = v->getNeighbor();
-        if (!(_v == v || inArray(_v, neigh))) {
+        if (!(_v == v || inArray(_v, v->getNeighbor()))) {
             std::cout << "error@Agent, set invalid node, from "
                       << v->getId() << " to " << _v->getId() << std::endl;
             std::exit(1);
@@ -49,19 +51,7 @@ void PIBT_Agent::setNode(Node* _v) {
 }
 
 void PIBT_Agent::updateHist() {
-    AgentStatus* s = new AgentStatus;
-    s->v = v;
-    if (hasGoal()) {
-        s->g = g;
-    } else {
-        s->g = nullptr;
-    }
-    if (hasTask()) {
-        s->tau = tau;
-    } else {
-        s->tau = nullptr;
-    }
-    hist.push_back(s);
+    hist.push_back(AgentStatus { v, hasGoal() ? g : nullptr, hasTask() ? tau : nullptr });
 }
 
 void PIBT_Agent::releaseTask() {
@@ -83,10 +73,10 @@ std::string PIBT_Agent::logStr() {
     str += "id:" + std::to_string(id) + "\n";
     strPath = "path:";
     strGoal = "goal:";
-    for (auto s : hist) {
-        strPath += std::to_string(s->v->getId()) + ",";
-        if (s->g != nullptr) {
-            strGoal += std::to_string(s->g->getId()) + ",";
+    for (const auto& s : hist) {
+        strPath += std::to_string(s.v->getId()) + ",";
+        if (s.g != nullptr) {
+            strGoal += std::to_string(s.g->getId()) + ",";
         } else {
             strGoal += "*,";
         }
@@ -12,7 +12,7 @@
 #include "pps.h"
 #include "util.h"
 
-int PPS::s_uuid = 0;
+std::atomic<int> PPS::s_uuid(0);
 
 PPS::PPS(Problem* _P) : Solver(_P) {
   init();
@@ -55,6 +55,7 @@ bool PPS::solve() {
       if(time_limit&&((fsec)(std::chrono::system_clock::now()-startT)).count()>time_limit){
           break;
       }
+      if (isInterrupted()) break;
   }
 
   solveEnd();
@@ -367,7 +368,7 @@ void PPS::ADD_DONE_SWAPERS(S* s) {
 }
 
 Nodes PPS::SHORTEST_PATH(Node* s, Node* g) {
-  return G->getPath(s, g);
+  return D->getPath(s, g);
 }
 
 Nodes PPS::SHORTEST_PATH(Node* s, Node* g, Nodes prohibited) {
@@ -375,7 +376,7 @@ Nodes PPS::SHORTEST_PATH(Node* s, Node* g, Nodes prohibited) {
 }
 
 Nodes PPS::SHORTEST_PATH(PIBT_Agent* c, Node* g) {
-  if (H.empty()) return G->getPath(c->getNode(), g);
+  if (H.empty()) return D->getPath(c->getNode(), g);
 
   Nodes prohibited;
   for (auto a : H) prohibited.push_back(a->getNode());
@@ -383,7 +384,10 @@ Nodes PPS::SHORTEST_PATH(PIBT_Agent* c, Node* g) {
 }
 
 Nodes PPS::SHORTEST_PATH(PIBT_Agent* c, Node* g, Nodes& T) {
-  if (H.empty()) return G->getPath(c->getNode(), g, T);
+  if (H.empty()) {
+    if (T.empty()) return D->getPath(c->getNode(), g);
+    return G->getPath(c->getNode(), g, T);
+  }
 
   Nodes prohibited = T;
   for (auto a : H) prohibited.push_back(a->getNode());
@@ -623,7 +627,7 @@ void PPS::SETUP_SWAP(PIBT_Agent* c, PIBT_Agent* a) {
     agents = {a, c};
   }
 
-  S* s = new S { s_uuid,
+  S* s = new S { s_uuid++,
                  agents,  // [near (high), far (low)]
                  a->getNode(),  // [low] original pos
                  sorted_esv,
@@ -633,7 +637,6 @@ void PPS::SETUP_SWAP(PIBT_Agent* c, PIBT_Agent* a) {
                  nullptr,  // evacL
                  {},       // area
                  SWAPPHASE::GO_TARGET };
-  ++s_uuid;
 
   pusherToSwaper.push_back(c);
   pusherToSwaper.push_back(a);
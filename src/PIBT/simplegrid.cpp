@@ -88,6 +88,7 @@ void SimpleGrid::createNodes() {
   int j = 0;  // height
   bool mapStart = false;
   char s;
+  nodeTable.assign(w * h, nullptr);
 
   while (getline(file, line)) {
     // for CRLF coding
@@ -104,9 +105,10 @@ void SimpleGrid::createNodes() {
         s = line[i];
         id = j * w + i;
         if (s == 'T' or s == '@') continue;
-        Node* v = new Node(id);
+        Node* v = new Node(id, nodes.size());
         v->setPos(j, i);
         nodes.push_back(v);
+        nodeTable[id] = v;
       }
       ++j;
     }
@@ -25,8 +25,21 @@ Solver::~Solver() {}
 void Solver::init() {
   G = P->getG();
   A = P->getA();
-  int nodeNum = G->getNodesNum();
-  dists = Eigen::MatrixXi::Zero(nodeNum, nodeNum);
+  ownOracle.reset(new DistanceOracle(G));
+  D = ownOracle.get();
+  fixedPaths = nullptr;
+}
+
+// all agents are at their goals and no fixed agent visits the goals afterward
+bool Solver::isSolved() {
+  if (!P->isSolved()) return false;
+  return fixedPaths == nullptr || P->getTimestep() >= fixedPaths->makespan;
+}
+
+// whether moving from "from" to "to" at timestep t-1 collides with the fixed agents
+bool Solver::constrained(Node* from, Node* to, int t) {
+  if (fixedPaths == nullptr) return false;
+  return fixedPaths->constrained(from->getId(), to->getId(), t);
 }
 
 void Solver::solveStart() {
@@ -37,81 +50,62 @@ void Solver::solveEnd() {
   endT = std::chrono::system_clock::now();
   elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>
     (endT-startT).count();
+  if (isInterrupted()) return;  // the paths are discarded, so skip the check
 
   // check consistency
   // 1. create path
   std::vector<Nodes> paths;
   for (auto a : A) {
     Nodes path;
-    for (auto s : a->getHist()) path.push_back(s->v);
+    for (const auto& s : a->getHist()) path.push_back(s.v);
     paths.push_back(path);
   }
   // 2. check continuity, vertex/swap conflict
-  for (int i = 0; i < A.size(); ++i) {
-    for (int j = i + 1; j < A.size(); ++j) {
-      if (paths[i].size() != paths[j].size()) {
-        std::cout << "error@Solver, path size is different" << std::endl;
-        std::exit(1);
-      }
-      for (int t = 0; t < paths[i].size(); ++t) {
-        if (t > 0) {
-          auto cands = paths[i][t-1]->getNeighbor();
-          cands.push_back(paths[i][t-1]);
-          if (!inArray(paths[i][t], cands)) {
-            std::cout << "error@Solver, paths is not connected at t=" << t << ", "
-                      << "agent " << i
-                      << ", from " << paths[i][t-1]->getId()
-                      << ", to " << paths[i][t]->getId()
-                      << std::endl;
-            std::exit(1);
-          }
-        }
-        if (paths[i][t] == paths[j][t]) {
-          std::cout << "error@Solver, vertex conflict at t=" << t << " between "
-                    << i << " and " << j << std::endl;
-          std::exit(1);
-        }
-        if (t > 0 && paths[i][t] == paths[j][t-1] && paths[i][t-1] == paths[j][t]) {
-          std::cout << "error@Solver, swap conflict at t=" << t << " between "
-                    << i << " and " << j << std::endl;
-          std::exit(1);
-        }
-      }
-    }
-  }
-}
-
-void Solver::WarshallFloyd() {
-  int nodeNum = G->getNodesNum();
-  Nodes neighbor;
-  int INF = 100000;
-  dists = Eigen::MatrixXi::Ones(nodeNum, nodeNum) * INF;
-
-  // initialize weight
-  for (int i = 0; i < nodeNum; ++i) {
-    neighbor = G->neighbor(G->getNodeFromIndex(i));
-    for (auto v : neighbor) {
-      dists(i, v->getIndex()) = 1;
+  for (int i = 1; i < A.size(); ++i) {
+    if (paths[i].size() != paths[0].size()) {
+      std::cout << "error@Solver, path size is different" << std::endl;
+      std::exit(1);
     }
-    dists(i, i) = 0;
   }
-
-  // main loop
-  for (int k = 0; k < nodeNum; ++k) {
-    for (int i = 0; i < nodeNum; ++i) {
-      for (int j = 0; j < nodeNum; ++j) {
-        if (dists(i, j) > dists(i, k) + dists(k, j)) {
-          dists(i, j) = dists(i, k) + dists(k, j);
+  int T = paths.empty() ? 0 : paths[0].size();
+  std::vector<int> prev(G->getNodesNum(), -1), curr(G->getNodesNum(), -1);  // agent at each node
+  for (int t = 0; t < T; ++t) {
+    for (int i = 0; i < A.size(); ++i) {
+      if (t > 0) {
+        const auto& cands = paths[i][t-1]->getNeighbor();
+        if (paths[i][t] != paths[i][t-1] && !inArray(paths[i][t], cands)) {
+          std::cout << "error@Solver, paths is not connected at t=" << t << ", "
+                    << "agent " << i
+                    << ", from " << paths[i][t-1]->getId()
+                    << ", to " << paths[i][t]->getId()
+                    << std::endl;
+          std::exit(1);
         }
       }
+      int j = curr[paths[i][t]->getIndex()];
+      if (j >= 0) {
+        std::cout << "error@Solver, vertex conflict at t=" << t << " between "
+                  << j << " and " << i << std::endl;
+        std::exit(1);
+      }
+      curr[paths[i][t]->getIndex()] = i;
+      if (t == 0) continue;
+      j = prev[paths[i][t]->getIndex()];
+      if (j >= 0 && j != i && paths[j][t] == paths[i][t-1]) {
+        std::cout << "error@Solver, swap conflict at t=" << t << " between "
+                  << std::min(i, j) << " and " << std::max(i, j) << std::endl;
+        std::exit(1);
+      }
     }
+    if (t > 0) for (int i = 0; i < A.size(); ++i) prev[paths[i][t-1]->getIndex()] = -1;
+    std::swap(prev, curr);
   }
 }
 
 int Solver::getMaxLengthPaths(Paths& paths) {
   if (paths.empty()) return 0;
   auto itr = std::max_element(paths.begin(), paths.end(),
-                              [] (Nodes p1, Nodes p2) {
+                              [] (const Nodes& p1, const Nodes& p2) {
                                 return p1.size() < p2.size(); });
   return itr->size();
 }
@@ -126,43 +120,7 @@ void Solver::formalizePath(Paths& paths) {
 }
 
 int Solver::pathDist(Node* s, Node* g) {
-  // same place?
-  if (s == g) return 0;
-
-  // has already explored?
-  int s_index = G->getNodeIndex(s);
-  int g_index = G->getNodeIndex(g);
-  int dist = dists(s_index, g_index);
-  if (dist != 0) return dist;
-
-  // new
-  Nodes path = G->getPath(s, g);
-
-  dist = path.size() - 1;  // without start node
-  int index, d, cost;
-  bool directed = G->isDirected();
-
-  cost = dist;
-  for (auto v : path) {
-    index = G->getNodeIndex(v);
-    d = dists(index, g_index);
-    if ((index != g_index) && (d == 0)) {
-      dists(index, g_index) = cost;
-      // if not directed graph
-      if (!directed) dists(g_index, index) = cost;
-      --cost;
-    } else if (d == cost) {
-      break;
-    } else {
-      std::cout << "error@Solver::pathDist, "
-                << s->getId() << " -> " << g->getId() << ", "
-                << s->getPos() << " -> " << g->getPos() << ", "
-                << "not optimal path is obtained" << "\n";
-      std::exit(1);
-    }
-  }
-
-  return dist;
+  return D->dist(s, g);
 }
 
 int Solver::pathDist(Node* s, Node* g, Nodes &prohibited) {
@@ -172,15 +130,11 @@ int Solver::pathDist(Node* s, Node* g, Nodes &prohibited) {
   return G->getPath(s, g, prohibited).size() - 1;
 }
 
-std::string Solver::getKey(int t, Node* v) {
-  std::string key = "";
-  key += std::to_string(t);
-  key += "-";
-  key += std::to_string(v->getId());
-  return key;
+long long Solver::getKey(int t, Node* v) {
+  return (long long)t * G->getIdRange() + v->getId();
 }
 
-std::string Solver::getKey(AN* n) {
+long long Solver::getKey(AN* n) {
   return getKey(n->g, n->v);
 }
 
@@ -46,10 +46,10 @@ bool winPIBT::solve() {
   int t_sup = 0;
   int i, _w;
 
-  while (!P->isSolved()) {
+  while (!isSolved()) {
     allocate();
     updatePriority();
-    std::vector<int> U(A.size());
+    U.resize(A.size());
     std::iota(U.begin(), U.end(), 0);
     std::sort(U.begin(), U.end(),
               [this] (int i, int j)
@@ -86,12 +86,16 @@ bool winPIBT::solve() {
     if(time_limit&&((fsec)(std::chrono::system_clock::now()-startT)).count()>time_limit){
       break;
     }
+    if(timestep_limit&&P->getTimestep()>=timestep_limit){
+      break;
+    }
+    if (isInterrupted()) break;
 
     ++t;
   }
 
   solveEnd();
-  return P->isSolved();
+  return isSolved();
 }
 
 void winPIBT::allocate() {
@@ -146,7 +150,7 @@ bool winPIBT::winpibt(PIBT_Agent* a, int t_tmp, bool varphi)
   updateGoal(a);
   Node* g = getGoal(a);
 
-  if (varphi && lastNode(i) == g) {
+  if (varphi && lastNode(i) == g && !constrained(g, g, l + 1)) {
     PATHS[i].push_back(g);
     L[i] += 1;
     return true;
@@ -280,13 +284,13 @@ Nodes winPIBT::getPath(PIBT_Agent* a, Node* _g, int t1, int t2) {
   Node* _s = PATHS[a->getId()][t1];  // start pos
   Nodes path, tmpPath, C;
   int f, g;
-  std::string key;
+  long long key;
   bool invalid = true;  // success or not
 
   boost::heap::fibonacci_heap<Fib_AN> OPEN;
-  std::unordered_map<std::string,
+  std::unordered_map<long long,
                      boost::heap::fibonacci_heap<Fib_AN>::handle_type> SEARCHED;
-  std::unordered_set<std::string> CLOSE;  // key
+  std::unordered_set<long long> CLOSE;  // key
   AN* n = new AN { _s, t1, pathDist(_s, _g), nullptr };
   auto handle = OPEN.push(Fib_AN(n));
   key = getKey(n);
@@ -303,10 +307,10 @@ Nodes winPIBT::getPath(PIBT_Agent* a, Node* _g, int t1, int t2) {
     }
 
     // ==== fast implementation ====
-    tmpPath = G->getPath(n->v, _g);
-    while (n->g + tmpPath.size() - 1 < t2) tmpPath.push_back(_g);
-    while (n->g + tmpPath.size() - 1 > t2) tmpPath.pop_back();
-    if (checkValidPath(id, tmpPath, n->g, t2)) {
+    tmpPath = D->getPath(n->v, _g);  // empty if the goal is unreachable
+    while (!tmpPath.empty() && n->g + (int)tmpPath.size() - 1 < t2) tmpPath.push_back(_g);
+    while (n->g + (int)tmpPath.size() - 1 > t2) tmpPath.pop_back();
+    if (!tmpPath.empty() && checkValidPath(id, tmpPath, n->g, t2)) {
       tmpPath.erase(tmpPath.begin());
       for (auto v : tmpPath) n = new AN { v, n->g + 1, 0, n };
       invalid = false;
@@ -369,6 +373,7 @@ bool winPIBT::checkValidPath(int id, Nodes &path, int t1, int t2) {
   for (int j = 1; j < path.size(); ++j) {
     v1 = path[j-1];
     v2 = path[j];
+    if (constrained(v1, v2, j + t1)) return false;
     for (int i = 0; i < A.size(); ++i) {
       if (id == i) continue;
 
@@ -396,7 +401,7 @@ bool winPIBT::checkValidPath(int id, Nodes &path, int t1, int t2) {
 
 int winPIBT::getTmax(int t_tmp) {
   auto itrP = std::max_element(PATHS.begin(), PATHS.end(),
-                               [] (Nodes a, Nodes b)
+                               [] (const Nodes& a, const Nodes& b)
                                { return a.size() < b.size(); });
   int size = itrP->size() - 1;
   if (t_tmp > size) return t_tmp;
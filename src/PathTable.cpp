@@ -4,28 +4,31 @@ void PathTable::insertPath(int agent_id, const Path& path)
 {
     if (path.empty())
         return;
-    for (int t = 0; t < (int)path.size(); t++)
+    int last = min((int)path.size() - 1, window);
+    for (int t = 0; t <= last; t++)
     {
         if (table[path[t].location].size() <= t)
             table[path[t].location].resize(t + 1, NO_AGENT);
         // assert(table[path[t].location][t] == NO_AGENT);
         table[path[t].location][t] = agent_id;
     }
-    goals[path.back().location] = (int) path.size() - 1;
-    makespan = max(makespan, (int) path.size() - 1);
+    if ((int) path.size() - 1 <= window)
+        goals[path.back().location] = (int) path.size() - 1;
+    makespan = max(makespan, last);
 }
 
 void PathTable::deletePath(int agent_id, const Path& path)
 {
     if (path.empty())
         return;
-    for (int t = 0; t < (int)path.size(); t++)
+    int last = min((int)path.size() - 1, window);
+    for (int t = 0; t <= last; t++)
     {
         assert(table[path[t].location].size() > t && table[path[t].location][t] == agent_id);
         table[path[t].location][t] = NO_AGENT;
         goals[path.back().location] = MAX_COST;
     }
-    if (makespan == (int) path.size() - 1) // re-compute makespan
+    if (makespan == last) // re-compute makespan
     {
         makespan = 0;
         for (int time : goals)
@@ -33,7 +36,17 @@ void PathTable::deletePath(int agent_id, const Path& path)
             if (time < MAX_COST && time > makespan)
                 makespan = time;
         }
-
+        if (window < MAX_TIMESTEP && makespan < window) // the paths that do not reach their goals are cut at the window
+        {
+            for (const auto& agents : table)
+            {
+                if ((int)agents.size() > window && agents[window] != NO_AGENT)
+                {
+                    makespan = window;
+                    break;
+                }
+            }
+        }
     }
 }
 
@@ -43,7 +56,7 @@ bool PathTable::constrained(int from, int to, int to_time) const
     {
         if (table[to].size() > to_time && table[to][to_time] != NO_AGENT)
             return true;  // vertex conflict with agent table[to][to_time]
-        else if (table[to].size() >= to_time && table[from].size() > to_time && !table[to].empty() &&
+        else if (to_time > 0 && table[to].size() >= to_time && table[from].size() > to_time && !table[to].empty() &&
                  table[to][to_time - 1] != NO_AGENT && table[from][to_time] == table[to][to_time - 1])
             return true;  // edge conflict with agent table[to][to_time - 1]
     }
@@ -64,7 +77,10 @@ void PathTable::getConflictingAgents(int agent_id, set<int>& conflicting_agents,
     if (table[to].size() >= to_time && table[from].size() > to_time &&
         table[to][to_time - 1] != NO_AGENT && table[from][to_time] == table[to][to_time - 1])
         conflicting_agents.insert(table[from][to_time]); // edge conflict
-    // TODO: collect target conflicts as well.
+    // TODO: collect target conflicts in the full-horizon mode as well.
+    // With a window, the agents parked at their goals have to be collected, or the window plans livelock around them.
+    if (window < MAX_TIMESTEP && goals[to] <= to_time)
+        conflicting_agents.insert(table[to][goals[to]]); // target conflict
 }
 
 void PathTable::get_agents(set<int>& conflicting_agents, int loc) const
@@ -78,7 +94,7 @@ void PathTable::get_agents(set<int>& conflicting_agents, int loc) const
     }
 }
 
-void PathTable::get_agents(set<int>& conflicting_agents, int neighbor_size, int loc) const
+void PathTable::get_agents(set<int>& conflicting_agents, int neighbor_size, int loc, std::mt19937& rng) const
 {
     if (loc < 0 || table[loc].empty())
         return;
@@ -87,7 +103,7 @@ void PathTable::get_agents(set<int>& conflicting_agents, int neighbor_size, int
         t_max--;
     if (t_max == 0)
         return;
-    int t0 = rand() % t_max;
+    int t0 = std::uniform_int_distribution<int>(0, t_max - 1)(rng);
     if (table[loc][t0] != NO_AGENT)
         conflicting_agents.insert(table[loc][t0]);
     int delta = 1;
@@ -110,3 +126,97 @@ void PathTable::get_agents(set<int>& conflicting_agents, int neighbor_size, int
 }
 
 
+void PathTableWC::insertPath(int agent_id, const Path& path)
+{
+    if (path.empty())
+        return;
+    for (int t = 0; t < (int)path.size(); t++)
+    {
+        if (table[path[t].location].size() <= t)
+            table[path[t].location].resize(t + 1);
+        table[path[t].location][t].push_back(agent_id);
+    }
+    goals[path.back().location] = (int) path.size() - 1;
+    goal_agents[path.back().location] = agent_id;
+    makespan = max(makespan, (int) path.size() - 1);
+}
+
+void PathTableWC::deletePath(int agent_id, const Path& path)
+{
+    if (path.empty())
+        return;
+    for (int t = 0; t < (int)path.size(); t++)
+    {
+        auto& agents = table[path[t].location][t];
+        auto it = std::find(agents.begin(), agents.end(), agent_id);
+        assert(it != agents.end());
+        agents.erase(it);
+    }
+    goals[path.back().location] = MAX_COST;
+    goal_agents[path.back().location] = NO_AGENT;
+    if (makespan == (int) path.size() - 1) // re-compute makespan
+    {
+        makespan = 0;
+        for (int time : goals)
+        {
+            if (time < MAX_COST && time > makespan)
+                makespan = time;
+        }
+    }
+}
+
+int PathTableWC::getNumOfCollisions(int from, int to, int to_time) const
+{
+    int rst = 0;
+    if (table[to].size() > to_time)
+        rst += (int)table[to][to_time].size(); // vertex collisions
+    if (from != to && to_time > 0 && table[to].size() >= to_time && table[from].size() > to_time)
+    {
+        for (int a1 : table[to][to_time - 1])
+            for (int a2 : table[from][to_time])
+                if (a1 == a2)
+                    rst++; // edge collisions
+    }
+    if (goals[to] < to_time)
+        rst++; // target collision, where the vertex collision at the goal timestep has been counted
+    return rst;
+}
+
+int PathTableWC::getHoldingTime(int location) const
+{
+    int rst = (int) table[location].size();
+    while (rst > 0 && table[location][rst - 1].empty())
+        rst--;
+    return rst;
+}
+
+void PathTableWC::getCollidingAgents(int agent_id, const Path& path, set<int>& colliding_agents) const
+{
+    for (int t = 0; t < (int)path.size(); t++)
+    {
+        int loc = path[t].location;
+        if (table[loc].size() > t)
+        {
+            for (int a : table[loc][t])
+                if (a != agent_id)
+                    colliding_agents.insert(a); // vertex collision
+        }
+        if (t > 0 && loc != path[t - 1].location && table[loc].size() >= t &&
+            table[path[t - 1].location].size() > t)
+        {
+            for (int a1 : table[loc][t - 1])
+                for (int a2 : table[path[t - 1].location][t])
+                    if (a1 == a2 && a1 != agent_id)
+                        colliding_agents.insert(a1); // edge collision
+        }
+        if (goals[loc] < t && goal_agents[loc] != agent_id)
+            colliding_agents.insert(goal_agents[loc]); // the agent passes the goal of another agent that has arrived
+    }
+    int goal = path.back().location; // other agents pass the goal after the agent arrives
+    for (int t = (int)path.size(); t < (int)table[goal].size(); t++)
+    {
+        for (int a : table[goal][t])
+            if (a != agent_id)
+                colliding_agents.insert(a);
+    }
+}
@@ -24,16 +24,16 @@ void SIPP::updatePath(const LLNode* goal, vector<PathEntry> &path)
 }
 
 Path SIPP::findOptimalPath(const HLNode& node, const ConstraintTable& initial_constraints,
-	const vector<Path*>& paths, int agent, int lowerbound)
+	const ConflictAvoidanceTable& cat, int agent, int lowerbound)
 {
-	return findSuboptimalPath(node, initial_constraints, paths, agent, lowerbound, 1).first;
+	return findSuboptimalPath(node, initial_constraints, cat, agent, lowerbound, 1).first;
 }
 // find path by SIPP
 // Returns a shortest path that satisfies the constraints of the give node  while
 // minimizing the number of internal conflicts (that is conflicts with known_paths for other agents found so far).
 // lowerbound is an underestimation of the length of the path in order to speed up the search.
 pair<Path, int> SIPP::findSuboptimalPath(const HLNode& node, const ConstraintTable& initial_constraints,
-	const vector<Path*>& paths, int agent, int lowerbound, double w)
+	const ConflictAvoidanceTable& cat, int agent, int lowerbound, double w)
 {
 	this->w = w;
 	Path path;
@@ -43,7 +43,7 @@ pair<Path, int> SIPP::findSuboptimalPath(const HLNode& node, const ConstraintTab
 	runtime_build_CT = (double)(clock() - t) / CLOCKS_PER_SEC;
 	int holding_time = reservation_table.getHoldingTime();
 	t = clock();
-	reservation_table.buildCAT(agent, paths);
+	reservation_table.buildCAT(agent, cat);
 	runtime_build_CAT = (double)(clock() - t) / CLOCKS_PER_SEC;
 
 	num_expanded = 0;
@@ -15,9 +15,9 @@ void SpaceTimeAStar::updatePath(const LLNode* goal, vector<PathEntry> &path)
 
 
 Path SpaceTimeAStar::findOptimalPath(const HLNode& node, const ConstraintTable& initial_constraints,
-	const vector<Path*>& paths, int agent, int lowerbound)
+	const ConflictAvoidanceTable& cat, int agent, int lowerbound)
 {
-	return findSuboptimalPath(node, initial_constraints, paths, agent, lowerbound, 1).first;
+	return findSuboptimalPath(node, initial_constraints, cat, agent, lowerbound, 1).first;
 }
 
 // find path by time-space A* search
@@ -72,7 +72,7 @@ Path SpaceTimeAStar::findOptimalPath(const PathTable& path_table)
         for (int next_location : next_locations)
         {
             int next_timestep = curr->timestep + 1;
-            if (path_table.makespan < next_timestep)
+            if (path_table.getStaticTimestep() < next_timestep)
             { // now everything is static, so switch to space A* where we always use the same timestep
                 if (next_location == curr->location)
                 {
@@ -148,12 +148,107 @@ Path SpaceTimeAStar::findOptimalPath(const PathTable& path_table)
     return path;
 }
 
+// find path by time-space A* search
+// Returns a path that has the fewest collisions with the paths in the path table, and then the shortest one.
+// The nodes are ordered lexicographically by <#collisions, f-val>, so FOCAL alone is used as the OPEN list.
+Path SpaceTimeAStar::findMinCollisionPath(const PathTableWC& path_table)
+{
+    Path path;
+    num_expanded = 0;
+    num_generated = 0;
+
+    // the agent can hold its goal location only after the other paths leave it,
+    // while waiting at the goal before that counts the collisions of holding it
+    int holding_time = path_table.getHoldingTime(goal_location);
+
+    auto start = new AStarNode(start_location, 0,
+            max(holding_time, my_heuristic[start_location]), nullptr, 0, 0, false);
+    num_generated++;
+    start->focal_handle = focal_list.push(start);
+    start->in_openlist = true;
+    allNodes_table.insert(start);
+
+    while (!focal_list.empty())
+    {
+        auto* curr = focal_list.top();
+        focal_list.pop();
+        curr->in_openlist = false;
+        num_expanded++;
+        if (curr->location == goal_location && // arrive at (or wait at) the goal location
+            curr->timestep >= holding_time) // the agent can hold the goal location afterward
+        {
+            updatePath(curr, path);
+            break;
+        }
+
+        auto next_locations = instance.getNeighbors(curr->location);
+        next_locations.emplace_back(curr->location);
+        for (int next_location : next_locations)
+        {
+            int next_timestep = curr->timestep + 1;
+            if (path_table.makespan < next_timestep)
+            { // now everything is static, so switch to space A* where we always use the same timestep
+                if (next_location == curr->location)
+                {
+                    continue;
+                }
+                next_timestep--;
+            }
+
+            int next_g_val = curr->g_val + 1;
+            int next_h_val = max(holding_time - next_g_val, my_heuristic[next_location]);
+            int next_collisions = curr->num_of_conflicts +
+                    path_table.getNumOfCollisions(curr->location, next_location, next_timestep);
+
+            // generate (maybe temporary) node
+            auto next = new AStarNode(next_location, next_g_val, next_h_val,
+                                      curr, next_timestep, next_collisions, false);
+            if (next_location == goal_location && curr->location == goal_location)
+                next->wait_at_goal = true;
+
+            // try to retrieve it from the hash table
+            auto it = allNodes_table.find(next);
+            if (it == allNodes_table.end())
+            {
+                next->focal_handle = focal_list.push(next);
+                next->in_openlist = true;
+                num_generated++;
+                allNodes_table.insert(next);
+                continue;
+            }
+
+            // update existing node's if needed
+            auto existing_next = *it;
+            if (existing_next->num_of_conflicts > next->num_of_conflicts ||
+                (existing_next->num_of_conflicts == next->num_of_conflicts &&
+                 existing_next->getFVal() > next->getFVal()))
+            {
+                existing_next->copy(*next);
+                if (existing_next->in_openlist)
+                    focal_list.increase(existing_next->focal_handle);
+                else // reopen
+                {
+                    existing_next->focal_handle = focal_list.push(existing_next);
+                    existing_next->in_openlist = true;
+                }
+            }
+            delete(next);  // not needed anymore -- we already generated it before
+        }  // end for loop that generates successors
+    }  // end while loop
+
+    // the trailing waits at the goal only count the collisions of holding the goal
+    while (path.size() > 1 && path[path.size() - 2].location == goal_location)
+        path.pop_back();
+    releaseNodes();
+    return path;
+}
+
 // find path by time-space A* search
 // Returns a bounded-suboptimal path that satisfies the constraints of the give node  while
 // minimizing the number of internal conflicts (that is conflicts with known_paths for other agents found so far).
 // lowerbound is an underestimation of the length of the path in order to speed up the search.
 pair<Path, int> SpaceTimeAStar::findSuboptimalPath(const HLNode& node, const ConstraintTable& initial_constraints,
-	const vector<Path*>& paths, int agent, int lowerbound, double w)
+	const ConflictAvoidanceTable& cat, int agent, int lowerbound, double w)
 {
 	this->w = w;
 	Path path;
@@ -171,9 +266,7 @@ pair<Path, int> SpaceTimeAStar::findSuboptimalPath(const HLNode& node, const Con
 	}
 
 	int holding_time = constraint_table.getHoldingTime(); // the earliest timestep that the agent can hold its goal location. The length_min is considered here.
-	t = clock();
-	constraint_table.buildCAT(agent, paths, node.makespan + 1);
-	runtime_build_CAT = (double)(clock() - t) / CLOCKS_PER_SEC;
+	runtime_build_CAT = 0; // the CAT is maintained by the high-level search
 
     lowerbound =  max(holding_time, lowerbound);
 
@@ -229,7 +322,7 @@ pair<Path, int> SpaceTimeAStar::findSuboptimalPath(const HLNode& node, const Con
 			if (next_g_val + next_h_val > constraint_table.length_max)
 				continue;
 			int next_internal_conflicts = curr->num_of_conflicts +
-				constraint_table.getNumOfConflictsForStep(curr->location, next_location, next_timestep);
+				cat.getNumOfConflictsForStep(agent, curr->location, next_location, next_timestep);
 
 			// generate (maybe temporary) node
 			auto next = new AStarNode(next_location, next_g_val, next_h_val,
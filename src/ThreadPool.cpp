@@ -0,0 +1,48 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int num_of_threads)
+{
+    workers.reserve(num_of_threads);
+    for (int i = 0; i < num_of_threads; i++)
+        workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        stopped = true;
+    }
+    tasks_cv.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> task)
+{
+    std::packaged_task<void()> packaged_task(std::move(task));
+    auto rst = packaged_task.get_future();
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        tasks.push(std::move(packaged_task));
+    }
+    tasks_cv.notify_one();
+    return rst;
+}
+
+void ThreadPool::work()
+{
+    while (true)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasks_mutex);
+            tasks_cv.wait(lock, [this] { return stopped || !tasks.empty(); });
+            if (tasks.empty()) // stopped
+                return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task(); // exceptions are passed to the future
+    }
+}
@@ -20,4 +20,15 @@ bool isSamePath(const Path& p1, const Path& p2)
 			return false;
 	}
 	return true;
-}
\ No newline at end of file
+}
+
+double getElapsedTime(const steady_clock::time_point& start)
+{
+	return std::chrono::duration<double>(steady_clock::now() - start).count();
+}
+
+std::mt19937& getTieBreakGenerator()
+{
+	thread_local std::mt19937 generator;
+	return generator;
+}
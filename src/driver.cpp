@@ -27,20 +27,39 @@ int main(int argc, char** argv)
 
 		// solver
 		("solver", po::value<string>()->default_value("LNS"), "solver (LNS, A-BCBS, A-EECBS)")
+		("memoryLimit", po::value<double>()->default_value(0),
+		        "memory limit (MB) of the CT nodes of A-EECBS (0: unlimited)")
+		("threads", po::value<int>()->default_value(1),
+		        "number of threads for generating the CT nodes of (E)ECBS (1: serial)")
+		("parallelRoot", po::value<bool>()->default_value(false),
+		        "plan the root paths of (E)ECBS on all threads as well, "
+		        "which usually gives the root more conflicts than planning them serially")
 
         // params for LNS
         ("neighborSize", po::value<int>()->default_value(5), "Size of the neighborhood")
         ("maxIterations", po::value<int>()->default_value(1000000), "maximum number of iterations")
         ("initAlgo", po::value<string>()->default_value("EECBS"),
-                "MAPF algorithm for finding the initial solution (EECBS, PP, PPS, CBS, PIBT, winPIBT)")
+                "MAPF algorithm for finding the initial solution (EECBS, PP, PPS, CBS, PIBT, winPIBT), "
+                "or several of them joined by '+' to run them concurrently, e.g., PP+PIBT+EECBS")
         ("replanAlgo", po::value<string>()->default_value("PP"),
-                "MAPF algorithm for replanning (EECBS, CBS, PP)")
+                "MAPF algorithm for replanning (EECBS, CBS, PP, PIBT, winPIBT)")
         ("destoryStrategy", po::value<string>()->default_value("Adaptive"),
                 "Heuristics for finding subgroups (Random, RandomWalk, Intersection, Adaptive)")
         ("pibtWindow", po::value<int>()->default_value(5),
              "window size for winPIBT")
         ("winPibtSoftmode", po::value<bool>()->default_value(true),
              "winPIBT soft mode")
+        ("initLNS", po::value<bool>()->default_value(false),
+             "find the initial solution by repairing the collisions of a collision-tolerant PP solution with LNS "
+             "(overrides initAlgo)")
+        ("portfolioGracePeriod", po::value<double>()->default_value(0),
+             "seconds that the other initial solvers keep running to find a cheaper solution "
+             "after the first one is found (only used when initAlgo runs several solvers)")
+        ("window", po::value<int>()->default_value(0),
+             "resolve collisions only within this many timesteps and plan in a rolling horizon "
+             "(0 for the full horizon, only with PP as initAlgo and replanAlgo)")
+        ("commitSteps", po::value<int>()->default_value(0),
+             "timesteps that are committed before the window is advanced (0 for half the window)")
 		;
 	po::variables_map vm;
 	po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -57,6 +76,7 @@ int main(int argc, char** argv)
     po::notify(vm);
 
 	srand((int)time(0));
+	getTieBreakGenerator().seed((unsigned)rand());
 
 	Instance instance(vm["map"].as<string>(), vm["agents"].as<string>(),
 		vm["agentNum"].as<int>());
@@ -71,7 +91,9 @@ int main(int argc, char** argv)
                 vm["replanAlgo"].as<string>(),
                 vm["destoryStrategy"].as<string>(),
                 vm["neighborSize"].as<int>(),
-                vm["maxIterations"].as<int>(), screen, pipp_option);
+                vm["maxIterations"].as<int>(), screen, pipp_option, vm["threads"].as<int>(),
+                vm["initLNS"].as<bool>(), vm["portfolioGracePeriod"].as<double>(),
+                vm["window"].as<int>(), vm["commitSteps"].as<int>(), vm["parallelRoot"].as<bool>());
         bool succ = lns.run();
         if (succ)
             lns.validateSolution();
@@ -83,7 +105,7 @@ int main(int argc, char** argv)
     }
     else if (vm["solver"].as<string>() == "A-BCBS") // anytime BCBS(w, 1)
     {
-        AnytimeBCBS bcbs(instance, time_limit, screen);
+        AnytimeBCBS bcbs(instance, time_limit, screen, vm["threads"].as<int>(), vm["parallelRoot"].as<bool>());
         bcbs.run();
         bcbs.validateSolution();
         if (vm.count("output"))
@@ -93,7 +115,8 @@ int main(int argc, char** argv)
     }
     else if (vm["solver"].as<string>() == "A-EECBS") // anytime EECBS
     {
-        AnytimeEECBS eecbs(instance, time_limit, screen);
+        AnytimeEECBS eecbs(instance, time_limit, screen, (size_t)(vm["memoryLimit"].as<double>() * 1048576),
+                           vm["threads"].as<int>(), vm["parallelRoot"].as<bool>());
         eecbs.run();
         eecbs.validateSolution();
         if (vm.count("output"))